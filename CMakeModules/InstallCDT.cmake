@@ -39,4 +39,6 @@ platon_tools_install(platon-cpp)
 platon_tools_install(platon-ld)
 platon_tools_install(platon-init)
 platon_tools_install(platon-abigen)
+platon_tools_install(platon-size)
+platon_tools_install(platon-trace)
 platon_libraries_install()
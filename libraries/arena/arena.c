@@ -0,0 +1,169 @@
+/*
+ * Per-call heap for contracts.
+ *
+ * A contract call starts with a fresh linear memory and throws it away when
+ * it returns, so the allocator never has to give memory back. malloc bumps
+ * a pointer past __heap_base and grows the memory a page at a time; free
+ * only reclaims the most recent block. Built with ARENA_SIZE_CLASSES, freed
+ * blocks up to CLASS_LIMIT bytes are also kept on per-size free lists and
+ * handed out again.
+ *
+ * Every block starts with a 4-byte header holding its total size, laid out
+ * so that the payload is 16-byte aligned. That matches the header word
+ * musl's __memalign expects in front of a chunk.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "platon/heap.h"
+
+#ifndef __has_builtin
+#define __has_builtin(x) 0
+#endif
+
+#if __has_builtin(__builtin_wasm_memory_grow)
+#define MEMORY_SIZE() __builtin_wasm_memory_size(0)
+#define MEMORY_GROW(n) __builtin_wasm_memory_grow(0, n)
+#else
+#define MEMORY_SIZE() __builtin_wasm_current_memory()
+#define MEMORY_GROW(n) __builtin_wasm_grow_memory(n)
+#endif
+
+#define PAGE_SIZE 65536
+#define ALIGN 16
+#define HDR sizeof(uint32_t)
+#define CLASS_LIMIT 1024
+
+extern unsigned char __heap_base;
+
+static uintptr_t heap_start, heap_top, heap_end;
+static struct platon_heap_stats stats;
+
+#ifdef ARENA_SIZE_CLASSES
+static void *free_lists[CLASS_LIMIT / ALIGN];
+#endif
+
+static void init(void)
+{
+	heap_start = (((uintptr_t)&__heap_base + HDR + ALIGN - 1) & -ALIGN) - HDR;
+	heap_top = heap_start;
+	heap_end = (uintptr_t)MEMORY_SIZE() * PAGE_SIZE;
+}
+
+static int reserve(size_t need)
+{
+	if (need > heap_end - heap_top) {
+		size_t pages = (need - (heap_end - heap_top) + PAGE_SIZE - 1) / PAGE_SIZE;
+		if (MEMORY_GROW(pages) == (size_t)-1) return 0;
+		heap_end += pages * PAGE_SIZE;
+	}
+	return 1;
+}
+
+/* Total block size for a payload of n bytes, 0 if it cannot be represented. */
+static size_t block_size(size_t n)
+{
+	if (n > SIZE_MAX - HDR - ALIGN) return 0;
+	return (n + HDR + ALIGN - 1) & -ALIGN;
+}
+
+static void *bump(size_t b)
+{
+	if (!reserve(b)) return 0;
+	uintptr_t blk = heap_top;
+	heap_top += b;
+	if (heap_top - heap_start > stats.peak) stats.peak = heap_top - heap_start;
+	*(uint32_t *)blk = b;
+	return (void *)(blk + HDR);
+}
+
+void *malloc(size_t n)
+{
+	if (!heap_top) init();
+	size_t b = block_size(n);
+	void *p = 0;
+	if (!b) goto fail;
+#ifdef ARENA_SIZE_CLASSES
+	if (b <= CLASS_LIMIT && free_lists[b / ALIGN - 1]) {
+		p = free_lists[b / ALIGN - 1];
+		free_lists[b / ALIGN - 1] = *(void **)p;
+		stats.reused++;
+	}
+#endif
+	if (!p && !(p = bump(b))) goto fail;
+	stats.allocs++;
+	stats.in_use += b;
+	return p;
+fail:
+	errno = ENOMEM;
+	return 0;
+}
+
+void free(void *p)
+{
+	if (!p) return;
+	uintptr_t blk = (uintptr_t)p - HDR;
+	size_t b = *(uint32_t *)blk;
+	stats.frees++;
+	stats.in_use -= b;
+	if (blk + b == heap_top) {
+		heap_top = blk;
+		return;
+	}
+#ifdef ARENA_SIZE_CLASSES
+	if (b <= CLASS_LIMIT) {
+		*(void **)p = free_lists[b / ALIGN - 1];
+		free_lists[b / ALIGN - 1] = p;
+	}
+#endif
+}
+
+void *calloc(size_t m, size_t n)
+{
+	if (n && m > SIZE_MAX / n) {
+		errno = ENOMEM;
+		return 0;
+	}
+	void *p = malloc(m * n);
+	if (p) memset(p, 0, m * n);
+	return p;
+}
+
+void *realloc(void *p, size_t n)
+{
+	if (!p) return malloc(n);
+	uintptr_t blk = (uintptr_t)p - HDR;
+	size_t b = *(uint32_t *)blk;
+	size_t nb = block_size(n);
+	if (!nb) {
+		errno = ENOMEM;
+		return 0;
+	}
+
+	/* The last block can grow or shrink in place. */
+	if (blk + b == heap_top) {
+		if (nb > b && !reserve(nb - b)) {
+			errno = ENOMEM;
+			return 0;
+		}
+		heap_top = blk + nb;
+		if (heap_top - heap_start > stats.peak) stats.peak = heap_top - heap_start;
+		stats.in_use += nb - b;
+		*(uint32_t *)blk = nb;
+		return p;
+	}
+	if (nb <= b) return p;
+
+	void *q = malloc(n);
+	if (!q) return 0;
+	memcpy(q, p, b - HDR);
+	free(p);
+	return q;
+}
+
+void platon_get_heap_stats(struct platon_heap_stats *out)
+{
+	*out = stats;
+}
@@ -0,0 +1,465 @@
+/*
+ * IEEE-754 binary128 (long double on wasm32) soft-float builtins.
+ *
+ * Arguments arrive as (low, high) i64 pairs and results are written through
+ * a pointer, matching the declarations in platon/compiler_builtins.h. All
+ * operations round to nearest, ties to even. The algorithms follow
+ * compiler-rt's fp_add/fp_mul/fp_extend/fp_trunc, rewritten on 64-bit
+ * halves so that no 128-bit libcall is generated.
+ */
+#include "int_util.h"
+
+#define SIG_BITS 112
+#define EXP_BITS 15
+#define EXP_BIAS 16383
+#define MAX_EXP 0x7fff
+
+static const u128_t kSignBit = {0, 0x8000000000000000ULL};
+static const u128_t kAbsMask = {~0ULL, 0x7fffffffffffffffULL};
+static const u128_t kInfRep = {0, 0x7fff000000000000ULL};
+static const u128_t kQuietBit = {0, 0x0000800000000000ULL};
+static const u128_t kImplicitBit = {0, 0x0001000000000000ULL};
+static const u128_t kSigMask = {~0ULL, 0x0000ffffffffffffULL};
+static const u128_t kQNaNRep = {0, 0x7fff800000000000ULL};
+
+static inline int exponent_of(u128_t abs) { return (int)(abs.hi >> 48); }
+
+/* Shift a subnormal significand up to the implicit bit, return 1 - shift. */
+static inline int normalize(u128_t *sig) {
+  int shift = (int)u128_clz(*sig) - (int)u128_clz(kImplicitBit);
+  *sig = u128_shl(*sig, (unsigned)shift);
+  return 1 - shift;
+}
+
+/*
+ * Round and pack a significand carrying three extra low bits (guard, round,
+ * sticky), i.e. with its implicit bit at position SIG_BITS + 3.
+ */
+static u128_t round_pack(u128_t sign, int exp, u128_t sig) {
+  if (exp >= MAX_EXP) return u128_or(kInfRep, sign);
+  if (exp <= 0) {
+    sig = u128_shr_sticky(sig, (unsigned)(1 - exp));
+    exp = 0;
+  }
+  unsigned rgs = (unsigned)(sig.lo & 7);
+  u128_t r = u128_and(u128_shr(sig, 3), kSigMask);
+  r.hi |= (uint64_t)exp << 48;
+  r = u128_or(r, sign);
+  if (rgs > 4) r = u128_add(r, u128_make(0, 1));
+  if (rgs == 4) r = u128_add(r, u128_make(0, r.lo & 1));
+  return r;
+}
+
+static u128_t add_impl(u128_t a, u128_t b) {
+  u128_t aAbs = u128_and(a, kAbsMask);
+  u128_t bAbs = u128_and(b, kAbsMask);
+  u128_t one = u128_make(0, 1);
+  u128_t infMinusOne = u128_sub(kInfRep, one);
+
+  /* Either operand is zero, infinity or NaN. */
+  if (!u128_lt(u128_sub(aAbs, one), infMinusOne) ||
+      !u128_lt(u128_sub(bAbs, one), infMinusOne)) {
+    if (u128_lt(kInfRep, aAbs)) return u128_or(a, kQuietBit);
+    if (u128_lt(kInfRep, bAbs)) return u128_or(b, kQuietBit);
+    if (u128_eq(aAbs, kInfRep)) {
+      u128_t x = u128_make(a.hi ^ b.hi, a.lo ^ b.lo);
+      return u128_eq(x, kSignBit) ? kQNaNRep : a;
+    }
+    if (u128_eq(bAbs, kInfRep)) return b;
+    if (u128_is_zero(aAbs)) return u128_is_zero(bAbs) ? u128_and(a, b) : b;
+    if (u128_is_zero(bAbs)) return a;
+  }
+
+  if (u128_lt(aAbs, bAbs)) {
+    u128_t t = a;
+    a = b;
+    b = t;
+    t = aAbs;
+    aAbs = bAbs;
+    bAbs = t;
+  }
+
+  int aExp = exponent_of(aAbs);
+  int bExp = exponent_of(bAbs);
+  u128_t aSig = u128_and(a, kSigMask);
+  u128_t bSig = u128_and(b, kSigMask);
+  if (aExp == 0) aExp = normalize(&aSig);
+  if (bExp == 0) bExp = normalize(&bSig);
+
+  u128_t sign = u128_and(a, kSignBit);
+  int subtraction = (int64_t)(a.hi ^ b.hi) < 0;
+
+  aSig = u128_shl(u128_or(aSig, kImplicitBit), 3);
+  bSig = u128_shl(u128_or(bSig, kImplicitBit), 3);
+  bSig = u128_shr_sticky(bSig, (unsigned)(aExp - bExp));
+
+  if (subtraction) {
+    aSig = u128_sub(aSig, bSig);
+    if (u128_is_zero(aSig)) return u128_make(0, 0);
+    u128_t top = u128_shl(kImplicitBit, 3);
+    if (u128_lt(aSig, top)) {
+      int shift = (int)u128_clz(aSig) - (int)u128_clz(top);
+      aSig = u128_shl(aSig, (unsigned)shift);
+      aExp -= shift;
+    }
+  } else {
+    aSig = u128_add(aSig, bSig);
+    if (!u128_is_zero(u128_and(aSig, u128_shl(kImplicitBit, 4)))) {
+      aSig = u128_shr_sticky(aSig, 1);
+      aExp += 1;
+    }
+  }
+  return round_pack(sign, aExp, aSig);
+}
+
+void __addtf3(u128_t *ret, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  *ret = add_impl(u128_make(ha, la), u128_make(hb, lb));
+}
+
+void __subtf3(u128_t *ret, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  *ret = add_impl(u128_make(ha, la), u128_make(hb ^ kSignBit.hi, lb));
+}
+
+/* Full 256-bit product of two 128-bit values. */
+static void mul128x128(u128_t a, u128_t b, u128_t *hi, u128_t *lo) {
+  u128_t p00 = mul64x64(a.lo, b.lo);
+  u128_t p01 = mul64x64(a.lo, b.hi);
+  u128_t p10 = mul64x64(a.hi, b.lo);
+  u128_t p11 = mul64x64(a.hi, b.hi);
+
+  u128_t mid = u128_add(u128_make(0, p00.hi), u128_make(0, p01.lo));
+  mid = u128_add(mid, u128_make(0, p10.lo));
+  *lo = u128_make(mid.lo, p00.lo);
+
+  u128_t h = u128_add(p11, u128_make(0, p01.hi));
+  h = u128_add(h, u128_make(0, p10.hi));
+  *hi = u128_add(h, u128_make(0, mid.hi));
+}
+
+static int special_operands(u128_t aAbs, u128_t bAbs) {
+  int aExp = exponent_of(aAbs), bExp = exponent_of(bAbs);
+  return (unsigned)(aExp - 1) >= MAX_EXP - 1 ||
+         (unsigned)(bExp - 1) >= MAX_EXP - 1;
+}
+
+void __multf3(u128_t *ret, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  u128_t a = u128_make(ha, la), b = u128_make(hb, lb);
+  u128_t aAbs = u128_and(a, kAbsMask), bAbs = u128_and(b, kAbsMask);
+  u128_t sign = u128_make((ha ^ hb) & kSignBit.hi, 0);
+  u128_t aSig = u128_and(a, kSigMask), bSig = u128_and(b, kSigMask);
+  int aExp = exponent_of(aAbs), bExp = exponent_of(bAbs);
+  int scale = 0;
+
+  if (special_operands(aAbs, bAbs)) {
+    if (u128_lt(kInfRep, aAbs)) { *ret = u128_or(a, kQuietBit); return; }
+    if (u128_lt(kInfRep, bAbs)) { *ret = u128_or(b, kQuietBit); return; }
+    if (u128_eq(aAbs, kInfRep)) {
+      *ret = u128_is_zero(bAbs) ? kQNaNRep : u128_or(aAbs, sign);
+      return;
+    }
+    if (u128_eq(bAbs, kInfRep)) {
+      *ret = u128_is_zero(aAbs) ? kQNaNRep : u128_or(bAbs, sign);
+      return;
+    }
+    if (u128_is_zero(aAbs) || u128_is_zero(bAbs)) { *ret = sign; return; }
+    if (u128_lt(aAbs, kImplicitBit)) scale += normalize(&aSig);
+    if (u128_lt(bAbs, kImplicitBit)) scale += normalize(&bSig);
+  }
+
+  aSig = u128_or(aSig, kImplicitBit);
+  bSig = u128_or(bSig, kImplicitBit);
+
+  u128_t hi, lo;
+  mul128x128(aSig, u128_shl(bSig, EXP_BITS), &hi, &lo);
+  int exp = aExp + bExp - EXP_BIAS + scale;
+
+  if (!u128_is_zero(u128_and(hi, kImplicitBit))) {
+    exp++;
+  } else {
+    hi = u128_or(u128_shl(hi, 1), u128_make(0, lo.hi >> 63));
+    lo = u128_shl(lo, 1);
+  }
+
+  if (exp >= MAX_EXP) { *ret = u128_or(kInfRep, sign); return; }
+
+  if (exp <= 0) {
+    unsigned shift = (unsigned)(1 - exp);
+    if (shift >= 128) { *ret = sign; return; }
+    /* Shift hi:lo right, folding everything shifted out of lo into sticky. */
+    int sticky = !u128_is_zero(u128_shl(lo, 128 - shift));
+    lo = u128_or(u128_shr(lo, shift), u128_shl(hi, 128 - shift));
+    hi = u128_shr(hi, shift);
+    lo.lo |= (uint64_t)sticky;
+  } else {
+    hi = u128_and(hi, kSigMask);
+    hi.hi |= (uint64_t)exp << 48;
+  }
+  hi = u128_or(hi, sign);
+
+  if (u128_lt(kSignBit, lo)) hi = u128_add(hi, u128_make(0, 1));
+  if (u128_eq(lo, kSignBit)) hi = u128_add(hi, u128_make(0, hi.lo & 1));
+  *ret = hi;
+}
+
+void __divtf3(u128_t *ret, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  u128_t a = u128_make(ha, la), b = u128_make(hb, lb);
+  u128_t aAbs = u128_and(a, kAbsMask), bAbs = u128_and(b, kAbsMask);
+  u128_t sign = u128_make((ha ^ hb) & kSignBit.hi, 0);
+  u128_t aSig = u128_and(a, kSigMask), bSig = u128_and(b, kSigMask);
+  int aExp = exponent_of(aAbs), bExp = exponent_of(bAbs);
+  int scale = 0;
+
+  if (special_operands(aAbs, bAbs)) {
+    if (u128_lt(kInfRep, aAbs)) { *ret = u128_or(a, kQuietBit); return; }
+    if (u128_lt(kInfRep, bAbs)) { *ret = u128_or(b, kQuietBit); return; }
+    if (u128_eq(aAbs, kInfRep)) {
+      *ret = u128_eq(bAbs, kInfRep) ? kQNaNRep : u128_or(aAbs, sign);
+      return;
+    }
+    if (u128_eq(bAbs, kInfRep)) { *ret = sign; return; }
+    if (u128_is_zero(aAbs)) {
+      *ret = u128_is_zero(bAbs) ? kQNaNRep : sign;
+      return;
+    }
+    if (u128_is_zero(bAbs)) { *ret = u128_or(kInfRep, sign); return; }
+    if (u128_lt(aAbs, kImplicitBit)) scale += normalize(&aSig);
+    if (u128_lt(bAbs, kImplicitBit)) scale -= normalize(&bSig);
+  }
+
+  aSig = u128_or(aSig, kImplicitBit);
+  bSig = u128_or(bSig, kImplicitBit);
+  int exp = aExp - bExp + scale + EXP_BIAS;
+  if (u128_lt(aSig, bSig)) {
+    aSig = u128_shl(aSig, 1);
+    exp--;
+  }
+
+  /*
+   * Restoring division: SIG_BITS + 3 quotient bits, then the remainder
+   * becomes the sticky bit, leaving the implicit bit at SIG_BITS + 3.
+   */
+  u128_t q = u128_make(0, 0);
+  u128_t rem = aSig;
+  for (int i = 0; i < SIG_BITS + 3; ++i) {
+    q = u128_shl(q, 1);
+    if (!u128_lt(rem, bSig)) {
+      rem = u128_sub(rem, bSig);
+      q.lo |= 1;
+    }
+    rem = u128_shl(rem, 1);
+  }
+  q = u128_shl(q, 1);
+  q.lo |= !u128_is_zero(rem);
+
+  *ret = round_pack(sign, exp, q);
+}
+
+/* Comparisons, see compiler-rt comparetf2. */
+enum { LE_LESS = -1, LE_EQUAL = 0, LE_GREATER = 1, LE_UNORDERED = 1 };
+
+static int compare(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb,
+                   int unordered) {
+  u128_t a = u128_make(ha, la), b = u128_make(hb, lb);
+  u128_t aAbs = u128_and(a, kAbsMask), bAbs = u128_and(b, kAbsMask);
+  if (u128_lt(kInfRep, aAbs) || u128_lt(kInfRep, bAbs)) return unordered;
+  if (u128_is_zero(u128_or(aAbs, bAbs))) return LE_EQUAL;
+  if (u128_eq(a, b)) return LE_EQUAL;
+
+  /* Signed 128-bit comparison of the raw representations. */
+  int less = (int64_t)ha < (int64_t)hb || (ha == hb && la < lb);
+  if ((int64_t)(ha & hb) >= 0) return less ? LE_LESS : LE_GREATER;
+  return less ? LE_GREATER : LE_LESS;
+}
+
+int __letf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return compare(la, ha, lb, hb, LE_UNORDERED);
+}
+
+int __getf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return compare(la, ha, lb, hb, -1);
+}
+
+int __eqtf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return __letf2(la, ha, lb, hb);
+}
+
+int __netf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return __letf2(la, ha, lb, hb);
+}
+
+int __lttf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return __letf2(la, ha, lb, hb);
+}
+
+int __cmptf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return __letf2(la, ha, lb, hb);
+}
+
+int __gttf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  return __getf2(la, ha, lb, hb);
+}
+
+int __unordtf2(uint64_t la, uint64_t ha, uint64_t lb, uint64_t hb) {
+  u128_t aAbs = u128_and(u128_make(ha, la), kAbsMask);
+  u128_t bAbs = u128_and(u128_make(hb, lb), kAbsMask);
+  return u128_lt(kInfRep, aAbs) || u128_lt(kInfRep, bAbs);
+}
+
+/* Widen a float/double given its raw bits and format parameters. */
+static u128_t extend(uint64_t bits, unsigned sigBits, unsigned expBits) {
+  uint64_t sigMask = ((uint64_t)1 << sigBits) - 1;
+  unsigned maxExp = (1u << expBits) - 1;
+  int bias = (int)(maxExp >> 1);
+  u128_t sign = u128_make((bits >> (sigBits + expBits)) << 63, 0);
+  unsigned exp = (unsigned)(bits >> sigBits) & maxExp;
+  uint64_t sig = bits & sigMask;
+  u128_t r;
+
+  if (exp == maxExp) {
+    r = u128_shl(u128_make(0, sig), SIG_BITS - sigBits);
+    r.hi |= (uint64_t)MAX_EXP << 48;
+  } else if (exp != 0) {
+    r = u128_shl(u128_make(0, sig), SIG_BITS - sigBits);
+    r.hi |= (uint64_t)(exp - bias + EXP_BIAS) << 48;
+  } else if (sig != 0) {
+    unsigned msb = 63 - clz64(sig);
+    r = u128_and(u128_shl(u128_make(0, sig), SIG_BITS - msb), kSigMask);
+    int e = (int)msb - (int)sigBits + 1 - bias + EXP_BIAS;
+    r.hi |= (uint64_t)e << 48;
+  } else {
+    r = u128_make(0, 0);
+  }
+  return u128_or(r, sign);
+}
+
+void __extendsftf2(u128_t *ret, float f) {
+  union { float f; uint32_t u; } v = {f};
+  *ret = extend(v.u, 23, 8);
+}
+
+void __extenddftf2(u128_t *ret, double f) {
+  union { double f; uint64_t u; } v = {f};
+  *ret = extend(v.u, 52, 11);
+}
+
+/* Narrow to a float/double, returning the raw bits. */
+static uint64_t truncate(uint64_t l, uint64_t h, unsigned sigBits,
+                         unsigned expBits) {
+  u128_t a = u128_make(h, l);
+  u128_t aAbs = u128_and(a, kAbsMask);
+  uint64_t maxExp = ((uint64_t)1 << expBits) - 1;
+  int bias = (int)(maxExp >> 1);
+  uint64_t sign = (h >> 63) << (sigBits + expBits);
+  uint64_t inf = maxExp << sigBits;
+
+  if (u128_lt(kInfRep, aAbs)) {
+    uint64_t payload = u128_shr(u128_and(a, kSigMask), SIG_BITS - sigBits).lo;
+    return sign | inf | ((uint64_t)1 << (sigBits - 1)) | payload;
+  }
+  if (u128_eq(aAbs, kInfRep)) return sign | inf;
+
+  int exp = exponent_of(aAbs) - EXP_BIAS + bias;
+  u128_t sig = u128_and(a, kSigMask);
+  if (exponent_of(aAbs) != 0) sig = u128_or(sig, kImplicitBit);
+  else if (u128_is_zero(sig)) return sign;
+  else exp = 1 - EXP_BIAS + bias;  /* far below any float/double subnormal */
+
+  if (exp >= (int)maxExp) return sign | inf;
+
+  unsigned shift = SIG_BITS - sigBits + (exp > 0 ? 0 : (unsigned)(1 - exp));
+  if (shift >= 128) return sign;
+
+  u128_t q = u128_shr(sig, shift);
+  u128_t lost = u128_sub(sig, u128_shl(q, shift));
+  u128_t half = u128_shl(u128_make(0, 1), shift - 1);
+  uint64_t r = q.lo;
+  if (u128_lt(half, lost) || (u128_eq(lost, half) && (r & 1))) ++r;
+
+  /* The implicit bit in r carries exp - 1 into exp, rounding may carry on. */
+  if (exp > 0) r += (uint64_t)(exp - 1) << sigBits;
+  if (r >= inf) return sign | inf;
+  return sign | r;
+}
+
+double __trunctfdf2(uint64_t l, uint64_t h) {
+  union { uint64_t u; double f; } v = {truncate(l, h, 52, 11)};
+  return v.f;
+}
+
+float __trunctfsf2(uint64_t l, uint64_t h) {
+  union { uint32_t u; float f; } v = {(uint32_t)truncate(l, h, 23, 8)};
+  return v.f;
+}
+
+/* Truncate toward zero; out of range values saturate like compiler-rt. */
+static uint64_t fix_magnitude(uint64_t l, uint64_t h, int *exponent) {
+  u128_t aAbs = u128_and(u128_make(h, l), kAbsMask);
+  u128_t sig = u128_or(u128_and(aAbs, kSigMask), kImplicitBit);
+  *exponent = exponent_of(aAbs) - EXP_BIAS;
+  if (*exponent < 0 || *exponent >= 64) return 0;
+  return u128_shr(sig, SIG_BITS - (unsigned)*exponent).lo;
+}
+
+int64_t __fixtfdi(uint64_t l, uint64_t h) {
+  int exp;
+  uint64_t m = fix_magnitude(l, h, &exp);
+  int negative = (int64_t)h < 0;
+  if (exp < 0) return 0;
+  if (exp >= 63) return negative ? INT64_MIN : INT64_MAX;
+  return negative ? -(int64_t)m : (int64_t)m;
+}
+
+int32_t __fixtfsi(uint64_t l, uint64_t h) {
+  int exp;
+  uint64_t m = fix_magnitude(l, h, &exp);
+  int negative = (int64_t)h < 0;
+  if (exp < 0) return 0;
+  if (exp >= 31) return negative ? INT32_MIN : INT32_MAX;
+  return negative ? -(int32_t)m : (int32_t)m;
+}
+
+uint64_t __fixunstfdi(uint64_t l, uint64_t h) {
+  int exp;
+  uint64_t m = fix_magnitude(l, h, &exp);
+  if ((int64_t)h < 0 || exp < 0) return 0;
+  if (exp >= 64) return UINT64_MAX;
+  return m;
+}
+
+uint32_t __fixunstfsi(uint64_t l, uint64_t h) {
+  int exp;
+  uint64_t m = fix_magnitude(l, h, &exp);
+  if ((int64_t)h < 0 || exp < 0) return 0;
+  if (exp >= 32) return UINT32_MAX;
+  return (uint32_t)m;
+}
+
+/* Integer to long double conversions are always exact. */
+static u128_t from_magnitude(uint64_t m, int negative) {
+  if (m == 0) return u128_make(0, 0);
+  unsigned msb = 63 - clz64(m);
+  u128_t r = u128_and(u128_shl(u128_make(0, m), SIG_BITS - msb), kSigMask);
+  r.hi |= (uint64_t)(msb + EXP_BIAS) << 48;
+  if (negative) r = u128_or(r, kSignBit);
+  return r;
+}
+
+void __floatsitf(u128_t *ret, int32_t v) {
+  *ret = from_magnitude(v < 0 ? 0 - (uint64_t)(int64_t)v : (uint64_t)v, v < 0);
+}
+
+void __floatunsitf(u128_t *ret, uint32_t v) {
+  *ret = from_magnitude(v, 0);
+}
+
+void __floatditf(u128_t *ret, int64_t v) {
+  *ret = from_magnitude(v < 0 ? 0 - (uint64_t)v : (uint64_t)v, v < 0);
+}
+
+void __floatunditf(u128_t *ret, uint64_t v) {
+  *ret = from_magnitude(v, 0);
+}
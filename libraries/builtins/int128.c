@@ -0,0 +1,58 @@
+/*
+ * 128-bit integer builtins.
+ *
+ * wasm32 returns __int128 through a pointer and passes each __int128
+ * argument as two i64 halves (low first), so every function here takes the
+ * result pointer first, matching the declarations in
+ * platon/compiler_builtins.h.
+ */
+#include "int_util.h"
+
+void __multi3(u128_t *res, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  *res = u128_mul(u128_make(ha, la), u128_make(hb, lb));
+}
+
+void __udivti3(u128_t *res, uint64_t la, uint64_t ha, uint64_t lb,
+               uint64_t hb) {
+  *res = u128_divmod(u128_make(ha, la), u128_make(hb, lb), 0);
+}
+
+void __umodti3(u128_t *res, uint64_t la, uint64_t ha, uint64_t lb,
+               uint64_t hb) {
+  u128_divmod(u128_make(ha, la), u128_make(hb, lb), res);
+}
+
+static inline u128_t u128_abs(u128_t a) {
+  return (int64_t)a.hi < 0 ? u128_neg(a) : a;
+}
+
+void __divti3(u128_t *res, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  u128_t q = u128_divmod(u128_abs(u128_make(ha, la)),
+                         u128_abs(u128_make(hb, lb)), 0);
+  *res = (int64_t)(ha ^ hb) < 0 ? u128_neg(q) : q;
+}
+
+void __modti3(u128_t *res, uint64_t la, uint64_t ha, uint64_t lb,
+              uint64_t hb) {
+  u128_t r;
+  u128_divmod(u128_abs(u128_make(ha, la)), u128_abs(u128_make(hb, lb)), &r);
+  *res = (int64_t)ha < 0 ? u128_neg(r) : r;
+}
+
+void __ashlti3(u128_t *res, uint64_t lo, uint64_t hi, uint32_t shift) {
+  *res = u128_shl(u128_make(hi, lo), shift);
+}
+
+void __lshlti3(u128_t *res, uint64_t lo, uint64_t hi, uint32_t shift) {
+  *res = u128_shl(u128_make(hi, lo), shift);
+}
+
+void __lshrti3(u128_t *res, uint64_t lo, uint64_t hi, uint32_t shift) {
+  *res = u128_shr(u128_make(hi, lo), shift);
+}
+
+void __ashrti3(u128_t *res, uint64_t lo, uint64_t hi, uint32_t shift) {
+  *res = u128_sar(u128_make(hi, lo), shift);
+}
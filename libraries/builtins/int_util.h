@@ -0,0 +1,185 @@
+#ifndef PLATON_BUILTINS_INT_UTIL_H
+#define PLATON_BUILTINS_INT_UTIL_H
+
+#include <stdint.h>
+
+/*
+ * 128-bit values are handled as a pair of 64-bit halves. Nothing in this
+ * library may use __int128 arithmetic, since the backend would lower it back
+ * into the very builtins implemented here.
+ */
+typedef struct {
+  uint64_t lo;
+  uint64_t hi;
+} u128_t;
+
+static inline u128_t u128_make(uint64_t hi, uint64_t lo) {
+  u128_t r = {lo, hi};
+  return r;
+}
+
+static inline int u128_is_zero(u128_t a) { return (a.lo | a.hi) == 0; }
+
+static inline int u128_eq(u128_t a, u128_t b) {
+  return a.lo == b.lo && a.hi == b.hi;
+}
+
+static inline int u128_lt(u128_t a, u128_t b) {
+  return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+static inline u128_t u128_add(u128_t a, u128_t b) {
+  u128_t r;
+  r.lo = a.lo + b.lo;
+  r.hi = a.hi + b.hi + (r.lo < a.lo);
+  return r;
+}
+
+static inline u128_t u128_sub(u128_t a, u128_t b) {
+  u128_t r;
+  r.lo = a.lo - b.lo;
+  r.hi = a.hi - b.hi - (a.lo < b.lo);
+  return r;
+}
+
+static inline u128_t u128_neg(u128_t a) {
+  return u128_sub(u128_make(0, 0), a);
+}
+
+static inline u128_t u128_and(u128_t a, u128_t b) {
+  return u128_make(a.hi & b.hi, a.lo & b.lo);
+}
+
+static inline u128_t u128_or(u128_t a, u128_t b) {
+  return u128_make(a.hi | b.hi, a.lo | b.lo);
+}
+
+/* Shifts accept any count in [0, 127]; larger counts are masked. */
+static inline u128_t u128_shl(u128_t a, unsigned n) {
+  n &= 127;
+  if (n == 0) return a;
+  if (n >= 64) return u128_make(a.lo << (n - 64), 0);
+  return u128_make((a.hi << n) | (a.lo >> (64 - n)), a.lo << n);
+}
+
+static inline u128_t u128_shr(u128_t a, unsigned n) {
+  n &= 127;
+  if (n == 0) return a;
+  if (n >= 64) return u128_make(0, a.hi >> (n - 64));
+  return u128_make(a.hi >> n, (a.lo >> n) | (a.hi << (64 - n)));
+}
+
+static inline u128_t u128_sar(u128_t a, unsigned n) {
+  n &= 127;
+  if (n == 0) return a;
+  if (n >= 64) {
+    uint64_t fill = (uint64_t)((int64_t)a.hi >> 63);
+    return u128_make(fill, (uint64_t)((int64_t)a.hi >> (n - 64)));
+  }
+  return u128_make((uint64_t)((int64_t)a.hi >> n),
+                   (a.lo >> n) | (a.hi << (64 - n)));
+}
+
+/* Shift right and OR every bit shifted out into bit 0. */
+static inline u128_t u128_shr_sticky(u128_t a, unsigned n) {
+  if (n == 0) return a;
+  if (n >= 128) return u128_make(0, !u128_is_zero(a));
+  u128_t lost = u128_shl(a, 128 - n);
+  u128_t r = u128_shr(a, n);
+  r.lo |= !u128_is_zero(lost);
+  return r;
+}
+
+static inline unsigned clz64(uint64_t x) {
+  return x == 0 ? 64 : (unsigned)__builtin_clzll(x);
+}
+
+static inline unsigned u128_clz(u128_t a) {
+  return a.hi != 0 ? clz64(a.hi) : 64 + clz64(a.lo);
+}
+
+/* 64 x 64 -> 128 bit multiply on 32-bit halves. */
+static inline u128_t mul64x64(uint64_t a, uint64_t b) {
+  uint64_t a0 = (uint32_t)a, a1 = a >> 32;
+  uint64_t b0 = (uint32_t)b, b1 = b >> 32;
+  uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+  return u128_make(p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32),
+                   (mid << 32) | (uint32_t)p00);
+}
+
+/* Low 128 bits of a 128 x 128 bit product. */
+static inline u128_t u128_mul(u128_t a, u128_t b) {
+  u128_t r = mul64x64(a.lo, b.lo);
+  r.hi += a.lo * b.hi + a.hi * b.lo;
+  return r;
+}
+
+/*
+ * Divide hi:lo by d with 64-bit operations only (Hacker's Delight divlu).
+ * Requires hi < d, so the quotient fits in 64 bits.
+ */
+static inline uint64_t div128by64(uint64_t hi, uint64_t lo, uint64_t d,
+                                  uint64_t *rem) {
+  const uint64_t b = (uint64_t)1 << 32;
+  unsigned s = clz64(d);
+  d <<= s;
+  uint64_t dn1 = d >> 32, dn0 = (uint32_t)d;
+  uint64_t un32 = (hi << s) | (s == 0 ? 0 : lo >> (64 - s));
+  uint64_t un10 = lo << s;
+  uint64_t un1 = un10 >> 32, un0 = (uint32_t)un10;
+
+  uint64_t q1 = un32 / dn1;
+  uint64_t rhat = un32 - q1 * dn1;
+  while (q1 >= b || q1 * dn0 > b * rhat + un1) {
+    --q1;
+    rhat += dn1;
+    if (rhat >= b) break;
+  }
+
+  uint64_t un21 = un32 * b + un1 - q1 * d;
+  uint64_t q0 = un21 / dn1;
+  rhat = un21 - q0 * dn1;
+  while (q0 >= b || q0 * dn0 > b * rhat + un0) {
+    --q0;
+    rhat += dn1;
+    if (rhat >= b) break;
+  }
+
+  if (rem) *rem = (un21 * b + un0 - q0 * d) >> s;
+  return q1 * b + q0;
+}
+
+/* Unsigned 128-bit division; traps on a zero divisor like i64.div_u. */
+static inline u128_t u128_divmod(u128_t a, u128_t b, u128_t *rem) {
+  if (b.hi == 0) {
+    if (b.lo == 0) __builtin_trap();
+    uint64_t r;
+    u128_t q;
+    if (a.hi < b.lo) {
+      q = u128_make(0, div128by64(a.hi, a.lo, b.lo, &r));
+    } else {
+      q.hi = a.hi / b.lo;
+      q.lo = div128by64(a.hi % b.lo, a.lo, b.lo, &r);
+    }
+    if (rem) *rem = u128_make(0, r);
+    return q;
+  }
+
+  /* Divisor has at least 65 bits: the quotient fits in 64 bits. */
+  unsigned n = clz64(b.hi);
+  uint64_t v1 = u128_shl(b, n).hi;
+  u128_t u1 = u128_shr(a, 1);
+  uint64_t q1 = div128by64(u1.hi, u1.lo, v1, 0);
+  uint64_t q0 = q1 >> (63 - n);
+  if (q0 != 0) --q0;
+  u128_t r = u128_sub(a, u128_mul(u128_make(0, q0), b));
+  if (!u128_lt(r, b)) {
+    ++q0;
+    r = u128_sub(r, b);
+  }
+  if (rem) *rem = r;
+  return u128_make(0, q0);
+}
+
+#endif /* PLATON_BUILTINS_INT_UTIL_H */
@@ -0,0 +1,12 @@
+/*
+ * The implementation the tuned routine replaces: the previous musl memcmp,
+ * a plain byte loop.
+ */
+#include <stddef.h>
+
+int base_memcmp(const void *vl, const void *vr, size_t n)
+{
+	const unsigned char *l=vl, *r=vr;
+	for (; n && *l == *r; n--, l++, r++);
+	return n ? *l-*r : 0;
+}
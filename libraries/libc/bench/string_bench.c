@@ -0,0 +1,93 @@
+/*
+ * Compares the tuned musl memcmp (bench_memcmp) with the byte loop it
+ * replaces (base_memcmp). It is first checked against the baseline on
+ * random sizes and offsets, then timed on the sizes contracts use most:
+ * addresses (20), hashes (32) and small to large buffers.
+ *
+ * Native timings show the relative cost of the loops only; under a wasm
+ * interpreter the gap grows with the number of executed instructions.
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int bench_memcmp(const void *, const void *, size_t);
+int base_memcmp(const void *, const void *, size_t);
+
+#define BUF_SIZE 8192
+
+static unsigned char src[BUF_SIZE + 64], dst[BUF_SIZE + 64];
+static volatile uint64_t sink;
+
+static uint64_t seed = 88172645463325252ULL;
+static uint64_t next(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed;
+}
+
+static int sign(int v) { return (v > 0) - (v < 0); }
+
+static int check(void)
+{
+	int failures = 0;
+	for (int i = 0; i < 200000; i++) {
+		size_t n = next() % 300, so = next() % 16, dof = next() % 16;
+		for (size_t k = 0; k < n; k++) src[so + k] = dst[dof + k] = (unsigned char)next();
+		if (n && next() % 2) dst[dof + next() % n] ^= (unsigned char)(1 + next() % 255);
+		failures += sign(bench_memcmp(dst + dof, src + so, n)) !=
+		            sign(base_memcmp(dst + dof, src + so, n));
+	}
+	return failures;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Repeat until at least 50ms have passed; report nanoseconds per call. */
+#define TIME(expr, out) do { \
+	long iters = 0, batch = 1024; \
+	double start = now(), elapsed; \
+	do { \
+		for (long j = 0; j < batch; j++) { expr; } \
+		iters += batch; \
+		elapsed = now() - start; \
+	} while (elapsed < 0.05); \
+	out = elapsed * 1e9 / iters; \
+} while (0)
+
+int main(void)
+{
+	static const size_t sizes[] = {8, 20, 32, 64, 256, 1024, 4096};
+	int failures = check();
+	if (failures) {
+		printf("%d mismatches against the baseline\n", failures);
+		return 1;
+	}
+
+	for (size_t k = 0; k < sizeof src; k++) src[k] = (unsigned char)(next() | 1);
+	for (size_t k = 0; k < sizeof dst; k++) dst[k] = src[k];
+
+	printf("%-8s %6s %12s %12s %8s\n", "func", "bytes", "base ns", "tuned ns", "speedup");
+	for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+		size_t n = sizes[i];
+		double base, tuned;
+
+#define ROW(name, b, t) do { \
+	TIME(b, base); TIME(t, tuned); \
+	printf("%-8s %6zu %12.2f %12.2f %7.2fx\n", name, n, base, tuned, base / tuned); \
+} while (0)
+
+		ROW("memcmp", sink += base_memcmp(dst, src, n),
+		    sink += bench_memcmp(dst, src, n));
+	}
+	return 0;
+}
@@ -7,6 +7,8 @@
 #include <iterator>
 #include <vector>
 #include <string>
+#include <limits>
+#include <stdint.h>
 #include <boost/multiprecision/cpp_int.hpp>
 #include "vector_ref.h"
 
@@ -191,4 +193,225 @@ namespace platon {
             ret = (T)((ret << 8) | (byte)(typename std::make_unsigned<decltype(i)>::type)i);
         return ret;
     }
+
+    namespace detail {
+        /**
+         * @brief Multiply two 64-bit integers into a 128-bit product without
+         * going through __int128 (which lowers to the __multi3 builtin).
+         * @param a  First factor.
+         * @param b  Second factor.
+         * @param hi Receives the high 64 bits of the product.
+         * @return The low 64 bits of the product.
+         */
+        inline constexpr uint64_t mulu64(uint64_t a, uint64_t b, uint64_t &hi) {
+            uint64_t a0 = uint32_t(a), a1 = a >> 32;
+            uint64_t b0 = uint32_t(b), b1 = b >> 32;
+            uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+            uint64_t mid = (p00 >> 32) + uint32_t(p01) + uint32_t(p10);
+            hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+            return (mid << 32) | uint32_t(p00);
+        }
+
+        /**
+         * @brief Count leading zero bits of a non-zero 64-bit integer.
+         */
+        inline constexpr unsigned clz64(uint64_t x) {
+            return unsigned(__builtin_clzll(x));
+        }
+
+        /**
+         * @brief Divide the 128-bit value hi:lo by a 64-bit divisor using only
+         * 64-bit operations (Hacker's Delight divlu). Requires hi < d.
+         * @param hi  High 64 bits of the dividend.
+         * @param lo  Low 64 bits of the dividend.
+         * @param d   Divisor, must be greater than hi.
+         * @param rem Receives the remainder.
+         * @return The 64-bit quotient.
+         */
+        inline constexpr uint64_t divu128(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem) {
+            const uint64_t b = uint64_t(1) << 32;
+            unsigned s = clz64(d);
+            d <<= s;
+            uint64_t dn1 = d >> 32, dn0 = uint32_t(d);
+            uint64_t un32 = (hi << s) | (s == 0 ? 0 : lo >> (64 - s));
+            uint64_t un10 = lo << s;
+            uint64_t un1 = un10 >> 32, un0 = uint32_t(un10);
+
+            uint64_t q1 = un32 / dn1;
+            uint64_t rhat = un32 - q1 * dn1;
+            while (q1 >= b || q1 * dn0 > b * rhat + un1) {
+                --q1;
+                rhat += dn1;
+                if (rhat >= b) break;
+            }
+
+            uint64_t un21 = un32 * b + un1 - q1 * d;
+            uint64_t q0 = un21 / dn1;
+            rhat = un21 - q0 * dn1;
+            while (q0 >= b || q0 * dn0 > b * rhat + un0) {
+                --q0;
+                rhat += dn1;
+                if (rhat >= b) break;
+            }
+
+            rem = (un21 * b + un0 - q0 * d) >> s;
+            return q1 * b + q0;
+        }
+
+        /**
+         * @brief Fixed-width unsigned boost integer, e.g. u128, u256 or u512.
+         */
+        template <typename T>
+        struct IsFixedUnsigned : std::false_type {};
+
+        template <unsigned Bits>
+        struct IsFixedUnsigned<boost::multiprecision::number<boost::multiprecision::cpp_int_backend<Bits, Bits,
+                boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>>>
+                : std::true_type {
+            static constexpr unsigned kLimbs = (Bits + 63) / 64;
+        };
+
+        /**
+         * @brief Copy the magnitude of a boost integer into 64-bit limbs,
+         * least significant first.
+         * @param v     Value.
+         * @param limbs Receives the limbs.
+         * @param n     Number of limbs, must cover the value.
+         */
+        template <typename T>
+        inline void toLimbs(const T &v, uint64_t *limbs, size_t n) {
+            const auto &backend = v.backend();
+            typedef typename std::decay<decltype(*backend.limbs())>::type limb_type;
+            constexpr unsigned bits = sizeof(limb_type) * 8;
+            for (size_t i = 0; i < n; ++i) limbs[i] = 0;
+            for (size_t i = 0; i < backend.size() && i * bits < n * 64; ++i) {
+                size_t pos = i * bits;
+                limbs[pos / 64] |= uint64_t(backend.limbs()[i]) << (pos % 64);
+            }
+        }
+
+        /**
+         * @brief Build a boost integer from 64-bit limbs, least significant first.
+         * @param limbs Limbs.
+         * @param n     Number of limbs.
+         * @param v     Receives the value.
+         */
+        template <typename T>
+        inline void fromLimbs(const uint64_t *limbs, size_t n, T &v) {
+            auto &backend = v.backend();
+            typedef typename std::decay<decltype(*backend.limbs())>::type limb_type;
+            constexpr unsigned bits = sizeof(limb_type) * 8;
+            unsigned count = unsigned(n * 64 / bits);
+            backend.resize(count, count);
+            count = backend.size();
+            for (unsigned i = 0; i < count; ++i) {
+                size_t pos = size_t(i) * bits;
+                backend.limbs()[i] = limb_type(limbs[pos / 64] >> (pos % 64));
+            }
+            backend.normalize();
+        }
+
+        /**
+         * @brief Write the decimal digits of a limb array backwards, dividing by
+         * 10^19 per step. The limbs are consumed (left zero).
+         * @param limbs Value as 64-bit limbs, least significant first.
+         * @param n     Number of limbs.
+         * @param end   One past the last character of the output buffer, which
+         *              must hold at least 20 characters per limb.
+         * @return Pointer to the first digit.
+         */
+        inline char *formatDecimal(uint64_t *limbs, size_t n, char *end) {
+            const uint64_t kChunk = 10000000000000000000ULL;
+            while (n > 0 && limbs[n - 1] == 0) --n;
+            while (n > 1) {
+                uint64_t rem = 0;
+                for (size_t i = n; i > 0; --i) {
+                    limbs[i - 1] = divu128(rem, limbs[i - 1], kChunk, rem);
+                }
+                if (limbs[n - 1] == 0) --n;
+                for (int i = 0; i < 19; ++i) {
+                    *--end = char('0' + rem % 10);
+                    rem /= 10;
+                }
+            }
+            uint64_t v = n == 0 ? 0 : limbs[0];
+            do {
+                *--end = char('0' + v % 10);
+                v /= 10;
+            } while (v != 0);
+            return end;
+        }
+
+        /**
+         * @brief Parse a decimal string into 64-bit limbs, 19 digits per
+         * multiply-add step.
+         * @param s     Digits.
+         * @param len   Number of digits.
+         * @param limbs Receives the value, least significant first.
+         * @param n     Number of limbs.
+         * @return false if the string is empty, has a non-digit or overflows.
+         */
+        inline bool parseDecimal(const char *s, size_t len, uint64_t *limbs, size_t n) {
+            for (size_t i = 0; i < n; ++i) limbs[i] = 0;
+            if (len == 0) return false;
+            size_t pos = 0;
+            while (pos < len) {
+                size_t count = std::min<size_t>(19, len - pos);
+                uint64_t chunk = 0, scale = 1;
+                for (size_t i = 0; i < count; ++i, ++pos) {
+                    if (s[pos] < '0' || s[pos] > '9') return false;
+                    chunk = chunk * 10 + uint64_t(s[pos] - '0');
+                    scale *= 10;
+                }
+                uint64_t carry = chunk;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t hi;
+                    uint64_t lo = mulu64(limbs[i], scale, hi);
+                    lo += carry;
+                    carry = hi + (lo < carry);
+                    limbs[i] = lo;
+                }
+                if (carry != 0) return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Convert a fixed-width unsigned integer (u128, u160, u256, u512)
+     * to its decimal representation without multiprecision division.
+     * @param v Value.
+     * @return Decimal string.
+     */
+    template <typename T, std::enable_if_t<detail::IsFixedUnsigned<T>::value, int> = 0>
+    inline std::string toString(const T &v) {
+        constexpr size_t n = detail::IsFixedUnsigned<T>::kLimbs;
+        uint64_t limbs[n];
+        char buf[n * 20];
+        detail::toLimbs(v, limbs, n);
+        char *begin = detail::formatDecimal(limbs, n, buf + sizeof(buf));
+        return std::string(begin, buf + sizeof(buf));
+    }
+
+    /**
+     * @brief Parse a decimal string into a fixed-width unsigned integer
+     * (u128, u160, u256, u512).
+     * @param s Decimal string, digits only.
+     * @param v Receives the value, zero on failure.
+     * @return false if the string is empty, not decimal or out of range.
+     */
+    template <typename T, std::enable_if_t<detail::IsFixedUnsigned<T>::value, int> = 0>
+    inline bool fromString(const std::string &s, T &v) {
+        constexpr unsigned bits = std::numeric_limits<T>::digits;
+        constexpr size_t n = detail::IsFixedUnsigned<T>::kLimbs;
+        uint64_t limbs[n];
+        bool ok = detail::parseDecimal(s.data(), s.size(), limbs, n);
+        if (ok && bits % 64 != 0 && (limbs[n - 1] >> (bits % 64)) != 0) ok = false;
+        if (!ok) {
+            v = 0;
+            return false;
+        }
+        detail::fromLimbs(limbs, n, v);
+        return true;
+    }
 }
@@ -13,6 +13,9 @@ extern "C" {
    *  @defgroup compilerbuiltinsapi Compiler Builtins API
    *  @ingroup mathapi
    *  @brief Declares int128 helper builtins generated by the toolchain. 
+   *
+   *  They are implemented in wasm by libbuiltins, which platon-ld links by
+   *  default. Pass `-host-builtins` to import them from the VM instead.
    *  
    *  @{
    */
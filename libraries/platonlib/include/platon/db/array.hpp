@@ -26,7 +26,7 @@ namespace db {
         class Iterator: public std::iterator<std::bidirectional_iterator_tag, Key> {
         public:
             friend bool operator == ( const Iterator& a, const Iterator& b ) {
-                return a.array_ == b.array_ && a.pos_ = b.pos_;
+                return a.array_ == b.array_ && a.pos_ == b.pos_;
             }
             friend bool operator != ( const Iterator& a, const Iterator& b ) {
                 return a.array_ != b.array_ || a.pos_ != b.pos_;
@@ -95,7 +95,7 @@ namespace db {
         class ConstIterator: public std::iterator<std::bidirectional_iterator_tag, const Key> {
         public:
             friend bool operator == ( const ConstIterator& a, const ConstIterator& b ) {
-                return a.array_ == b.array_ && a.pos_ = b.pos_;
+                return a.array_ == b.array_ && a.pos_ == b.pos_;
             }
             friend bool operator != ( const ConstIterator& a, const ConstIterator& b ) {
                 return a.array_ != b.array_ || a.pos_ != b.pos_;
@@ -167,7 +167,7 @@ namespace db {
         class ConstReverseIterator: public std::iterator<std::bidirectional_iterator_tag, const Key> {
         public:
             friend bool operator == ( const ConstReverseIterator& a, const ConstReverseIterator& b ) {
-                return a.array_ == b.array_ && a.pos_ = b.pos_;
+                return a.array_ == b.array_ && a.pos_ == b.pos_;
             }
             friend bool operator != ( const ConstReverseIterator& a, const ConstReverseIterator& b ) {
                 return a.array_ != b.array_ || a.pos_ != b.pos_;
@@ -325,6 +325,7 @@ namespace db {
          * @return Key& Element value
          */
         Key& at(size_t pos) {
+            PLATON_TRACE_CONTAINER(Name);
             PlatonAssert(pos < Size, "out of range pos:", pos, "size:", Size);
             auto iter = cache_.find(pos);
             if (iter != cache_.end()) {
@@ -363,6 +364,7 @@ namespace db {
          * @return Key Element value
          */
         Key getConst(size_t pos) {
+            PLATON_TRACE_CONTAINER(Name);
             auto iter = cache_.find(pos);
             if (iter != cache_.end()) {
                 return iter->second;
@@ -379,6 +381,8 @@ namespace db {
          * @param key 
          */
         void setConst(size_t pos, const Key &key) {
+            PLATON_TRACE_CONTAINER(Name);
+            checkWritable("Array::setConst");
             auto iter = cache_.find(pos);
             if (iter != cache_.end()) {
                 cache_[pos] = key;
@@ -408,6 +412,10 @@ namespace db {
          * 
          */
         void flush() {
+            PLATON_TRACE_CONTAINER(Name);
+            if (isReadOnlyMode()) {
+                return;
+            }
             for (auto iter : cache_) {
                 std::string key = encodeKey(iter.first);
                 setState(key, iter.second);
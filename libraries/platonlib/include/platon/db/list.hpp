@@ -91,7 +91,7 @@ namespace platon {
         class Iterator : public std::iterator<std::bidirectional_iterator_tag, Key>{
         public:
             friend bool operator == ( const Iterator& a, const Iterator& b ) {
-                return a.list_ == b.list_ && a.pos_ = b.pos_;
+                return a.list_ == b.list_ && a.pos_ == b.pos_;
             }
             friend bool operator != ( const Iterator& a, const Iterator& b ) {
                 return a.list_ != b.list_ || a.pos_ != b.pos_;
@@ -160,7 +160,7 @@ namespace platon {
         class ConstIterator : public std::iterator<std::bidirectional_iterator_tag, Key>{
         public:
             friend bool operator == ( const ConstIterator &a, const ConstIterator &b ) {
-                return a.list_ == b.list_ && a.pos_ = b.pos_;
+                return a.list_ == b.list_ && a.pos_ == b.pos_;
             }
             friend bool operator != ( const ConstIterator &a, const ConstIterator &b ) {
                 return a.list_ != b.list_ || a.pos_ != b.pos_;
@@ -228,12 +228,11 @@ namespace platon {
         typedef std::reverse_iterator<ConstIterator> ConstReverseIterator;
     public:
         /**
-         * @brief Construct a new List object
+         * @brief Construct a new List object. The list is loaded from the
+         * blockchain on first use.
          * 
          */
-        List(){
-            init();
-        }
+        List(){}
 
         List(const List<Name, Key> &) = delete;
         List(const List<Name, Key> &&) = delete;
@@ -253,6 +252,7 @@ namespace platon {
          * @return Iterator 
          */
         Iterator begin() {
+            init();
             return Iterator(this, 1);
         }
         /**
@@ -261,6 +261,7 @@ namespace platon {
          * @return Iterator 
          */
         Iterator end() {
+            init();
             return Iterator(this, size_+1);
         }
 
@@ -288,6 +289,7 @@ namespace platon {
          * @return ConstIterator 
          */
         ConstIterator cbegin() {
+            init();
             return ConstIterator(this, 1);
         }
 
@@ -297,6 +299,7 @@ namespace platon {
          * @return ConstIterator 
          */
         ConstIterator cend() {
+            init();
             return ConstIterator(this, size_+1);
         }
 
@@ -324,6 +327,9 @@ namespace platon {
          * @param k element
          */
         void push(const Key &k){
+            checkWritable("List::push");
+            init();
+            dirty_ = true;
             cache_[maxNumber_++] = Item(k, MOD);
             mark_.push_back(true);
             ++size_;
@@ -336,6 +342,9 @@ namespace platon {
          * @return Key& element
          */
         Key& get(size_t index) {
+            PLATON_TRACE_CONTAINER(Name);
+            init();
+            dirty_ = true;
             PlatonAssert(index < size_, "out of range", "index:", index, "size:", size_);
 
 
@@ -375,6 +384,10 @@ namespace platon {
          * @param index element
          */
         void del(size_t index) {
+            PLATON_TRACE_CONTAINER(Name);
+            checkWritable("List::del");
+            init();
+            dirty_ = true;
             PlatonAssert(index < size_, "out of range index:", index, "size:", size_);
             auto iter = cache_.find(index);
             if (iter != cache_.end()) {
@@ -406,6 +419,10 @@ namespace platon {
          * @param delKey Specified element value
          */
         void del(const Key &delKey) {
+            PLATON_TRACE_CONTAINER(Name);
+            checkWritable("List::del");
+            init();
+            dirty_ = true;
             for (size_t i = 0; i < mark_.size(); ++i) {
                 if (mark_[i]) {
                     Key res;
@@ -438,6 +455,8 @@ namespace platon {
          * @return Key element
          */
         Key getConst(size_t index) {
+            PLATON_TRACE_CONTAINER(Name);
+            init();
             PlatonAssert(index < size_, "out of range", "index:", index, "size:", size_);
 
 
@@ -475,6 +494,10 @@ namespace platon {
          * @param key element
          */
         void setConst(size_t index , const Key &key)  {
+            PLATON_TRACE_CONTAINER(Name);
+            checkWritable("List::setConst");
+            init();
+            dirty_ = true;
             PlatonAssert(index < size_, "out of range", "index:", index, "size:", size_);
 
 
@@ -505,6 +528,7 @@ namespace platon {
          * @return size_t 
          */
         size_t size() {
+            init();
             return size_;
         }
 
@@ -516,16 +540,25 @@ namespace platon {
          * 
          */
         void init() {
+            PLATON_TRACE_CONTAINER(Name);
+            if (init_) {
+                return;
+            }
+            init_ = true;
             getMaxNumber();
             getSize();
             getMark();
         }
 
         /**
-         * @brief Refresh data to blockchain
+         * @brief Refresh data to blockchain, if the list was modified
          * 
          */
         void flush() {
+            PLATON_TRACE_CONTAINER(Name);
+            if (!dirty_ || isReadOnlyMode()) {
+                return;
+            }
             for (auto it : cache_) {
                 if (it.second.getState() == DEL) {
                     platon::delState(encodeKey(it.first));
@@ -612,6 +645,8 @@ namespace platon {
         const std::string name_ = kType + Name;
         const std::string maxNumberKey_ = name_ + "maxNumber";
         const std::string sizeKey_ = name_ + "size";
+        bool init_ = false;
+        bool dirty_ = false;
     };
     template <const char *Name, typename Key>
     const std::string List<Name, Key>::kType = "__list__";
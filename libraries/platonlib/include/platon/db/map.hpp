@@ -354,6 +354,7 @@ namespace platon {
          * @return false Insert failed
          */
         bool insert(const Key &k, const Value &v) {
+            checkWritable("Map::insert");
             init();
             map_[k] = v;
             modify_.insert(k);
@@ -373,9 +374,12 @@ namespace platon {
          * @return false Insert failed
          */
         bool insertConst(const Key &k, const Value &v) {
+            PLATON_TRACE_CONTAINER(Name);
+            checkWritable("Map::insertConst");
             init();
             if (type == MapType::Traverse) {
                 keySet_.insert(k);
+                keySetModified_ = true;
             }
 
             if (map_.find(k) != map_.end()) {
@@ -393,6 +397,7 @@ namespace platon {
          * @return Value 
          */
         Value getConst(const Key &k) {
+            PLATON_TRACE_CONTAINER(Name);
             init();
             auto iter = map_.find(k);
             if (iter != map_.end()) {
@@ -411,6 +416,7 @@ namespace platon {
          * @return Value& 
          */
         Value& get(const Key &k) {
+            PLATON_TRACE_CONTAINER(Name);
             init();
             auto iter = map_.find(k);
             if (iter != map_.end()) {
@@ -433,6 +439,7 @@ namespace platon {
          * @param k Key
          */
         void del(const Key &k) {
+            checkWritable("Map::del");
             init();
             auto iter = map_.find(k);
             if (iter != map_.end()) {
@@ -476,6 +483,10 @@ namespace platon {
          * 
          */
         void flush() {
+            PLATON_TRACE_CONTAINER(Name);
+            if ((modify_.empty() && !keySetModified_) || isReadOnlyMode()) {
+                return;
+            }
             std::for_each(
                     modify_.begin(),
                     modify_.end(),
@@ -584,6 +595,7 @@ namespace platon {
          * 
          */
         void init() {
+            PLATON_TRACE_CONTAINER(Name);
             if (!init_ && type == MapType::Traverse) {
                 platon::getState(keySetName_, keySet_);
                 init_ = true;
@@ -593,6 +605,7 @@ namespace platon {
         std::map<Key, Value> map_;
         std::set<Key> keySet_;
         std::set<Key> modify_;
+        bool keySetModified_ = false;
         const std::string keySetName_ = kType + Name;
         bool init_ = false;
     };
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "fixedhash.hpp"
+#include "trace.hpp"
 #include "txencode.hpp"
 
 #ifdef __cplusplus
@@ -60,7 +61,9 @@ namespace platon {
             txEncode(stream, kTxType, funcName, args...);
             const bytes& rlpData = stream.out();
             char *data = ::platonCallString(address_.data(), rlpData.data(), rlpData.size());
-            return std::string(data);
+            std::string result(data);
+            PLATON_TRACE_OP(kCall, rlpData.size() + result.size());
+            return result;
         }
 
         /**
@@ -77,7 +80,9 @@ namespace platon {
             txEncode(stream, kTxType, funcName, args...);
             const bytes& rlpData = stream.out();
             char *data = ::platonDelegateCallString(address_.data(), rlpData.data(), rlpData.size());
-            return std::string(data);
+            std::string result(data);
+            PLATON_TRACE_OP(kCall, rlpData.size() + result.size());
+            return result;
         }
 
         /**
@@ -93,6 +98,7 @@ namespace platon {
             RLPStream stream(sizeof...(args) + 2);
             txEncode(stream, kTxType, funcName, args...);
             const bytes& rlpData = stream.out();
+            PLATON_TRACE_OP(kCall, rlpData.size() + sizeof(int64_t));
             return ::platonCallInt64(address_.data(), rlpData.data(), rlpData.size());
         }
 
@@ -110,6 +116,7 @@ namespace platon {
             txEncode(stream, kTxType, funcName, args...);
 
             const bytes& rlpData = stream.out();
+            PLATON_TRACE_OP(kCall, rlpData.size() + sizeof(int64_t));
             return ::platonDelegateCallInt64(address_.data(), rlpData.data(), rlpData.size());
         }
 
@@ -126,6 +133,7 @@ namespace platon {
             txEncode(stream, kTxType, funcName, args...);
 
             const bytes& rlpData = stream.out();
+            PLATON_TRACE_OP(kCall, rlpData.size());
             ::platonCall(address_.data(),rlpData.data(), rlpData.size());
         }
 
@@ -141,6 +149,7 @@ namespace platon {
             RLPStream stream(sizeof...(args) + 2);
             txEncode(stream, kTxType, funcName, args...);
             const bytes& rlpData = stream.out();
+            PLATON_TRACE_OP(kCall, rlpData.size());
             ::platonDelegateCall(address_.data(), rlpData.data(), rlpData.size());
         }
 
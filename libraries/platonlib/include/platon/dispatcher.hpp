@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "storage.hpp"
+#include "txdecode.hpp"
+#include "txencode.hpp"
+
+/**
+ * @brief Support for the single `invoke` entry point that platon-abigen
+ * generates with -dispatch. The VM calls invoke like any other export: the
+ * call data comes in as its string argument and the result goes back as
+ * its string return value, both hex encoded.
+ * 
+ */
+namespace platon {
+
+    /**
+     * @brief Selector of a method name, FNV-1a over its bytes. Usable in case
+     * labels, so two methods with the same selector fail to compile.
+     * 
+     * @param name Method name
+     * @return uint32_t Selector
+     */
+    constexpr uint32_t methodSelector(const char *name, uint32_t hash = 2166136261u) {
+        return *name == 0 ? hash : methodSelector(name + 1, (hash ^ uint8_t(*name)) * 16777619u);
+    }
+
+    /**
+     * @brief Call data passed to invoke: the hex encoded RLP list
+     * [txType, method, args...] built by txEncode.
+     * 
+     */
+    class Dispatcher {
+    public:
+        /**
+         * @brief Parse the call data. It is decoded from hex once and every
+         * argument is decoded in place.
+         * 
+         * @param input Hex encoded call data, the argument of invoke
+         */
+        explicit Dispatcher(const char *input) : input_(fromHex(input)) {
+            rlp_ = RLP(input_);
+            if (rlp_.itemCount() < 2) {
+                platonThrow("bad call data");
+            }
+            method_ = rlp_[1].toBytesConstRef(RLP::ThrowOnFail);
+            selector_ = 2166136261u;
+            for (size_t i = 0; i < method_.size(); i++) {
+                selector_ = (selector_ ^ method_[i]) * 16777619u;
+            }
+        }
+
+        Dispatcher(const Dispatcher &) = delete;
+
+        /**
+         * @brief Selector of the called method, see methodSelector
+         * 
+         * @return uint32_t Selector
+         */
+        uint32_t selector() const { return selector_; }
+
+        /**
+         * @brief Whether the called method is name. Used to reject a name that
+         * only shares the selector of an exported method.
+         * 
+         * @param name Method name
+         */
+        bool is(const char *name) const {
+            return method_.size() == strlen(name) && memcmp(method_.data(), name, method_.size()) == 0;
+        }
+
+        /**
+         * @brief Number of call arguments
+         * 
+         */
+        size_t argCount() const { return rlp_.itemCount() - 2; }
+
+        /**
+         * @brief Decode argument i
+         * 
+         * @tparam T Argument type
+         * @param i Argument index
+         * @return T Argument value
+         */
+        template<typename T>
+        T arg(size_t i) const {
+            return txDecode<T>(rlp_[i + 2]);
+        }
+
+        /**
+         * @brief Return an integer or floating point value, big-endian like txEncode
+         * 
+         * @tparam T Value type
+         * @param v Return value
+         */
+        template<typename T>
+        typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type ret(T v) {
+            typedef typename detail::TxBits<T>::type Bits;
+            Bits bits;
+            memcpy(&bits, &v, sizeof(bits));
+            uint8_t out[sizeof(bits)];
+            for (size_t i = sizeof(bits); i > 0; i--) {
+                out[i - 1] = uint8_t(bits);
+                bits = Bits(bits >> 8);
+            }
+            output_ = toHex(out, out + sizeof(out), "");
+        }
+
+        /**
+         * @brief Return a string
+         * 
+         * @param v Return value
+         */
+        void ret(const char *v) {
+            output_ = toHex(v, v + strlen(v), "");
+        }
+
+        /**
+         * @brief Return a string, bytes, a big integer, a hash, a container or a
+         * PLATON_SERIALIZE class. Byte strings are returned as is, lists as
+         * their RLP encoding.
+         * 
+         * @tparam T Value type
+         * @param v Return value
+         */
+        template<typename T>
+        typename std::enable_if<std::is_class<T>::value>::type ret(const T &v) {
+            RLPStream stream;
+            txEncode(stream, v);
+            const bytes &out = stream.out();
+            RLP rlp(out);
+            bytesConstRef data = rlp.isData() ? rlp.toBytesConstRef() : bytesConstRef(&out);
+            output_ = toHex(data);
+        }
+
+        /**
+         * @brief The hex encoded value passed to ret, empty when the method
+         * returns nothing.
+         * 
+         * @return const std::string& Return value
+         */
+        const std::string &output() const { return output_; }
+
+        /**
+         * @brief A heap copy of output for invoke to return. It outlives the
+         * dispatcher; invoke returns it through RETURN so the VM does not
+         * free it before reading it.
+         * 
+         * @return const char* Return value
+         */
+        const char *result() const {
+            char *ret = static_cast<char *>(malloc(output_.size() + 1));
+            memcpy(ret, output_.c_str(), output_.size() + 1);
+            return ret;
+        }
+
+    private:
+        bytes input_;
+        RLP rlp_;
+        bytesConstRef method_;
+        uint32_t selector_;
+        std::string output_;
+    };
+}
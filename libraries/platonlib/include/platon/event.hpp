@@ -3,6 +3,7 @@
 #include "print.hpp"
 #include "common.h"
 #include "RLP.h"
+#include "trace.hpp"
 
 #define ARG_COUNT_P1_(\
   _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, N, ...) \
@@ -223,6 +224,7 @@ namespace platon {
         RLPStream stream(sizeof...(args));
         event(stream, args...);
         const bytes& rlpData = stream.out();
+        PLATON_TRACE_OP(kEvent, topic.length() + rlpData.size());
         ::emitEvent(topic.data(), topic.length(),rlpData.data(), rlpData.size());
     }
 }
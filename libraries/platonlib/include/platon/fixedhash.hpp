@@ -88,4 +88,12 @@ namespace platon {
     using h128 = FixedHash<16>;
     using h64 = FixedHash<8>;
     using Address = FixedHash<20>;
+
+    namespace detail {
+        template <typename T>
+        struct IsFixedHash : std::false_type {};
+
+        template <unsigned N>
+        struct IsFixedHash<FixedHash<N>> : std::true_type {};
+    }
 }
@@ -0,0 +1,36 @@
+/**
+ *  @file
+ *  @brief Statistics of the in-contract heap.
+ */
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+   /**
+    * @brief Counters kept by the arena allocator.
+    */
+   struct platon_heap_stats {
+      size_t allocs;    ///< Successful malloc/calloc/realloc allocations
+      size_t frees;     ///< Calls to free with a non-null pointer
+      size_t reused;    ///< Allocations served from a size-class free list
+      size_t in_use;    ///< Bytes currently allocated, headers included
+      size_t peak;      ///< Highest heap footprint in bytes
+   };
+
+   /**
+    * Read the allocator counters of the current call.
+    *
+    * Only defined when the contract is linked with `-allocator=arena` or
+    * `-allocator=arena-freelist`; with the default host allocator the
+    * symbol stays unresolved.
+    *
+    * @brief Read the allocator counters of the current call
+    * @param stats Receives the counters
+    */
+   void platon_get_heap_stats( struct platon_heap_stats* stats );
+#ifdef __cplusplus
+}
+#endif
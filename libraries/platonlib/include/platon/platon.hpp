@@ -13,6 +13,7 @@
 #include "platon/db/list.hpp"
 #include "platon/db/map.hpp"
 #include "platon/storagetype.hpp"
+#include "platon/uint256.hpp"
 #include "platon/deployedcontract.hpp"
 #include "platon/name.hpp"
 
@@ -6,6 +6,12 @@
 
 #include <stdint.h>
 
+#ifdef PLATON_NATIVE
+/* musl's stdint.h defines these for wasm; glibc has no counterpart. */
+typedef __int128 int128_t;
+typedef unsigned __int128 uint128_t;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -1,22 +1,190 @@
 #pragma once
 #include "print.h"
 #include "common.h"
+#include "fixedhash.hpp"
+#include "uint256.hpp"
+#include <string.h>
 #include <utility>
 #include <string>
 
-#ifdef ENABLE_TRACE
+/**
+ * Define DISABLE_PRINT to strip all console output from a build. The print
+ * functions then compile to nothing and TRACE/DEBUG do not evaluate their
+ * arguments.
+ */
+#if defined(ENABLE_TRACE) && !defined(DISABLE_PRINT)
 #define TRACE(...) platon::println("file", __FILE__, "func", __func__, "line", __LINE__, ##__VA_ARGS__)
 #else
 #define TRACE(...)
 #endif
 
-#ifdef ENABLE_TRACE
+#ifdef DISABLE_PRINT
+#define DEBUG(...)
+#elif defined(ENABLE_TRACE)
 #define DEBUG(...) platon::println("file", __FILE__, "func", __func__, "line", __LINE__, ##__VA_ARGS__)
 #else
 #define DEBUG(...)  platon::println(__VA_ARGS__)
 #endif
 
 namespace platon {
+    namespace detail {
+        /**
+         * @brief Output buffer of a single print call. Fragments are
+         * formatted in wasm and handed to the host with one prints_l when the
+         * buffer fills up or goes out of scope.
+         */
+        class PrintBuffer {
+        public:
+            PrintBuffer() = default;
+            PrintBuffer(const PrintBuffer &) = delete;
+            PrintBuffer &operator=(const PrintBuffer &) = delete;
+            ~PrintBuffer() { flush(); }
+
+            void append(char c) {
+                if (size_ == kSize) flush();
+                buf_[size_++] = c;
+            }
+
+            void append(const char *s, size_t len) {
+                if (len > kSize - size_) {
+                    flush();
+                    if (len > kSize) {
+                        ::prints_l(s, len);
+                        return;
+                    }
+                }
+                memcpy(buf_ + size_, s, len);
+                size_ += len;
+            }
+
+            void append(const char *s) { append(s, strlen(s)); }
+
+            void appendUnsigned(uint64_t v) {
+                char digits[20];
+                size_t pos = sizeof(digits);
+                do {
+                    digits[--pos] = char('0' + v % 10);
+                    v /= 10;
+                } while (v != 0);
+                append(digits + pos, sizeof(digits) - pos);
+            }
+
+            void appendSigned(int64_t v) {
+                if (v < 0) {
+                    append('-');
+                    appendUnsigned(0 - uint64_t(v));
+                } else {
+                    appendUnsigned(uint64_t(v));
+                }
+            }
+
+            void appendUnsigned(uint128_t v) {
+                uint64_t limbs[2] = {uint64_t(v), uint64_t(v >> 64)};
+                appendDecimal(limbs, 2);
+            }
+
+            void appendSigned(int128_t v) {
+                if (v < 0) {
+                    append('-');
+                    appendUnsigned(uint128_t(0) - uint128_t(v));
+                } else {
+                    appendUnsigned(uint128_t(v));
+                }
+            }
+
+            void appendUnsigned(const uint256 &v) {
+                uint64_t limbs[uint256::kLimbs];
+                for (unsigned i = 0; i < uint256::kLimbs; ++i) limbs[i] = v.limb(i);
+                appendDecimal(limbs, uint256::kLimbs);
+            }
+
+            /**
+             * @brief Append a fixed-width boost integer (u128 ... u512).
+             */
+            template <typename T, std::enable_if_t<IsFixedUnsigned<T>::value, int> = 0>
+            void appendUnsigned(const T &v) {
+                uint64_t limbs[IsFixedUnsigned<T>::kLimbs];
+                toLimbs(v, limbs, IsFixedUnsigned<T>::kLimbs);
+                appendDecimal(limbs, IsFixedUnsigned<T>::kLimbs);
+            }
+
+            /**
+             * @brief Append the decimal form of a limb array, consuming it.
+             */
+            void appendDecimal(uint64_t *limbs, size_t n) {
+                char digits[8 * 20];
+                if (n > 8) {
+                    std::string s;
+                    s.resize(n * 20);
+                    char *end = &s[0] + s.size();
+                    char *begin = formatDecimal(limbs, n, end);
+                    append(begin, end - begin);
+                    return;
+                }
+                char *end = digits + n * 20;
+                char *begin = formatDecimal(limbs, n, end);
+                append(begin, end - begin);
+            }
+
+            void appendHex(const byte *data, size_t len) {
+                static const char *hexdigits = "0123456789abcdef";
+                for (size_t i = 0; i < len; ++i) {
+                    append(hexdigits[(data[i] >> 4) & 0x0f]);
+                    append(hexdigits[data[i] & 0x0f]);
+                }
+            }
+
+            void flush() {
+                if (size_ != 0) {
+                    ::prints_l(buf_, size_);
+                    size_ = 0;
+                }
+            }
+
+        private:
+            static const size_t kSize = 256;
+            char buf_[kSize];
+            size_t size_ = 0;
+        };
+
+        inline void printTo(PrintBuffer &buf) {}
+
+        /**
+         * @brief Format a value into the buffer. Types without an in-wasm
+         * formatter flush the buffer and fall back to their print() overload.
+         */
+        template <typename T>
+        void printTo(PrintBuffer &buf, const T &t);
+
+        /**
+         * @brief Format values separated by a space.
+         */
+        template <typename Arg, typename... Args>
+        inline void printTo(PrintBuffer &buf, const Arg &a, const Args &... args) {
+            printTo(buf, a);
+            buf.append(' ');
+            printTo(buf, args...);
+        }
+
+        inline void printfTo(PrintBuffer &buf, const char *s) {
+            buf.append(s);
+        }
+
+        template <typename Arg, typename... Args>
+        inline void printfTo(PrintBuffer &buf, const char *s, const Arg &val, const Args &... rest) {
+            const char *begin = s;
+            while (*s != '\0') {
+                if (*s == '%') {
+                    buf.append(begin, s - begin);
+                    printTo(buf, val);
+                    printfTo(buf, s + 1, rest...);
+                    return;
+                }
+                s++;
+            }
+            buf.append(begin, s - begin);
+        }
+    }
 
     /**
     *  Prints string
@@ -25,7 +193,9 @@ namespace platon {
     *  @param ptr - a null terminated string
     */
     inline void print( const char* ptr ) {
+#ifndef DISABLE_PRINT
         prints(ptr);
+#endif
     }
 
     /**
@@ -37,13 +207,16 @@ namespace platon {
     template <typename T, std::enable_if_t<std::is_integral<std::decay_t<T>>::value &&
                                            std::is_signed<std::decay_t<T>>::value, int> = 0>
     inline void print(T num) {
+#ifndef DISABLE_PRINT
         if constexpr(std::is_same<T, int128_t>::value) {
-            printi128(&num);
+            detail::PrintBuffer buf;
+            buf.appendSigned(num);
         } else if constexpr(std::is_same<T, char>::value) {
             prints_l(&num, 1);
         } else {
             printi(num);
         }
+#endif
     }
 
     /**
@@ -55,22 +228,32 @@ namespace platon {
     template <typename T, std::enable_if_t<std::is_integral<std::decay_t<T>>::value &&
                                            !std::is_signed<std::decay_t<T>>::value, int> = 0>
     inline void print(T num) {
+#ifndef DISABLE_PRINT
         if constexpr(std::is_same<T, uint128_t>::value) {
-            printui128(&num);
+            detail::PrintBuffer buf;
+            buf.appendUnsigned(num);
         } else if constexpr(std::is_same<T, bool>::value) {
             prints(num ? "true" : "false");
         } else {
             printui(num);
         }
+#endif
     }
 
     template <typename T, std::enable_if_t<!std::is_integral<std::decay_t<T>>::value, int> = 0>
     inline void print(T&& t) {
+#ifndef DISABLE_PRINT
         if constexpr(std::is_same<std::decay_t<T>, std::string>::value) {
             prints_l(t.c_str(), t.size());
         } else if constexpr(std::is_same<std::decay_t<T>, char*>::value) {
             prints(t);
+        } else if constexpr(std::is_same<std::decay_t<T>, uint256>::value ||
+                            detail::IsFixedUnsigned<std::decay_t<T>>::value ||
+                            detail::IsFixedHash<std::decay_t<T>>::value) {
+            detail::PrintBuffer buf;
+            detail::printTo(buf, t);
         }
+#endif
     }
 
     /**
@@ -80,7 +263,10 @@ namespace platon {
      * @param num to be printed
      */
     inline void print(u256 num) {
-        print(num.convert_to<std::string>());
+#ifndef DISABLE_PRINT
+        detail::PrintBuffer buf;
+        buf.appendUnsigned(num);
+#endif
     }
 
     /**
@@ -89,7 +275,11 @@ namespace platon {
     * @brief Prints single-precision floating point number (i.e. float)
     * @param num to be printed
     */
-    inline void print( float num ) { printsf( num ); }
+    inline void print( float num ) {
+#ifndef DISABLE_PRINT
+        printsf( num );
+#endif
+    }
 
     /**
     * Prints double-precision floating point number
@@ -97,7 +287,11 @@ namespace platon {
     * @brief Prints double-precision floating point number (i.e. double)
     * @param num to be printed
     */
-    inline void print( double num ) { printdf( num ); }
+    inline void print( double num ) {
+#ifndef DISABLE_PRINT
+        printdf( num );
+#endif
+    }
 
     /**
     * Prints quadruple-precision floating point number
@@ -105,10 +299,54 @@ namespace platon {
     * @brief Prints quadruple-precision floating point number (i.e. long double)
     * @param num to be printed
     */
-    inline void print( long double num ) { printqf( &num ); }
+    inline void print( long double num ) {
+#ifndef DISABLE_PRINT
+        printqf( &num );
+#endif
+    }
 
     inline void print(){}
 
+    namespace detail {
+        template <typename T>
+        void printTo(PrintBuffer &buf, const T &t) {
+            using Type = std::decay_t<T>;
+            if constexpr(std::is_same<Type, bool>::value) {
+                buf.append(t ? "true" : "false");
+            } else if constexpr(std::is_same<Type, char>::value) {
+                buf.append(t);
+            } else if constexpr(std::is_same<Type, int128_t>::value ||
+                                std::is_same<Type, uint128_t>::value) {
+                if constexpr(std::is_same<Type, int128_t>::value) {
+                    buf.appendSigned(t);
+                } else {
+                    buf.appendUnsigned(t);
+                }
+            } else if constexpr(std::is_integral<Type>::value) {
+                if constexpr(std::is_signed<Type>::value) {
+                    buf.appendSigned(int64_t(t));
+                } else {
+                    buf.appendUnsigned(uint64_t(t));
+                }
+            } else if constexpr(std::is_same<Type, std::string>::value) {
+                buf.append(t.c_str(), t.size());
+            } else if constexpr(std::is_same<Type, char*>::value ||
+                                std::is_same<Type, const char*>::value) {
+                buf.append(t);
+            } else if constexpr(IsFixedUnsigned<Type>::value ||
+                                std::is_same<Type, uint256>::value) {
+                buf.appendUnsigned(t);
+            } else if constexpr(IsFixedHash<Type>::value) {
+                buf.appendHex(t.data(), t.size());
+            } else {
+                // Floating point formatting stays with the host so the output
+                // is unchanged; user types go through their own print().
+                buf.flush();
+                print(t);
+            }
+        }
+    }
+
     /**
     * Prints null terminated string
     *
@@ -116,7 +354,9 @@ namespace platon {
     * @param s null terminated string to be printed
     */
     inline void print_f( const char* s ) {
+#ifndef DISABLE_PRINT
         prints(s);
+#endif
     }
 
     /**
@@ -128,6 +368,9 @@ namespace platon {
     *  make it easy to print any native type. You can even overload
     *  the `print()` method for your own custom types.
     *
+    *  Integers, strings and hashes are formatted inside the contract and
+    *  a whole print()/println() call reaches the host as a single prints_l.
+    *
     *  **Example:**
     *  ```
     *     print( "hello world, this is a number: ", 5 );
@@ -160,15 +403,10 @@ namespace platon {
     */
     template <typename Arg, typename... Args>
     inline void print_f( const char* s, Arg val, Args... rest ) {
-        while ( *s != '\0' ) {
-            if ( *s == '%' ) {
-            print( val );
-            print_f( s+1, rest... );
-            return;
-            }
-            prints_l( s, 1 );
-            s++;
-        }
+#ifndef DISABLE_PRINT
+        detail::PrintBuffer buf;
+        detail::printfTo(buf, s, val, rest...);
+#endif
     }
 
     /**
@@ -190,15 +428,19 @@ namespace platon {
         */
     template<typename Arg, typename... Args>
     void print( Arg&& a, Args&&... args ) {
-        print(std::forward<Arg>(a));
-        print(' ');
-        print(std::forward<Args>(args)...);
+#ifndef DISABLE_PRINT
+        detail::PrintBuffer buf;
+        detail::printTo(buf, a, args...);
+#endif
     }
 
     template<typename Arg, typename... Args>
     void println( Arg&& a, Args&&... args ) {
-        print(std::forward<Arg>(a), std::forward<Args>(args)...);
-        print('\n');
+#ifndef DISABLE_PRINT
+        detail::PrintBuffer buf;
+        detail::printTo(buf, a, args...);
+        buf.append('\n');
+#endif
     }
 
     /**
@@ -7,6 +7,24 @@
 #define PLATON_REFLECT_MEMBER_OP( r, OP, elem ) \
   OP t.elem
 
+#define PLATON_REFLECT_MEMBER_CALL( r, F, elem ) \
+  F( t.elem );
+
+/**
+ * Visits the serialized members of TYPE in declaration order. Found by
+ * argument dependent lookup, it lets txEncode and txDecode handle the class
+ * as a list of its members.
+ */
+#define PLATON_REFLECT_FIELDS( TYPE, MEMBERS ) \
+ template<typename F> \
+ friend void platonForEachField( TYPE& t, F&& f ){ \
+    BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_CALL, f, MEMBERS ) \
+ } \
+ template<typename F> \
+ friend void platonForEachField( const TYPE& t, F&& f ){ \
+    BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_CALL, f, MEMBERS ) \
+ }
+
 /**
  * @defgroup serialize Serialize API
  * @brief Defines functions to serialize and deserialize object
@@ -36,7 +54,8 @@
  template<typename DS> \
  friend DS& operator >> ( DS& ds, TYPE& t ){ \
     return ds BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_OP, >>, MEMBERS );\
- }
+ }\
+ PLATON_REFLECT_FIELDS( TYPE, MEMBERS )
 
 /**
  *  Defines serialization and deserialization for a class which inherits from other classes that
@@ -59,5 +78,15 @@
  friend DS& operator >> ( DS& ds, TYPE& t ){ \
     ds >> static_cast<BASE&>(t); \
     return ds BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_OP, >>, MEMBERS );\
+ }\
+ template<typename F> \
+ friend void platonForEachField( TYPE& t, F&& f ){ \
+    platonForEachField( static_cast<BASE&>(t), f ); \
+    BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_CALL, f, MEMBERS ) \
+ } \
+ template<typename F> \
+ friend void platonForEachField( const TYPE& t, F&& f ){ \
+    platonForEachField( static_cast<const BASE&>(t), f ); \
+    BOOST_PP_SEQ_FOR_EACH( PLATON_REFLECT_MEMBER_CALL, f, MEMBERS ) \
  }
 ///@} serializecpp
@@ -5,6 +5,8 @@
 
 #include "common.h"
 #include "datastream.h"
+#include "exception.h"
+#include "trace.hpp"
 #include <string>
 
 #ifdef __cplusplus
@@ -19,6 +21,47 @@ extern "C" {
 
 
 namespace platon {
+    namespace detail {
+        inline bool &readOnlyMode() {
+            static bool readOnly = false;
+            return readOnly;
+        }
+    }
+
+    /**
+     * @brief Put the current call into read-only mode, used by the wrappers
+     * abigen generates for CONSTANT methods. setState, delState and the
+     * modifying operations of the storage containers abort the call.
+     * Values only reached through a non-const reference are not written
+     * back.
+     * 
+     */
+    inline void enterReadOnlyMode() {
+        detail::readOnlyMode() = true;
+    }
+
+    /**
+     * @brief Whether the current call is read-only
+     * 
+     * @return true Storage must not be written
+     */
+    inline bool isReadOnlyMode() {
+        return detail::readOnlyMode();
+    }
+
+    /**
+     * @brief Abort the call if it is read-only. Storage containers call this
+     * from modifying operations, whose writes would otherwise wait for the
+     * flush on destruction.
+     * 
+     * @param what Operation, for the message
+     */
+    inline void checkWritable(const char *what) {
+        if (isReadOnlyMode()) {
+            platonThrow(what, "in read-only call");
+        }
+    }
+
     /**
      * @brief Set the State object
      * 
@@ -29,12 +72,14 @@ namespace platon {
      */
     template <typename KEY, typename VALUE>
     inline void setState(const KEY &key, const VALUE &value) {
+        checkWritable("setState");
         std::vector<char> vecKey(pack_size(key));
         std::vector<char> vecValue(pack_size(value));
         DataStream<char*> keyStream(vecKey.data(), vecKey.size());
         DataStream<char*> valueStream(vecValue.data(), vecValue.size());
         keyStream << key;
         valueStream << value;
+        PLATON_TRACE_OP(kSetState, vecKey.size() + vecValue.size());
         ::setState((const byte*)vecKey.data(), vecKey.size(),  (const byte*)vecValue.data(), vecValue.size());
     }
     /**
@@ -52,6 +97,7 @@ namespace platon {
         DataStream<char*> keyStream(vecKey.data(), vecKey.size());
         keyStream << key;
         size_t len = ::getStateSize((const byte*)vecKey.data(), vecKey.size());
+        PLATON_TRACE_OP(kGetState, vecKey.size() + len);
         if (len == 0){ return 0; }
         std::vector<char> vecValue(len);
         ::getState((const byte*)vecKey.data(), vecKey.size(), (byte*)vecValue.data(), vecValue.size());
@@ -69,10 +115,12 @@ namespace platon {
      */
     template <typename KEY>
     inline void delState(const KEY &key) {
+        checkWritable("delState");
         byte del = 0;
         std::vector<char> vecKey(pack_size(key));
         DataStream<char*> keyStream(vecKey.data(), vecKey.size());
         keyStream << key;
+        PLATON_TRACE_OP(kDelState, vecKey.size());
         ::setState((const byte*)vecKey.data(), vecKey.size(),  (const byte*)&del, 0);
     }
 
@@ -21,31 +21,31 @@ namespace platon {
      * 
      * @tparam *Name Element value name, in the same contract, the name needs to be unique
      * @tparam T Element type
+     * @tparam LazyDefault Persist the default only once the value is
+     * modified, instead of whenever the chain has no entry for it yet
      */
-    template <const char *Name, typename T>
+    template <const char *Name, typename T, bool LazyDefault = false>
     class StorageType {
     public:
         /**
          * @brief Construct a new Storage Type object
          * 
          */
-        StorageType() {
-            init();
-        }
+        StorageType() {}
 
         /**
-         * @brief Construct a new Storage Type object
+         * @brief Construct a new Storage Type object. The default is what the
+         * value reads as while the chain has no entry for it. The destructor
+         * persists it, or with LazyDefault only a modified value does.
          * 
          * @param d Element
          */
-        StorageType(const T& d):default_(d) {
-            init();
-        }
+        StorageType(const T& d):default_(d) {}
 
-        StorageType(const StorageType<Name, T>  &) = delete;
-        StorageType(const StorageType<Name, T> &&) = delete;
+        StorageType(const StorageType &) = delete;
+        StorageType(const StorageType &&) = delete;
         /**
-         * @brief Destroy the Storage Type object. Refresh to blockchain
+         * @brief Destroy the Storage Type object. Refresh to blockchain if it was modified
          * 
          */
         ~StorageType() {
@@ -54,73 +54,124 @@ namespace platon {
 
 
 
-        T& operator=(const T& t) { t_ = t; }
+        T& operator=(const T& t) { return modify() = t; }
 
         template<typename P>
-        bool operator==(const P &t) const { return t_ == t; }
+        bool operator==(const P &t) const { return value() == t; }
         template<typename P>
-        bool operator!=(const P &t) const { return t_ == t; }
+        bool operator!=(const P &t) const { return value() != t; }
         template<typename P>
-        bool operator<(const P &t) const { return t_ < t; }
+        bool operator<(const P &t) const { return value() < t; }
         template<typename P>
-        bool operator>=(const P &t) const { return t_ >= t; }
+        bool operator>=(const P &t) const { return value() >= t; }
         template<typename P>
-        bool operator<=(const P &t) const { return t_ <= t; }
+        bool operator<=(const P &t) const { return value() <= t; }
         template<typename P>
-        bool operator>(const P &t) const { return t_ > t; }
+        bool operator>(const P &t) const { return value() > t; }
 
         template<typename P>
-        T& operator^=(const P &t) const { t_ ^= t; return t_; }
+        T& operator^=(const P &t) { return modify() ^= t; }
         template<typename P>
-        T operator^(const P &t) const { return t_ ^ t; }
+        T operator^(const P &t) const { return value() ^ t; }
         template<typename P>
-        T& operator|=(const P &t) const { t_ |= t; return t_; }
+        T& operator|=(const P &t) { return modify() |= t; }
         template<typename P>
-        T operator|(const P &t) const { return t_ | t; }
+        T operator|(const P &t) const { return value() | t; }
         template<typename P>
-        T& operator&=(const P &t) const { t_ &= t; return  t_; }
+        T& operator&=(const P &t) { return modify() &= t; }
         template<typename P>
-        T operator&(const P &t) const { return t_ & t; }
+        T operator&(const P &t) const { return value() & t; }
 
-        T operator~() const { return ~t_; }
+        T operator~() const { return ~value(); }
 
-        T& operator<<(int offset) { t_ << offset; return t_; }
-        T& operator>>(int offset) { t_ >> offset; return t_; }
+        // Not const, or the stream operator<< template in datastream.h is the
+        // better match for a non-const object. get() keeps them reads.
+        T operator<<(int offset) { return get() << offset; }
+        T operator>>(int offset) { return get() >> offset; }
+        T& operator<<=(int offset) { return modify() <<= offset; }
+        T& operator>>=(int offset) { return modify() >>= offset; }
 
-        T& operator++() { return ++t_; }
-        T operator++(int) { return ++t_;  }
+        T& operator++() { return ++modify(); }
+        T operator++(int) { return modify()++; }
 
-        T& operator[](int i) { return t_[i]; }
+        T& operator[](int i) { return value()[i]; }
         template<typename P>
-        T& operator+=(const P &p) { t_ += p; return t_; }
+        T& operator+=(const P &p) { return modify() += p; }
         template<typename P>
-        T& operator-=(const P &p) { t_ -= p; return t_; }
-        T& operator*() { return t_; }
-        T* operator->() { return &t_; }
+        T& operator-=(const P &p) { return modify() -= p; }
+        T& operator*() { return value(); }
+        const T& operator*() const { return value(); }
+        T* operator->() { return &value(); }
+        const T* operator->() const { return &value(); }
 
-        operator bool() const { return t_ ? true : false; }
+        operator bool() const { return value() ? true : false; }
 
-        T get() const { return t_; }
+        T get() const { return value(); }
     private:
         /**
-         * @brief Load from blockchain
+         * @brief Load from blockchain on first use
          * 
          */
-        void init() {
-            if (getState(name_, t_) == 0) {
-                t_ = default_;
+        const T& value() const {
+            PLATON_TRACE_CONTAINER(Name);
+            if (!loaded_) {
+                stored_ = getState(name_, t_) != 0;
+                if (!stored_) {
+                    t_ = default_;
+                }
+                loaded_ = true;
             }
+            return t_;
         }
+
+        /**
+         * @brief Value for modification, written back by flush
+         * 
+         */
+        T& value() {
+            static_cast<const StorageType *>(this)->value();
+            dirty_ = true;
+            return t_;
+        }
+
         /**
-         * @brief Refresh to blockchain
+         * @brief Value for an assignment or compound assignment, which aborts
+         * a read-only call
+         * 
+         */
+        T& modify() {
+            checkWritable("StorageType write");
+            return value();
+        }
+
+        /**
+         * @brief Refresh to blockchain: a modified value, and unless
+         * LazyDefault a default the chain has no entry for. A value read from
+         * the chain and never accessed through a non-const operation is not
+         * rewritten. In a read-only call nothing is written; the only
+         * non-const accesses left there are references from operator*,
+         * operator-> and operator[], which are treated as reads.
          * 
          */
         void flush() {
-            setState(name_, t_);
+            PLATON_TRACE_CONTAINER(Name);
+            if (isReadOnlyMode()) {
+                return;
+            }
+            if (!LazyDefault) {
+                static_cast<const StorageType *>(this)->value();
+            }
+            if (dirty_ || (!LazyDefault && !stored_)) {
+                setState(name_, t_);
+            }
         }
         T default_;
         const std::string name_ = Name;
-        T t_;
+        mutable T t_;
+        mutable bool loaded_ = false;
+        // Whether the chain had an entry when the value was loaded.
+        mutable bool stored_ = false;
+        bool dirty_ = false;
     };
 
     template <const char *name>
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/**
+ * @brief State I/O tracing, compiled in with -DPLATON_TRACE
+ *
+ * Every setState, getState, delState, emitEvent and DeployedContract call is
+ * recorded with the ABI method being executed and the storage container
+ * (its Name template parameter) doing the I/O, and handed to the host
+ * through the platonTrace import. libplaton-host-native and platon-run
+ * collect the records and platon-trace folds them into stacks.
+ *
+ * The chain has no platonTrace import, so a traced contract only runs in
+ * those hosts. Without PLATON_TRACE every hook compiles to nothing.
+ *
+ * A trace is a sequence of little-endian records:
+ *   name:      u8 kName, u16 id, u16 length, length bytes
+ *   operation: u8 op, u16 method id, u16 container id, u32 bytes
+ * Id 0 is "none"; a name record precedes the first use of its id.
+ */
+namespace platon {
+namespace trace {
+
+    /**
+     * @brief Record kinds
+     *
+     */
+    enum Op : uint8_t {
+        kName = 0,
+        kSetState = 1,
+        kGetState = 2,
+        kDelState = 3,
+        kEvent = 4,
+        kCall = 5,
+    };
+
+}  // namespace trace
+}  // namespace platon
+
+#ifdef PLATON_TRACE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void platonTrace(const uint8_t *data, size_t len);
+#ifdef __cplusplus
+}
+#endif
+
+namespace platon {
+namespace trace {
+namespace detail {
+
+    inline const char *&method() {
+        static const char *name = nullptr;
+        return name;
+    }
+
+    inline const char *&container() {
+        static const char *name = nullptr;
+        return name;
+    }
+
+    inline void put(uint8_t *&p, uint32_t v, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            *p++ = uint8_t(v >> (8 * i));
+        }
+    }
+
+    /**
+     * @brief Id of a name, announcing it to the host on first use. Names are
+     * string literals, so they are told apart by address.
+     *
+     */
+    inline uint16_t intern(const char *name) {
+        static std::vector<const char *> names;
+        if (name == nullptr) {
+            return 0;
+        }
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) {
+                return uint16_t(i + 1);
+            }
+        }
+        names.push_back(name);
+        uint16_t id = uint16_t(names.size());
+        size_t len = strlen(name);
+        std::vector<uint8_t> record(5 + len);
+        uint8_t *p = record.data();
+        put(p, kName, 1);
+        put(p, id, 2);
+        put(p, uint32_t(len), 2);
+        memcpy(p, name, len);
+        ::platonTrace(record.data(), record.size());
+        return id;
+    }
+
+}  // namespace detail
+
+    /**
+     * @brief Record an operation that moved bytes of keys and values
+     *
+     */
+    inline void record(Op op, size_t bytes) {
+        uint16_t method = detail::intern(detail::method());
+        uint16_t container = detail::intern(detail::container());
+        uint8_t record[9];
+        uint8_t *p = record;
+        detail::put(p, op, 1);
+        detail::put(p, method, 2);
+        detail::put(p, container, 2);
+        detail::put(p, uint32_t(bytes), 4);
+        ::platonTrace(record, sizeof(record));
+    }
+
+    /**
+     * @brief Attribute the rest of the call, container flushes on return
+     * included, to an ABI method
+     *
+     */
+    inline void enterMethod(const char *name) {
+        detail::method() = name;
+    }
+
+    /**
+     * @brief Attribute the operations in its scope to a container
+     *
+     */
+    class ContainerScope {
+    public:
+        explicit ContainerScope(const char *name) : outer_(detail::container()) {
+            detail::container() = name;
+        }
+        ~ContainerScope() { detail::container() = outer_; }
+
+        ContainerScope(const ContainerScope &) = delete;
+        ContainerScope &operator=(const ContainerScope &) = delete;
+
+    private:
+        const char *outer_;
+    };
+
+}  // namespace trace
+}  // namespace platon
+
+#define PLATON_TRACE_METHOD(NAME) ::platon::trace::enterMethod(NAME)
+#define PLATON_TRACE_CONTAINER(NAME) \
+    ::platon::trace::ContainerScope platon_trace_container_(NAME)
+#define PLATON_TRACE_OP(OP, BYTES) ::platon::trace::record(::platon::trace::OP, BYTES)
+
+#else
+
+#define PLATON_TRACE_METHOD(NAME) ((void)0)
+#define PLATON_TRACE_CONTAINER(NAME) ((void)0)
+#define PLATON_TRACE_OP(OP, BYTES) ((void)0)
+
+#endif
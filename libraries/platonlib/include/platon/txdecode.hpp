@@ -0,0 +1,230 @@
+#pragma once
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "RLP.h"
+#include "txencode.hpp"
+
+/**
+ * @brief Transaction decoding operation, the inverse of txEncode
+ * 
+ */
+namespace platon {
+
+    namespace detail {
+        // Unsigned integer holding the bytes txEncode writes for T.
+        template<typename T, bool = std::is_floating_point<T>::value>
+        struct TxBits { typedef typename std::make_unsigned<T>::type type; };
+
+        template<typename T>
+        struct TxBits<T, true> { typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type type; };
+
+        // Lists of encoded elements; a vector of bytes is a byte string instead.
+        template<typename T> struct IsList : std::false_type {};
+        template<typename T, typename A> struct IsList<std::vector<T, A>> : std::integral_constant<bool, !std::is_same<T, byte>::value> {};
+
+        template<typename T> struct IsMap : std::false_type {};
+        template<typename K, typename V, typename C, typename A> struct IsMap<std::map<K, V, C, A>> : std::true_type {};
+
+        // Fixed-width boost integers such as u160 and u256.
+        template<typename T> struct BigUint : std::false_type {};
+        template<unsigned Bits> struct BigUint<boost::multiprecision::number<boost::multiprecision::cpp_int_backend<Bits, Bits,
+                boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>>> : std::true_type {};
+    }
+
+    /**
+     * @brief Decode an integer written by txEncode as a big-endian byte string.
+     * Shorter items are zero extended, longer ones are rejected.
+     * 
+     * @tparam T Integer type
+     * @param rlp RLP data item
+     * @return T Decoded value
+     */
+    template<typename T>
+    inline typename std::enable_if<std::is_integral<T>::value, T>::type txDecode(const RLP &rlp) {
+        typedef typename std::make_unsigned<T>::type U;
+        bytesConstRef data = rlp.toBytesConstRef(RLP::ThrowOnFail);
+        if (data.size() > sizeof(T)) {
+            platonThrow("bad cast");
+        }
+        U v = 0;
+        for (size_t i = 0; i < data.size(); i++) {
+            v = U(v << 8) | data[i];
+        }
+        return T(v);
+    }
+
+    /**
+     * @brief Decode a floating point value from the big-endian bytes of its
+     * IEEE 754 representation.
+     * 
+     * @tparam T float or double
+     * @param rlp RLP data item
+     * @return T Decoded value
+     */
+    template<typename T>
+    inline typename std::enable_if<std::is_floating_point<T>::value, T>::type txDecode(const RLP &rlp) {
+        typedef typename detail::TxBits<T>::type Bits;
+        Bits bits = txDecode<Bits>(rlp);
+        T v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    /**
+     * @brief Decode a byte string
+     * 
+     * @tparam T std::string
+     * @param rlp RLP data item
+     * @return T Decoded string
+     */
+    template<typename T>
+    inline typename std::enable_if<std::is_same<T, std::string>::value, T>::type txDecode(const RLP &rlp) {
+        return rlp.toString(RLP::ThrowOnFail);
+    }
+
+    /**
+     * @brief Decode a byte string
+     * 
+     * @tparam T bytes
+     * @param rlp RLP data item
+     * @return T Decoded bytes
+     */
+    template<typename T>
+    inline typename std::enable_if<std::is_same<T, bytes>::value, T>::type txDecode(const RLP &rlp) {
+        return rlp.toBytes(RLP::ThrowOnFail);
+    }
+
+    /**
+     * @brief Decode a uint256 from at most 32 big-endian bytes
+     * 
+     * @tparam T uint256
+     * @param rlp RLP data item
+     * @return T Decoded value
+     */
+    template<typename T>
+    inline typename std::enable_if<std::is_same<T, uint256>::value, T>::type txDecode(const RLP &rlp) {
+        bytesConstRef data = rlp.toBytesConstRef(RLP::ThrowOnFail);
+        if (data.size() > 32) {
+            platonThrow("bad cast");
+        }
+        return uint256::fromBigEndian(data.data(), data.size());
+    }
+
+    /**
+     * @brief Decode a fixed-width boost integer such as u256 from big-endian bytes
+     * 
+     * @tparam T u160, u256, ...
+     * @param rlp RLP data item
+     * @return T Decoded value
+     */
+    template<typename T>
+    inline typename std::enable_if<detail::BigUint<T>::value, T>::type txDecode(const RLP &rlp) {
+        bytesConstRef data = rlp.toBytesConstRef(RLP::ThrowOnFail);
+        if (data.size() * 8 > std::numeric_limits<T>::digits) {
+            platonThrow("bad cast");
+        }
+        return fromBigEndian<T>(data);
+    }
+
+    /**
+     * @brief Decode a hash, which must have exactly its size in bytes
+     * 
+     * @tparam T FixedHash type
+     * @param rlp RLP data item
+     * @return T Decoded hash
+     */
+    template<typename T>
+    inline typename std::enable_if<detail::IsFixedHash<T>::value, T>::type txDecode(const RLP &rlp) {
+        bytesConstRef data = rlp.toBytesConstRef(RLP::ThrowOnFail);
+        T h;
+        if (data.size() != h.size()) {
+            platonThrow("bad cast");
+        }
+        memcpy(h.data(), data.data(), data.size());
+        return h;
+    }
+
+    template<typename T>
+    typename std::enable_if<detail::IsList<T>::value, T>::type txDecode(const RLP &rlp);
+
+    template<typename T>
+    typename std::enable_if<detail::IsMap<T>::value, T>::type txDecode(const RLP &rlp);
+
+    template<typename T>
+    typename std::enable_if<detail::HasFields<T>::value, T>::type txDecode(const RLP &rlp);
+
+    /**
+     * @brief Decode a vector from the list of its elements
+     * 
+     * @tparam T std::vector type
+     * @param rlp RLP list
+     * @return T Decoded vector
+     */
+    template<typename T>
+    typename std::enable_if<detail::IsList<T>::value, T>::type txDecode(const RLP &rlp) {
+        if (!rlp.isList()) {
+            platonThrow("bad cast");
+        }
+        T v;
+        v.reserve(rlp.itemCount());
+        for (const RLP &item : rlp) {
+            v.push_back(txDecode<typename T::value_type>(item));
+        }
+        return v;
+    }
+
+    /**
+     * @brief Decode a map from a list of [key, value] lists
+     * 
+     * @tparam T std::map type
+     * @param rlp RLP list
+     * @return T Decoded map
+     */
+    template<typename T>
+    typename std::enable_if<detail::IsMap<T>::value, T>::type txDecode(const RLP &rlp) {
+        if (!rlp.isList()) {
+            platonThrow("bad cast");
+        }
+        T m;
+        for (const RLP &item : rlp) {
+            if (!item.isList() || item.itemCount() != 2) {
+                platonThrow("bad cast");
+            }
+            m.emplace(txDecode<typename T::key_type>(item[0]), txDecode<typename T::mapped_type>(item[1]));
+        }
+        return m;
+    }
+
+    /**
+     * @brief Decode a class declared with PLATON_SERIALIZE from the list of
+     * its members
+     * 
+     * @tparam T Class type
+     * @param rlp RLP list
+     * @return T Decoded value
+     */
+    template<typename T>
+    typename std::enable_if<detail::HasFields<T>::value, T>::type txDecode(const RLP &rlp) {
+        if (!rlp.isList()) {
+            platonThrow("bad cast");
+        }
+        T v;
+        RLP::iterator it = rlp.begin();
+        RLP::iterator end = rlp.end();
+        platonForEachField(v, [&](auto &field) {
+            if (it == end) {
+                platonThrow("bad cast");
+            }
+            field = txDecode<typename std::decay<decltype(field)>::type>(*it);
+            ++it;
+        });
+        if (it != end) {
+            platonThrow("bad cast");
+        }
+        return v;
+    }
+}
@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <map>
+#include <vector>
 #include <boost/endian/conversion.hpp>
 #include "RLP.h"
+#include "uint256.hpp"
 /**
  * @brief Transaction coding operation
  * 
@@ -77,8 +80,10 @@ namespace platon {
         stream.append(ref);
     }
 
+#ifndef PLATON_NATIVE
     /**
-     * @brief Specified type encoding
+     * @brief Specified type encoding. int32_t is long on wasm32; native
+     * targets define it as int, which the int32_t overload covers.
      * 
      * @param stream RLP stream
      * @param d int type
@@ -89,6 +94,7 @@ namespace platon {
         bytesConstRef ref((byte*)&d, sizeof(d));
         stream.append(ref);
     }
+#endif
 
     /**
      * @brief Specified type encoding
@@ -136,6 +142,134 @@ namespace platon {
         stream.append(std::string(d));
     }
 
+    /**
+     * @brief Specified type encoding
+     * 
+     * @param stream RLP stream
+     * @param d bytes type
+     */
+    inline void txEncode(RLPStream &stream, const bytes &d){
+        stream.append(d);
+    }
+
+    /**
+     * @brief Specified type encoding, 32 big-endian bytes
+     * 
+     * @param stream RLP stream
+     * @param d uint256 type
+     */
+    inline void txEncode(RLPStream &stream, const uint256 &d){
+        byte out[32];
+        d.toBigEndian(out);
+        stream.append(bytesConstRef(out, sizeof(out)));
+    }
+
+    /**
+     * @brief Specified type encoding, Bits / 8 big-endian bytes
+     * 
+     * @tparam Bits Integer width
+     * @param stream RLP stream
+     * @param d u160, u256 and the other fixed-width boost integers
+     */
+    template<unsigned Bits>
+    void txEncode(RLPStream &stream, const boost::multiprecision::number<boost::multiprecision::cpp_int_backend<Bits, Bits,
+            boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>> &d);
+
+    /**
+     * @brief Specified type encoding, the N bytes of the hash
+     * 
+     * @tparam N Hash size
+     * @param stream RLP stream
+     * @param d FixedHash type
+     */
+    template<unsigned N>
+    void txEncode(RLPStream &stream, const FixedHash<N> &d);
+
+    /**
+     * @brief Specified type encoding, a list of the encoded elements
+     * 
+     * @tparam T Element type
+     * @param stream RLP stream
+     * @param d std::vector type
+     */
+    template<typename T, typename A>
+    void txEncode(RLPStream &stream, const std::vector<T, A> &d);
+
+    /**
+     * @brief Specified type encoding, a list of [key, value] lists
+     * 
+     * @tparam K Key type
+     * @tparam V Value type
+     * @param stream RLP stream
+     * @param d std::map type
+     */
+    template<typename K, typename V, typename C, typename A>
+    void txEncode(RLPStream &stream, const std::map<K, V, C, A> &d);
+
+    namespace detail {
+        // Accepts any field, used to detect platonForEachField.
+        struct AnyField {
+            template<typename T> void operator()(const T &) const {}
+        };
+
+        // Whether T declares its members with PLATON_SERIALIZE.
+        template<typename T, typename = void>
+        struct HasFields : std::false_type {};
+
+        template<typename T>
+        struct HasFields<T, decltype(platonForEachField(std::declval<const T &>(), AnyField()))> : std::true_type {};
+    }
+
+    /**
+     * @brief Specified type encoding, a list of the members declared with
+     * PLATON_SERIALIZE
+     * 
+     * @tparam T Class type
+     * @param stream RLP stream
+     * @param d Value
+     */
+    template<typename T>
+    typename std::enable_if<detail::HasFields<T>::value>::type txEncode(RLPStream &stream, const T &d);
+
+    template<unsigned Bits>
+    void txEncode(RLPStream &stream, const boost::multiprecision::number<boost::multiprecision::cpp_int_backend<Bits, Bits,
+            boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>> &d) {
+        std::array<byte, Bits / 8> out;
+        toBigEndian(d, out);
+        stream.append(bytesConstRef(out.data(), out.size()));
+    }
+
+    template<unsigned N>
+    void txEncode(RLPStream &stream, const FixedHash<N> &d) {
+        stream.append(bytesConstRef(d.data(), N));
+    }
+
+    template<typename T, typename A>
+    void txEncode(RLPStream &stream, const std::vector<T, A> &d) {
+        stream.appendList(d.size());
+        for (const T &e : d) {
+            txEncode(stream, e);
+        }
+    }
+
+    template<typename K, typename V, typename C, typename A>
+    void txEncode(RLPStream &stream, const std::map<K, V, C, A> &d) {
+        stream.appendList(d.size());
+        for (const auto &e : d) {
+            stream.appendList(2);
+            txEncode(stream, e.first);
+            txEncode(stream, e.second);
+        }
+    }
+
+    template<typename T>
+    typename std::enable_if<detail::HasFields<T>::value>::type txEncode(RLPStream &stream, const T &d) {
+        size_t count = 0;
+        platonForEachField(d, [&count](const auto &) { ++count; });
+        stream.appendList(count);
+        platonForEachField(d, [&stream](const auto &field) { txEncode(stream, field); });
+    }
+
     /**
      * @brief Empty implementation
      * 
@@ -150,14 +284,16 @@ namespace platon {
      * @brief Serialize to RLPStream
      * 
      * @tparam Arg Starting element type
+     * @tparam Next Second element type
      * @tparam Args Variable parameter type
      * @param stream RLP stream
      * @param a Starting parameter
+     * @param next Second parameter
      * @param args Variable parameter
      */
-    template<typename Arg, typename... Args>
-    void txEncode(RLPStream &stream, Arg&& a, Args&&... args ) {
+    template<typename Arg, typename Next, typename... Args>
+    void txEncode(RLPStream &stream, Arg&& a, Next&& next, Args&&... args ) {
         txEncode(stream, a);
-        txEncode(stream, args...);
+        txEncode(stream, next, args...);
     }
 }
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <type_traits>
+#include "common.h"
+
+namespace platon {
+    /**
+     * @brief A 256-bit unsigned integer stored as four 64-bit limbs.
+     *
+     * Arithmetic wraps modulo 2^256 like the unchecked u256, use addOverflow,
+     * subOverflow and mulOverflow where overflow has to be detected. None of
+     * the operations go through the 128-bit compiler builtins.
+     */
+    class uint256 {
+    public:
+        static constexpr unsigned kLimbs = 4;
+        static constexpr unsigned kBits = 256;
+
+        /**
+         * @brief Construct a zero value.
+         */
+        constexpr uint256() : limbs_{0, 0, 0, 0} {}
+
+        /**
+         * @brief Construct from a 64-bit unsigned integer.
+         * @param v Value.
+         */
+        constexpr uint256(uint64_t v) : limbs_{v, 0, 0, 0} {}
+
+        /**
+         * @brief Construct from four limbs, most significant first.
+         */
+        constexpr uint256(uint64_t w3, uint64_t w2, uint64_t w1, uint64_t w0) : limbs_{w0, w1, w2, w3} {}
+
+        /**
+         * @brief Construct from a boost u256.
+         * @param v Value.
+         */
+        explicit uint256(const u256 &v) : limbs_{0, 0, 0, 0} {
+            detail::toLimbs(v, limbs_, kLimbs);
+        }
+
+        /**
+         * @brief Convert to a boost u256.
+         */
+        u256 toU256() const {
+            u256 ret;
+            detail::fromLimbs(limbs_, kLimbs, ret);
+            return ret;
+        }
+
+        explicit operator u256() const { return toU256(); }
+
+        /**
+         * @brief Largest representable value.
+         */
+        static constexpr uint256 max() { return uint256(~uint64_t(0), ~uint64_t(0), ~uint64_t(0), ~uint64_t(0)); }
+
+        /**
+         * @brief Get a limb, 0 is the least significant.
+         */
+        constexpr uint64_t limb(unsigned i) const { return limbs_[i]; }
+
+        constexpr bool isZero() const { return (limbs_[0] | limbs_[1] | limbs_[2] | limbs_[3]) == 0; }
+        explicit constexpr operator bool() const { return !isZero(); }
+        explicit constexpr operator uint64_t() const { return limbs_[0]; }
+
+        /**
+         * @brief Number of significant bits, 0 for zero.
+         */
+        constexpr unsigned bits() const {
+            for (unsigned i = kLimbs; i > 0; --i) {
+                if (limbs_[i - 1] != 0) {
+                    return i * 64 - detail::clz64(limbs_[i - 1]);
+                }
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Add with overflow detection.
+         * @param a   First addend.
+         * @param b   Second addend.
+         * @param res Receives a + b modulo 2^256.
+         * @return true if the sum does not fit in 256 bits.
+         */
+        static constexpr bool addOverflow(const uint256 &a, const uint256 &b, uint256 &res) {
+            uint64_t carry = 0;
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                uint64_t s = a.limbs_[i] + b.limbs_[i];
+                uint64_t c1 = s < a.limbs_[i];
+                res.limbs_[i] = s + carry;
+                carry = c1 | (res.limbs_[i] < s);
+            }
+            return carry != 0;
+        }
+
+        /**
+         * @brief Subtract with underflow detection.
+         * @param a   Minuend.
+         * @param b   Subtrahend.
+         * @param res Receives a - b modulo 2^256.
+         * @return true if b is greater than a.
+         */
+        static constexpr bool subOverflow(const uint256 &a, const uint256 &b, uint256 &res) {
+            uint64_t borrow = 0;
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                uint64_t d = a.limbs_[i] - b.limbs_[i];
+                uint64_t b1 = a.limbs_[i] < b.limbs_[i];
+                res.limbs_[i] = d - borrow;
+                borrow = b1 | (d < borrow);
+            }
+            return borrow != 0;
+        }
+
+        /**
+         * @brief Multiply with overflow detection.
+         * @param a   First factor.
+         * @param b   Second factor.
+         * @param res Receives a * b modulo 2^256.
+         * @return true if the product does not fit in 256 bits.
+         */
+        static constexpr bool mulOverflow(const uint256 &a, const uint256 &b, uint256 &res) {
+            uint64_t r[2 * kLimbs] = {0, 0, 0, 0, 0, 0, 0, 0};
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                if (a.limbs_[i] == 0) continue;
+                uint64_t carry = 0;
+                for (unsigned j = 0; j < kLimbs; ++j) {
+                    uint64_t hi = 0;
+                    uint64_t lo = detail::mulu64(a.limbs_[i], b.limbs_[j], hi);
+                    lo += carry;
+                    hi += lo < carry;
+                    r[i + j] += lo;
+                    hi += r[i + j] < lo;
+                    carry = hi;
+                }
+                r[i + kLimbs] = carry;
+            }
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                res.limbs_[i] = r[i];
+            }
+            return (r[4] | r[5] | r[6] | r[7]) != 0;
+        }
+
+        /**
+         * @brief Divide by a 64-bit divisor, the fast path for small constants
+         * such as 10, 10^9 or 10^18.
+         * @param d   Divisor, must not be zero.
+         * @param rem Receives the remainder.
+         * @return The quotient.
+         */
+        constexpr uint256 divMod(uint64_t d, uint64_t &rem) const {
+            if (d == 0) abort();
+            uint256 q;
+            uint64_t r = 0;
+            for (unsigned i = kLimbs; i > 0; --i) {
+                q.limbs_[i - 1] = detail::divu128(r, limbs_[i - 1], d, r);
+            }
+            rem = r;
+            return q;
+        }
+
+        /**
+         * @brief Divide by an arbitrary divisor.
+         * @param d   Divisor, must not be zero.
+         * @param rem Receives the remainder.
+         * @return The quotient.
+         */
+        constexpr uint256 divMod(const uint256 &d, uint256 &rem) const {
+            if ((d.limbs_[1] | d.limbs_[2] | d.limbs_[3]) == 0) {
+                uint64_t r = 0;
+                uint256 q = divMod(d.limbs_[0], r);
+                rem = uint256(r);
+                return q;
+            }
+            uint256 q;
+            rem = *this;
+            if (*this < d) {
+                return q;
+            }
+            unsigned shift = bits() - d.bits();
+            uint256 divisor = d << shift;
+            for (unsigned i = shift + 1; i > 0; --i) {
+                if (!(rem < divisor)) {
+                    subOverflow(rem, divisor, rem);
+                    q.limbs_[(i - 1) / 64] |= uint64_t(1) << ((i - 1) % 64);
+                }
+                divisor >>= 1;
+            }
+            return q;
+        }
+
+        constexpr uint256 &operator+=(const uint256 &o) { addOverflow(*this, o, *this); return *this; }
+        constexpr uint256 &operator-=(const uint256 &o) { subOverflow(*this, o, *this); return *this; }
+
+        constexpr uint256 &operator*=(const uint256 &o) {
+            uint256 r;
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                uint64_t carry = 0;
+                for (unsigned j = 0; i + j < kLimbs; ++j) {
+                    uint64_t hi = 0;
+                    uint64_t lo = detail::mulu64(limbs_[i], o.limbs_[j], hi);
+                    lo += carry;
+                    hi += lo < carry;
+                    r.limbs_[i + j] += lo;
+                    hi += r.limbs_[i + j] < lo;
+                    carry = hi;
+                }
+            }
+            *this = r;
+            return *this;
+        }
+
+        constexpr uint256 &operator/=(const uint256 &o) { uint256 r; *this = divMod(o, r); return *this; }
+        constexpr uint256 &operator%=(const uint256 &o) { divMod(o, *this); return *this; }
+
+        constexpr uint256 &operator&=(const uint256 &o) { for (unsigned i = 0; i < kLimbs; ++i) limbs_[i] &= o.limbs_[i]; return *this; }
+        constexpr uint256 &operator|=(const uint256 &o) { for (unsigned i = 0; i < kLimbs; ++i) limbs_[i] |= o.limbs_[i]; return *this; }
+        constexpr uint256 &operator^=(const uint256 &o) { for (unsigned i = 0; i < kLimbs; ++i) limbs_[i] ^= o.limbs_[i]; return *this; }
+
+        constexpr uint256 &operator<<=(unsigned n) {
+            if (n >= kBits) return *this = uint256();
+            unsigned limbShift = n / 64, bitShift = n % 64;
+            for (unsigned i = kLimbs; i > 0; --i) {
+                unsigned dst = i - 1;
+                uint64_t v = 0;
+                if (dst >= limbShift) {
+                    v = limbs_[dst - limbShift] << bitShift;
+                    if (bitShift != 0 && dst > limbShift) {
+                        v |= limbs_[dst - limbShift - 1] >> (64 - bitShift);
+                    }
+                }
+                limbs_[dst] = v;
+            }
+            return *this;
+        }
+
+        constexpr uint256 &operator>>=(unsigned n) {
+            if (n >= kBits) return *this = uint256();
+            unsigned limbShift = n / 64, bitShift = n % 64;
+            for (unsigned dst = 0; dst < kLimbs; ++dst) {
+                uint64_t v = 0;
+                if (dst + limbShift < kLimbs) {
+                    v = limbs_[dst + limbShift] >> bitShift;
+                    if (bitShift != 0 && dst + limbShift + 1 < kLimbs) {
+                        v |= limbs_[dst + limbShift + 1] << (64 - bitShift);
+                    }
+                }
+                limbs_[dst] = v;
+            }
+            return *this;
+        }
+
+        constexpr uint256 &operator++() { return *this += uint256(1); }
+        constexpr uint256 &operator--() { return *this -= uint256(1); }
+        constexpr uint256 operator++(int) { uint256 t(*this); ++*this; return t; }
+        constexpr uint256 operator--(int) { uint256 t(*this); --*this; return t; }
+
+        constexpr uint256 operator~() const { return uint256(~limbs_[3], ~limbs_[2], ~limbs_[1], ~limbs_[0]); }
+
+        friend constexpr uint256 operator+(uint256 a, const uint256 &b) { return a += b; }
+        friend constexpr uint256 operator-(uint256 a, const uint256 &b) { return a -= b; }
+        friend constexpr uint256 operator*(uint256 a, const uint256 &b) { return a *= b; }
+        friend constexpr uint256 operator/(uint256 a, const uint256 &b) { return a /= b; }
+        friend constexpr uint256 operator%(uint256 a, const uint256 &b) { return a %= b; }
+        friend constexpr uint256 operator&(uint256 a, const uint256 &b) { return a &= b; }
+        friend constexpr uint256 operator|(uint256 a, const uint256 &b) { return a |= b; }
+        friend constexpr uint256 operator^(uint256 a, const uint256 &b) { return a ^= b; }
+        friend constexpr uint256 operator<<(uint256 a, unsigned n) { return a <<= n; }
+        friend constexpr uint256 operator>>(uint256 a, unsigned n) { return a >>= n; }
+
+        // The obvious comparison operators.
+        friend constexpr bool operator==(const uint256 &a, const uint256 &b) {
+            return ((a.limbs_[0] ^ b.limbs_[0]) | (a.limbs_[1] ^ b.limbs_[1]) |
+                    (a.limbs_[2] ^ b.limbs_[2]) | (a.limbs_[3] ^ b.limbs_[3])) == 0;
+        }
+        friend constexpr bool operator!=(const uint256 &a, const uint256 &b) { return !(a == b); }
+        friend constexpr bool operator<(const uint256 &a, const uint256 &b) {
+            uint256 r;
+            return subOverflow(a, b, r);
+        }
+        friend constexpr bool operator>(const uint256 &a, const uint256 &b) { return b < a; }
+        friend constexpr bool operator<=(const uint256 &a, const uint256 &b) { return !(b < a); }
+        friend constexpr bool operator>=(const uint256 &a, const uint256 &b) { return !(a < b); }
+
+        /**
+         * @brief Write the value as 32 big-endian bytes.
+         * @param out Destination, at least 32 bytes.
+         */
+        void toBigEndian(byte *out) const {
+            for (unsigned i = 0; i < kLimbs; ++i) {
+                uint64_t v = limbs_[kLimbs - 1 - i];
+                for (unsigned j = 0; j < 8; ++j) {
+                    out[i * 8 + j] = byte(v >> (56 - j * 8));
+                }
+            }
+        }
+
+        /**
+         * @brief Read a big-endian value of at most 32 bytes.
+         * @param data Source bytes.
+         * @param len  Length of data, extra leading bytes are ignored.
+         */
+        static uint256 fromBigEndian(const byte *data, size_t len) {
+            uint256 ret;
+            if (len > 32) {
+                data += len - 32;
+                len = 32;
+            }
+            for (size_t i = 0; i < len; ++i) {
+                size_t pos = len - 1 - i;
+                ret.limbs_[i / 8] |= uint64_t(data[pos]) << ((i % 8) * 8);
+            }
+            return ret;
+        }
+
+    private:
+        uint64_t limbs_[kLimbs];
+    };
+}
@@ -0,0 +1,474 @@
+// Microbenchmarks of the platon::db containers and StorageType against
+// libplaton-host-native.
+//
+// Every workload opens its container the way a contract call does, so each
+// iteration pays the init() reads and the flush() writes of one call. Next
+// to the CPU time, every benchmark reports per iteration:
+//
+//   host_calls     setState, getState and getStateSize imports
+//   bytes_read     value bytes getState copied out
+//   bytes_written  key and value bytes passed to setState
+//   allocs         operator new calls
+//
+// The counters are deterministic, so they can be diffed between builds:
+//   native/bench_containers --benchmark_out=new.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "platon/db/array.hpp"
+#include "platon/db/list.hpp"
+#include "platon/db/map.hpp"
+#include "platon/native/host.hpp"
+#include "platon/storagetype.hpp"
+
+namespace {
+uint64_t allocations = 0;
+
+// Every form of operator new allocates here and every operator delete frees
+// with std::free, so allocation and release always pair malloc with free.
+void* Allocate(size_t size) {
+  allocations++;
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+}  // namespace
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace platon::native;
+
+char kMapName[] = "bench_map";
+char kListName[] = "bench_list";
+char kArrayName[] = "bench_array";
+char kVectorName[] = "bench_vector";
+
+typedef platon::db::Map<kMapName, std::string, std::string> BenchMap;
+typedef platon::db::List<kListName, std::string> BenchList;
+const unsigned kArraySize = 4096;
+typedef platon::db::Array<kArrayName, uint64_t, kArraySize> BenchArray;
+typedef platon::StorageType<kVectorName, std::vector<uint64_t>> BenchVector;
+
+// Sums the host counters and allocations of the timed parts of a benchmark.
+class Meter {
+ public:
+  explicit Meter(benchmark::State& state) : state_(state) { Start(); }
+
+  ~Meter() {
+    auto avg = benchmark::Counter::kAvgIterations;
+    state_.counters["host_calls"] = benchmark::Counter(
+        double(stats_.set_state + stats_.get_state + stats_.get_state_size),
+        avg);
+    state_.counters["bytes_read"] =
+        benchmark::Counter(double(stats_.bytes_read), avg);
+    state_.counters["bytes_written"] =
+        benchmark::Counter(double(stats_.bytes_written), avg);
+    state_.counters["allocs"] = benchmark::Counter(double(allocs_), avg);
+  }
+
+  // Brackets untimed setup, so it is neither timed nor counted.
+  void Pause() {
+    Collect();
+    state_.PauseTiming();
+  }
+  void Resume() {
+    state_.ResumeTiming();
+    Start();
+  }
+
+  void Start() {
+    ResetStats();
+    start_allocs_ = allocations;
+  }
+
+  void Collect() {
+    const HostStats& stats = Stats();
+    stats_.set_state += stats.set_state;
+    stats_.get_state += stats.get_state;
+    stats_.get_state_size += stats.get_state_size;
+    stats_.bytes_read += stats.bytes_read;
+    stats_.bytes_written += stats.bytes_written;
+    allocs_ += allocations - start_allocs_;
+  }
+
+ private:
+  benchmark::State& state_;
+  HostStats stats_;
+  uint64_t allocs_ = 0;
+  uint64_t start_allocs_ = 0;
+};
+
+std::string Key(size_t i) { return "account-" + std::to_string(i); }
+
+// A value the size of an RLP encoded balance and nonce.
+std::string Value(size_t i) { return std::string(24, 'v') + std::to_string(i); }
+
+// Random indexes in [0, n), the same sequence on every run.
+std::vector<size_t> Shuffled(size_t n) {
+  std::vector<size_t> order(n);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  return order;
+}
+
+void FillMap(size_t n) {
+  BenchMap map;
+  for (size_t i = 0; i < n; i++) {
+    map.insert(Key(i), Value(i));
+  }
+}
+
+void FillList(size_t n) {
+  BenchList list;
+  for (size_t i = 0; i < n; i++) {
+    list.push(Value(i));
+  }
+}
+
+void FillArray(size_t n) {
+  BenchArray array;
+  for (size_t i = 0; i < n; i++) {
+    array[i] = i;
+  }
+}
+
+void Fresh() {
+  Reset();
+  SetEcho(false);
+}
+
+// db::Map
+
+void MapBulkInsert(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    meter.Resume();
+    FillMap(n);
+  }
+  meter.Collect();
+}
+
+void MapRandomRead(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Fresh();
+  FillMap(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchMap map;
+    for (size_t i : order) {
+      benchmark::DoNotOptimize(map.getConst(Key(i)));
+    }
+  }
+  meter.Collect();
+}
+
+// get() and operator[] put every key read into the write set, so a read
+// through them is written back on flush.
+void MapRandomReadCached(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Fresh();
+  FillMap(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchMap map;
+    for (size_t i : order) {
+      benchmark::DoNotOptimize(map[Key(i)]);
+    }
+  }
+  meter.Collect();
+}
+
+void MapIterate(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillMap(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchMap map;
+    // cbegin() does not load the key set itself; size() does.
+    benchmark::DoNotOptimize(map.size());
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+      benchmark::DoNotOptimize(it->second());
+    }
+  }
+  meter.Collect();
+}
+
+// Deletes half of the entries and inserts as many new ones, in one call.
+void MapChurn(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    FillMap(n);
+    meter.Resume();
+    BenchMap map;
+    for (size_t i = 0; i < n / 2; i++) {
+      map.del(Key(order[i]));
+      map.insert(Key(n + i), Value(n + i));
+    }
+  }
+  meter.Collect();
+}
+
+// The first access of a call after another call flushed the map.
+void MapReopen(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillMap(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchMap map;
+    benchmark::DoNotOptimize(map.getConst(Key(n / 2)));
+  }
+  meter.Collect();
+}
+
+// db::List
+
+void ListBulkInsert(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    meter.Resume();
+    FillList(n);
+  }
+  meter.Collect();
+}
+
+void ListRandomRead(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Fresh();
+  FillList(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchList list;
+    for (size_t i : order) {
+      benchmark::DoNotOptimize(list.getConst(i));
+    }
+  }
+  meter.Collect();
+}
+
+void ListIterate(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillList(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchList list;
+    for (auto it = list.cbegin(); it != list.cend(); ++it) {
+      benchmark::DoNotOptimize(*it);
+    }
+  }
+  meter.Collect();
+}
+
+// Deletes every other element by value, then appends as many.
+void ListChurn(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    FillList(n);
+    meter.Resume();
+    BenchList list;
+    for (size_t i = 0; i < n; i += 2) {
+      list.del(Value(i));
+      list.push(Value(n + i));
+    }
+  }
+  meter.Collect();
+}
+
+void ListReopen(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillList(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchList list;
+    benchmark::DoNotOptimize(list.size());
+  }
+  meter.Collect();
+}
+
+// db::Array
+
+void ArrayBulkInsert(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    meter.Resume();
+    FillArray(n);
+  }
+  meter.Collect();
+}
+
+void ArrayRandomRead(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Fresh();
+  FillArray(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchArray array;
+    for (size_t i : order) {
+      benchmark::DoNotOptimize(array.getConst(i));
+    }
+  }
+  meter.Collect();
+}
+
+void ArrayIterate(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillArray(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchArray array;
+    for (auto it = array.cbegin(); it != array.cend(); ++it) {
+      benchmark::DoNotOptimize(*it);
+    }
+  }
+  meter.Collect();
+}
+
+// Zeroes half of the elements and rewrites the other half.
+void ArrayChurn(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    FillArray(n);
+    meter.Resume();
+    BenchArray array;
+    for (size_t i = 0; i < n; i++) {
+      array[order[i]] = i < n / 2 ? 0 : i;
+    }
+  }
+  meter.Collect();
+}
+
+void ArrayReopen(benchmark::State& state) {
+  size_t n = state.range(0);
+  Fresh();
+  FillArray(n);
+  Meter meter(state);
+  for (auto _ : state) {
+    BenchArray array;
+    benchmark::DoNotOptimize(array.getConst(n / 2));
+  }
+  meter.Collect();
+}
+
+// StorageType, holding a whole vector under one key.
+
+void VectorBulkInsert(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    meter.Resume();
+    BenchVector vector;
+    for (size_t i = 0; i < n; i++) {
+      vector->push_back(i);
+    }
+  }
+  meter.Collect();
+}
+
+void VectorRandomRead(benchmark::State& state) {
+  size_t n = state.range(0);
+  std::vector<size_t> order = Shuffled(n);
+  Fresh();
+  {
+    BenchVector vector;
+    vector->assign(n, 1);
+  }
+  Meter meter(state);
+  for (auto _ : state) {
+    const BenchVector vector;
+    for (size_t i : order) {
+      benchmark::DoNotOptimize((*vector)[i]);
+    }
+  }
+  meter.Collect();
+}
+
+void VectorChurn(benchmark::State& state) {
+  size_t n = state.range(0);
+  Meter meter(state);
+  for (auto _ : state) {
+    meter.Pause();
+    Fresh();
+    {
+      BenchVector vector;
+      vector->assign(n, 1);
+    }
+    meter.Resume();
+    BenchVector vector;
+    vector->resize(n / 2);
+    vector->insert(vector->end(), n / 2, 2);
+  }
+  meter.Collect();
+}
+
+void Sizes(benchmark::internal::Benchmark* b) { b->Arg(64)->Arg(1024); }
+
+}  // namespace
+
+BENCHMARK(MapBulkInsert)->Apply(Sizes);
+BENCHMARK(MapRandomRead)->Apply(Sizes);
+BENCHMARK(MapRandomReadCached)->Apply(Sizes);
+BENCHMARK(MapIterate)->Apply(Sizes);
+BENCHMARK(MapChurn)->Apply(Sizes);
+BENCHMARK(MapReopen)->Apply(Sizes);
+BENCHMARK(ListBulkInsert)->Apply(Sizes);
+BENCHMARK(ListRandomRead)->Apply(Sizes);
+BENCHMARK(ListIterate)->Apply(Sizes);
+BENCHMARK(ListChurn)->Apply(Sizes);
+BENCHMARK(ListReopen)->Apply(Sizes);
+BENCHMARK(ArrayBulkInsert)->Apply(Sizes);
+BENCHMARK(ArrayRandomRead)->Apply(Sizes);
+BENCHMARK(ArrayIterate)->Apply(Sizes);
+BENCHMARK(ArrayChurn)->Apply(Sizes);
+BENCHMARK(ArrayReopen)->Apply(Sizes);
+BENCHMARK(VectorBulkInsert)->Apply(Sizes);
+BENCHMARK(VectorRandomRead)->Apply(Sizes);
+BENCHMARK(VectorChurn)->Apply(Sizes);
+
+BENCHMARK_MAIN();
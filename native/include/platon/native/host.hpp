@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief In-memory emulation of the chain imports for native builds.
+ *
+ * libplaton-host-native defines every function the contract library imports
+ * from the VM (storage, events, sha3, the environment getters, cross-contract
+ * calls and printing), so platonlib code and its tests build
+ * as ordinary executables. The functions below let a test or benchmark set
+ * up and inspect that emulated chain.
+ */
+namespace platon {
+namespace native {
+
+/**
+ * @brief Counters of the storage and event imports since the last reset.
+ */
+struct HostStats {
+  uint64_t set_state = 0;       ///< setState calls, deletions included
+  uint64_t get_state = 0;       ///< getState calls
+  uint64_t get_state_size = 0;  ///< getStateSize calls
+  uint64_t bytes_written = 0;   ///< Key and value bytes passed to setState
+  uint64_t bytes_read = 0;      ///< Value bytes copied out by getState
+  uint64_t events = 0;          ///< emitEvent calls
+};
+
+/**
+ * @brief A TEST_CASE of tests/unit/unittest.hpp that started running.
+ */
+struct TestCase {
+  std::string name;           ///< "<testName>.<testGroup>" as RUN_TEST names it
+  bool finished = false;      ///< Whether it returned rather than trapped
+  uint64_t assertions = 0;    ///< Assertions checked
+  uint64_t failures = 0;      ///< Assertions failed
+  uint64_t gas = 0;           ///< Gas used, when a TestMeter is set
+  uint64_t instructions = 0;  ///< Instructions run, when a TestMeter is set
+  double ms = 0;              ///< Wall time
+  HostStats stats;            ///< Storage and event imports it made
+};
+
+/**
+ * @brief Decides whether the test case of a name runs.
+ */
+typedef std::function<bool(const std::string& name)> TestFilter;
+
+/**
+ * @brief Reads the gas and instruction counters of the running contract,
+ * for a host that meters it.
+ */
+typedef std::function<void(uint64_t& gas, uint64_t& instructions)> TestMeter;
+
+/**
+ * @brief Handles platonCall and friends.
+ *
+ * @param address The 20 byte address of the called contract
+ * @param args The RLP encoded call
+ * @param delegate Whether it is a delegate call
+ * @return The bytes the called contract returns
+ */
+typedef std::function<std::vector<uint8_t>(
+    const uint8_t* address, const std::vector<uint8_t>& args, bool delegate)>
+    CallHandler;
+
+/**
+ * @brief Clear storage, environment, log, call handler and counters.
+ */
+void Reset();
+
+/**
+ * @brief Load the environment (gasPrice, number, caller, accounts, ...) from
+ * the JSON document the unit tests pass to setStateDB.
+ *
+ * @return false when the document does not parse
+ */
+bool SetEnvironment(const std::string& json);
+
+/**
+ * @brief Everything printed, emitted or called since the log was cleared.
+ */
+const std::string& Log();
+
+/**
+ * @brief Clear the log.
+ */
+void ClearLog();
+
+/**
+ * @brief Also write printed text to stdout, which is the default. Benchmarks
+ * turn it off.
+ */
+void SetEcho(bool echo);
+
+/**
+ * @brief Route platonCall and friends to a handler. Without one, calls
+ * return nothing.
+ */
+void SetCallHandler(CallHandler handler);
+
+/**
+ * @brief The number of keys in storage.
+ */
+size_t StateEntries();
+
+/**
+ * @brief The import counters.
+ */
+const HostStats& Stats();
+
+/**
+ * @brief Zero the import counters and keep storage as it is.
+ */
+void ResetStats();
+
+/**
+ * @brief Choose the test cases that run. Without a filter, the cases that
+ * match the PLATON_TEST_FILTER environment variable run, all of them when
+ * it is unset. Reset() removes the filter.
+ */
+void SetTestFilter(TestFilter filter);
+
+/**
+ * @brief Whether a test case name matches one of the ':' separated glob
+ * patterns, as in "map.*:list.batch".
+ */
+bool MatchTestFilter(const std::string& patterns, const std::string& name);
+
+/**
+ * @brief Meter the test cases. Reset() removes the meter.
+ */
+void SetTestMeter(TestMeter meter);
+
+/**
+ * @brief The test cases started since the last reset, in order.
+ */
+const std::vector<TestCase>& TestCases();
+
+/**
+ * @brief The platonTrace records of a contract built with PLATON_TRACE, see
+ * platon/trace.hpp. Reset() clears them.
+ */
+const std::vector<uint8_t>& Trace();
+
+}  // namespace native
+}  // namespace platon
@@ -0,0 +1,429 @@
+#include "Imports.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+extern "C" {
+void setState(const uint8_t* key, size_t klen, const uint8_t* value,
+              size_t vlen);
+size_t getStateSize(const uint8_t* key, size_t klen);
+void getState(const uint8_t* key, size_t klen, uint8_t* value, size_t vlen);
+void emitEvent(const char* topic, size_t topicLen, const uint8_t* data,
+               size_t dataLen);
+int64_t gasPrice();
+void blockHash(int64_t num, uint8_t hash[32]);
+uint64_t number();
+uint64_t gasLimit();
+int64_t timestamp();
+void coinbase(uint8_t hash[20]);
+void balance(uint8_t amount[32]);
+void origin(uint8_t hash[20]);
+void caller(uint8_t hash[20]);
+void callValue(uint8_t val[32]);
+void address(uint8_t hash[20]);
+void sha3(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t destLen);
+int64_t getCallerNonce();
+int64_t callTransfer(const uint8_t* to, size_t toLen, uint8_t amount[32]);
+char* platonCallString(const uint8_t* address, const uint8_t* args,
+                       uint32_t len);
+char* platonDelegateCallString(const uint8_t* address, const uint8_t* args,
+                               uint32_t len);
+int64_t platonCallInt64(const uint8_t* address, const uint8_t* args,
+                        uint32_t len);
+int64_t platonDelegateCallInt64(const uint8_t* address, const uint8_t* args,
+                                uint32_t len);
+void platonCall(const uint8_t* address, const uint8_t* args, uint32_t len);
+void platonDelegateCall(const uint8_t* address, const uint8_t* args,
+                        uint32_t len);
+void prints_l(const char* cstr, uint32_t len);
+void printi(int64_t value);
+void printui(uint64_t value);
+void printi128(const __int128* value);
+void printui128(const unsigned __int128* value);
+void printsf(float value);
+void printdf(double value);
+void printqf(const long double* value);
+void printhex(const void* data, uint32_t datalen);
+size_t getTestLogSize();
+size_t getTestLog(char* log, size_t size);
+void clearLog();
+void setStateDB(const char* data, size_t len);
+void bigintAdd(const uint8_t* src, size_t src_len, uint8_t* dst,
+               size_t& dst_len);
+void platonTrace(const uint8_t* data, size_t len);
+int32_t platonTestBegin(const uint8_t* name, size_t len);
+void platonTestEnd(uint32_t assertions, uint32_t failures);
+}
+
+namespace platon {
+namespace native {
+
+namespace {
+
+const uint32_t kPageSize = 65536;
+
+// The VM's malloc: a bump allocator over the memory above the module's
+// initial pages, with exact-size free lists. Each block has an 8 byte size
+// header and starts 16 byte aligned.
+class Heap {
+ public:
+  uint32_t Malloc(Instance& instance, uint32_t size) {
+    size = (size + 15) & ~15u;
+    auto& free = free_[size];
+    if (!free.empty()) {
+      uint32_t block = free.back();
+      free.pop_back();
+      return block;
+    }
+    if (next_ == 0) next_ = instance.MemorySize();
+    uint64_t block = ((uint64_t(next_) + 8 + 15) & ~uint64_t(15));
+    uint64_t end = block + size;
+    if (end > UINT32_MAX) return 0;
+    if (end > instance.MemorySize()) {
+      uint64_t missing = end - instance.MemorySize();
+      if (instance.GrowMemory(uint32_t((missing + kPageSize - 1) / kPageSize)) <
+          0) {
+        return 0;
+      }
+    }
+    std::memcpy(instance.Memory(uint32_t(block - 8), 4), &size, 4);
+    next_ = uint32_t(end);
+    return uint32_t(block);
+  }
+
+  void Free(Instance& instance, uint32_t block) {
+    if (block != 0) free_[Size(instance, block)].push_back(block);
+  }
+
+  uint32_t Size(Instance& instance, uint32_t block) {
+    uint32_t size;
+    std::memcpy(&size, instance.Memory(block - 8, 4), 4);
+    return size;
+  }
+
+ private:
+  uint32_t next_ = 0;
+  std::map<uint32_t, std::vector<uint32_t>> free_;
+};
+
+uint8_t* Ptr(Instance& instance, uint64_t address, uint64_t size) {
+  return instance.Memory(uint32_t(address), uint32_t(size));
+}
+
+// Copies size bytes out of memory, for host functions that take a pointer
+// to a wider type that wasm need not align.
+template <typename T>
+T Load(Instance& instance, uint64_t address) {
+  T value;
+  std::memcpy(&value, Ptr(instance, address, sizeof(T)), sizeof(T));
+  return value;
+}
+
+// wasm's long double is IEEE binary128; x86's is the 80 bit extended format.
+// Both have a 15 bit exponent with the same bias, so the conversion keeps the
+// exponent and rounds the mantissa down to 63 bits.
+long double QuadToLongDouble(const uint8_t* quad) {
+  uint64_t low, high;
+  std::memcpy(&low, quad, 8);
+  std::memcpy(&high, quad + 8, 8);
+  uint16_t sign_exponent = uint16_t(high >> 48);
+  uint64_t mantissa = ((high & 0xffffffffffffull) << 15) | (low >> 49);
+  if ((sign_exponent & 0x7fff) != 0) mantissa |= 1ull << 63;
+  uint8_t extended[sizeof(long double)] = {};
+  std::memcpy(extended, &mantissa, 8);
+  std::memcpy(extended + 8, &sign_exponent, 2);
+  long double value;
+  std::memcpy(&value, extended, sizeof(value));
+  return value;
+}
+
+// Copies a nul-terminated result of the host into wasm memory.
+uint32_t CopyString(Instance& instance, Heap& heap, const char* text) {
+  uint32_t size = uint32_t(std::strlen(text)) + 1;
+  uint32_t block = heap.Malloc(instance, size);
+  if (block != 0) std::memcpy(Ptr(instance, block, size), text, size);
+  return block;
+}
+
+}  // namespace
+
+std::map<std::string, HostFunction> HostImports() {
+  auto heap = std::make_shared<Heap>();
+  std::map<std::string, HostFunction> imports;
+
+  // Allocation and abort, which the VM supplies with the host allocator.
+
+  imports["malloc"] = [heap](Instance& in, const uint64_t* a) -> uint64_t {
+    return heap->Malloc(in, uint32_t(a[0]));
+  };
+  imports["free"] = [heap](Instance& in, const uint64_t* a) -> uint64_t {
+    heap->Free(in, uint32_t(a[0]));
+    return 0;
+  };
+  imports["calloc"] = [heap](Instance& in, const uint64_t* a) -> uint64_t {
+    uint64_t size = uint64_t(uint32_t(a[0])) * uint32_t(a[1]);
+    if (size > UINT32_MAX) return 0;
+    uint32_t block = heap->Malloc(in, uint32_t(size));
+    if (block != 0) std::memset(Ptr(in, block, size), 0, size);
+    return block;
+  };
+  imports["realloc"] = [heap](Instance& in, const uint64_t* a) -> uint64_t {
+    uint32_t old = uint32_t(a[0]);
+    uint32_t size = uint32_t(a[1]);
+    if (old == 0) return heap->Malloc(in, size);
+    uint32_t old_size = heap->Size(in, old);
+    if (size <= old_size) return old;
+    uint32_t block = heap->Malloc(in, size);
+    if (block != 0) {
+      std::memmove(Ptr(in, block, old_size), Ptr(in, old, old_size), old_size);
+      heap->Free(in, old);
+    }
+    return block;
+  };
+  imports["abort"] = [](Instance&, const uint64_t*) -> uint64_t {
+    throw Trap("abort");
+  };
+  imports["disable_free"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return 0;
+  };
+
+  // The block memory functions, which the VM supplies instead of libc.
+
+  imports["memcpy"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    uint32_t size = uint32_t(a[2]);
+    std::memcpy(Ptr(in, uint32_t(a[0]), size), Ptr(in, uint32_t(a[1]), size),
+                size);
+    return uint32_t(a[0]);
+  };
+  imports["memmove"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    uint32_t size = uint32_t(a[2]);
+    std::memmove(Ptr(in, uint32_t(a[0]), size), Ptr(in, uint32_t(a[1]), size),
+                 size);
+    return uint32_t(a[0]);
+  };
+  imports["memset"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    uint32_t size = uint32_t(a[2]);
+    std::memset(Ptr(in, uint32_t(a[0]), size), int(uint8_t(a[1])), size);
+    return uint32_t(a[0]);
+  };
+
+  // storage.hpp and event.hpp
+
+  imports["setState"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    setState(Ptr(in, a[0], a[1]), uint32_t(a[1]), Ptr(in, a[2], a[3]),
+             uint32_t(a[3]));
+    return 0;
+  };
+  imports["getStateSize"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    return getStateSize(Ptr(in, a[0], a[1]), uint32_t(a[1]));
+  };
+  imports["getState"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    getState(Ptr(in, a[0], a[1]), uint32_t(a[1]), Ptr(in, a[2], a[3]),
+             uint32_t(a[3]));
+    return 0;
+  };
+  imports["emitEvent"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    emitEvent(reinterpret_cast<const char*>(Ptr(in, a[0], a[1])),
+              uint32_t(a[1]), Ptr(in, a[2], a[3]), uint32_t(a[3]));
+    return 0;
+  };
+
+  // state.hpp
+
+  imports["gasPrice"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return uint64_t(gasPrice());
+  };
+  imports["blockHash"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    blockHash(int64_t(a[0]), Ptr(in, a[1], 32));
+    return 0;
+  };
+  imports["number"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return number();
+  };
+  imports["gasLimit"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return gasLimit();
+  };
+  imports["timestamp"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return uint64_t(timestamp());
+  };
+  imports["coinbase"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    coinbase(Ptr(in, a[0], 20));
+    return 0;
+  };
+  imports["balance"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    balance(Ptr(in, a[0], 32));
+    return 0;
+  };
+  imports["origin"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    origin(Ptr(in, a[0], 20));
+    return 0;
+  };
+  imports["caller"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    caller(Ptr(in, a[0], 20));
+    return 0;
+  };
+  imports["callValue"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    callValue(Ptr(in, a[0], 32));
+    return 0;
+  };
+  imports["address"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    address(Ptr(in, a[0], 20));
+    return 0;
+  };
+  imports["sha3"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    sha3(Ptr(in, a[0], a[1]), uint32_t(a[1]), Ptr(in, a[2], a[3]),
+         uint32_t(a[3]));
+    return 0;
+  };
+  imports["getCallerNonce"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return uint64_t(getCallerNonce());
+  };
+  imports["callTransfer"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    return uint64_t(
+        callTransfer(Ptr(in, a[0], a[1]), uint32_t(a[1]), Ptr(in, a[2], 32)));
+  };
+
+  // deployedcontract.hpp
+
+  imports["platonCallString"] = [heap](Instance& in,
+                                       const uint64_t* a) -> uint64_t {
+    return CopyString(in, *heap,
+                      platonCallString(Ptr(in, a[0], 20), Ptr(in, a[1], a[2]),
+                                       uint32_t(a[2])));
+  };
+  imports["platonDelegateCallString"] = [heap](Instance& in,
+                                               const uint64_t* a) -> uint64_t {
+    return CopyString(
+        in, *heap,
+        platonDelegateCallString(Ptr(in, a[0], 20), Ptr(in, a[1], a[2]),
+                                 uint32_t(a[2])));
+  };
+  imports["platonCallInt64"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    return uint64_t(platonCallInt64(Ptr(in, a[0], 20), Ptr(in, a[1], a[2]),
+                                    uint32_t(a[2])));
+  };
+  imports["platonDelegateCallInt64"] = [](Instance& in,
+                                          const uint64_t* a) -> uint64_t {
+    return uint64_t(platonDelegateCallInt64(
+        Ptr(in, a[0], 20), Ptr(in, a[1], a[2]), uint32_t(a[2])));
+  };
+  imports["platonCall"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    platonCall(Ptr(in, a[0], 20), Ptr(in, a[1], a[2]), uint32_t(a[2]));
+    return 0;
+  };
+  imports["platonDelegateCall"] = [](Instance& in,
+                                     const uint64_t* a) -> uint64_t {
+    platonDelegateCall(Ptr(in, a[0], 20), Ptr(in, a[1], a[2]),
+                       uint32_t(a[2]));
+    return 0;
+  };
+
+  // trace.hpp
+
+  imports["platonTrace"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    platonTrace(Ptr(in, a[0], a[1]), uint32_t(a[1]));
+    return 0;
+  };
+
+  // tests/unit/unittest.hpp
+
+  imports["platonTestBegin"] = [](Instance& in,
+                                  const uint64_t* a) -> uint64_t {
+    return uint32_t(platonTestBegin(Ptr(in, a[0], a[1]), uint32_t(a[1])));
+  };
+  imports["platonTestEnd"] = [](Instance&, const uint64_t* a) -> uint64_t {
+    platonTestEnd(uint32_t(a[0]), uint32_t(a[1]));
+    return 0;
+  };
+
+  // print.h
+
+  imports["prints"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    uint32_t start = uint32_t(a[0]);
+    uint32_t size = in.MemorySize() > start ? in.MemorySize() - start : 0;
+    const uint8_t* text = Ptr(in, start, size);
+    const void* nul = std::memchr(text, 0, size);
+    if (nul == nullptr) throw Trap("unterminated string");
+    prints_l(reinterpret_cast<const char*>(text),
+             uint32_t(static_cast<const uint8_t*>(nul) - text));
+    return 0;
+  };
+  imports["prints_l"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    prints_l(reinterpret_cast<const char*>(Ptr(in, a[0], a[1])),
+             uint32_t(a[1]));
+    return 0;
+  };
+  imports["printi"] = [](Instance&, const uint64_t* a) -> uint64_t {
+    printi(int64_t(a[0]));
+    return 0;
+  };
+  imports["printui"] = [](Instance&, const uint64_t* a) -> uint64_t {
+    printui(a[0]);
+    return 0;
+  };
+  imports["printi128"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    __int128 value = Load<__int128>(in, a[0]);
+    printi128(&value);
+    return 0;
+  };
+  imports["printui128"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    unsigned __int128 value = Load<unsigned __int128>(in, a[0]);
+    printui128(&value);
+    return 0;
+  };
+  imports["printsf"] = [](Instance&, const uint64_t* a) -> uint64_t {
+    uint32_t bits = uint32_t(a[0]);
+    float value;
+    std::memcpy(&value, &bits, 4);
+    printsf(value);
+    return 0;
+  };
+  imports["printdf"] = [](Instance&, const uint64_t* a) -> uint64_t {
+    double value;
+    std::memcpy(&value, &a[0], 8);
+    printdf(value);
+    return 0;
+  };
+  imports["printqf"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    long double value = QuadToLongDouble(Ptr(in, a[0], 16));
+    printqf(&value);
+    return 0;
+  };
+  imports["printhex"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    printhex(Ptr(in, a[0], a[1]), uint32_t(a[1]));
+    return 0;
+  };
+
+  // The test-only imports of tests/unit.
+
+  imports["getTestLogSize"] = [](Instance&, const uint64_t*) -> uint64_t {
+    return getTestLogSize();
+  };
+  imports["getTestLog"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    return getTestLog(reinterpret_cast<char*>(Ptr(in, a[0], a[1])),
+                      uint32_t(a[1]));
+  };
+  imports["clearLog"] = [](Instance&, const uint64_t*) -> uint64_t {
+    clearLog();
+    return 0;
+  };
+  imports["setStateDB"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    setStateDB(reinterpret_cast<const char*>(Ptr(in, a[0], a[1])),
+               uint32_t(a[1]));
+    return 0;
+  };
+  imports["bigintAdd"] = [](Instance& in, const uint64_t* a) -> uint64_t {
+    size_t dst_len = 0;
+    bigintAdd(Ptr(in, a[0], a[1]), uint32_t(a[1]), Ptr(in, a[2], a[1] + 1),
+              dst_len);
+    uint32_t wasm_len = uint32_t(dst_len);
+    std::memcpy(Ptr(in, a[3], 4), &wasm_len, 4);
+    return 0;
+  };
+
+  return imports;
+}
+
+}  // namespace native
+}  // namespace platon
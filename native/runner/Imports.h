@@ -0,0 +1,17 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "Interpreter.h"
+
+namespace platon {
+namespace native {
+
+// The chain imports of a contract, backed by libplaton-host-native, plus
+// malloc/free/calloc/realloc and abort. Each call returns fresh allocator
+// state, so use one map per Instance.
+std::map<std::string, HostFunction> HostImports();
+
+}  // namespace native
+}  // namespace platon
@@ -0,0 +1,1056 @@
+#include "Interpreter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "platon/wasm.hpp"
+
+namespace platon {
+namespace native {
+
+namespace wasm = platon::cdt::wasm;
+
+namespace {
+
+const uint32_t kPageSize = 65536;
+const unsigned kMaxDepth = 8192;
+const uint32_t kNone = UINT32_MAX;
+
+uint32_t ReadU32(const uint8_t*& p, const uint8_t* end) {
+  uint64_t value = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    if (p == end) throw Trap("truncated code");
+    byte = *p++;
+    if (shift < 64) value |= uint64_t(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return uint32_t(value);
+}
+
+int64_t ReadS64(const uint8_t*& p, const uint8_t* end) {
+  uint64_t value = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    if (p == end) throw Trap("truncated code");
+    byte = *p++;
+    if (shift < 64) value |= uint64_t(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  if (shift < 64 && (byte & 0x40)) value |= ~uint64_t(0) << shift;
+  return int64_t(value);
+}
+
+template <typename T>
+T Bits(uint64_t v) {
+  T value;
+  std::memcpy(&value, &v, sizeof(T));
+  return value;
+}
+
+template <typename T>
+uint64_t Raw(T value) {
+  uint64_t v = 0;
+  std::memcpy(&v, &value, sizeof(T));
+  return v;
+}
+
+template <typename T>
+T Min(T a, T b) {
+  if (std::isnan(a) || std::isnan(b)) return std::numeric_limits<T>::quiet_NaN();
+  if (a == b) return std::signbit(a) ? a : b;
+  return a < b ? a : b;
+}
+
+template <typename T>
+T Max(T a, T b) {
+  if (std::isnan(a) || std::isnan(b)) return std::numeric_limits<T>::quiet_NaN();
+  if (a == b) return std::signbit(a) ? b : a;
+  return a > b ? a : b;
+}
+
+// Truncates x to an integer in (lo, hi), or traps.
+template <typename I, typename F>
+I Truncate(F x, double lo, double hi) {
+  if (std::isnan(x)) throw Trap("invalid conversion to integer");
+  double t = std::trunc(double(x));
+  if (!(t > lo && t < hi)) throw Trap("integer overflow");
+  return I(t);
+}
+
+template <typename I, typename F>
+I TruncateSat(F x) {
+  if (std::isnan(x)) return 0;
+  if (x <= F(std::numeric_limits<I>::min())) return std::numeric_limits<I>::min();
+  if (x >= F(std::numeric_limits<I>::max())) return std::numeric_limits<I>::max();
+  return I(x);
+}
+
+template <typename T>
+T Rotl(T x, unsigned n) {
+  const unsigned w = sizeof(T) * 8;
+  n %= w;
+  return n == 0 ? x : T((x << n) | (x >> (w - n)));
+}
+
+template <typename T>
+T Rotr(T x, unsigned n) {
+  const unsigned w = sizeof(T) * 8;
+  n %= w;
+  return n == 0 ? x : T((x >> n) | (x << (w - n)));
+}
+
+// Skips the immediates of op so a scan can pair blocks with their end.
+void SkipImmediates(uint8_t op, const uint8_t*& p, const uint8_t* end) {
+  switch (op) {
+    case 0x02:
+    case 0x03:
+    case 0x04:
+      if (p == end) throw Trap("truncated code");
+      if (*p != 0x40 && (*p < 0x7c || *p > 0x7f)) {
+        throw Trap("multi-value blocks are not supported");
+      }
+      p++;
+      break;
+    case 0x0c:
+    case 0x0d:
+    case 0x10:
+    case 0x20:
+    case 0x21:
+    case 0x22:
+    case 0x23:
+    case 0x24:
+      ReadU32(p, end);
+      break;
+    case 0x0e:
+      for (uint32_t n = ReadU32(p, end) + 1; n > 0; n--) ReadU32(p, end);
+      break;
+    case 0x11:
+      ReadU32(p, end);
+      ReadU32(p, end);
+      break;
+    case 0x3f:
+    case 0x40:
+      ReadU32(p, end);
+      break;
+    case 0x41:
+    case 0x42:
+      ReadS64(p, end);
+      break;
+    case 0x43:
+      p += 4;
+      break;
+    case 0x44:
+      p += 8;
+      break;
+    case 0xfc:
+      if (ReadU32(p, end) > 7) throw Trap("unsupported 0xfc instruction");
+      break;
+    default:
+      if (op >= 0x28 && op <= 0x3e) {
+        ReadU32(p, end);
+        ReadU32(p, end);
+      } else if (op > 0xc4 || (op >= 0x06 && op <= 0x0a) ||
+                 (op >= 0x12 && op <= 0x19) || (op >= 0x1c && op <= 0x1f) ||
+                 op == 0x25 || op == 0x26 || op == 0x27) {
+        std::ostringstream os;
+        os << "unsupported opcode 0x" << std::hex << unsigned(op);
+        throw Trap(os.str());
+      }
+  }
+  if (p > end) throw Trap("truncated code");
+}
+
+}  // namespace
+
+struct Instance::Function {
+  uint32_t type = 0;
+  bool host = false;
+  // The gas of a call, for a host import.
+  uint64_t cost = 0;
+  std::string name;
+  HostFunction call;
+  uint32_t locals = 0;
+  std::vector<uint8_t> code;
+  // For the first instruction of every block, loop and if: the offset
+  // after its matching end, and after its else (kNone without one).
+  std::vector<uint32_t> end_of;
+  std::vector<uint32_t> else_of;
+};
+
+struct Instance::Label {
+  size_t cont;
+  size_t height;
+  uint32_t arity;
+  bool loop;
+};
+
+GasSchedule::GasSchedule() {
+  for (auto& c : cost) c = 1;
+}
+
+bool GasSchedule::Load(const std::string& path, std::string& error) {
+  std::ifstream in(path);
+  if (!in) {
+    error = "can't read " + path;
+    return false;
+  }
+  std::string line;
+  for (unsigned number = 1; std::getline(in, line); number++) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string opcode;
+    uint64_t value;
+    if (!(fields >> opcode)) continue;
+    if (opcode == "import") {
+      std::string name;
+      if (!(fields >> name >> value)) {
+        error = path + ":" + std::to_string(number) + ": bad entry";
+        return false;
+      }
+      imports[name] = value;
+      continue;
+    }
+    unsigned long op = std::strtoul(opcode.c_str(), nullptr, 16);
+    if (!(fields >> value) || op > 0xff) {
+      error = path + ":" + std::to_string(number) + ": bad entry";
+      return false;
+    }
+    cost[op] = value;
+  }
+  return true;
+}
+
+uint64_t GasSchedule::ImportCost(const std::string& name) const {
+  auto it = imports.find(name);
+  return it == imports.end() ? 0 : it->second;
+}
+
+Instance::Instance(const std::vector<uint8_t>& module,
+                   const std::map<std::string, HostFunction>& imports,
+                   const GasSchedule& schedule, uint64_t gas_limit)
+    : schedule_(schedule), gas_limit_(gas_limit) {
+  stack_.reserve(1 << 16);
+  try {
+    Decode(module, imports);
+  } catch (const wasm::Error& e) {
+    throw Trap(e.what());
+  }
+}
+
+Instance::~Instance() = default;
+
+uint64_t Instance::ConstExpr(const uint8_t*& p, const uint8_t* end) {
+  uint64_t value = 0;
+  for (;;) {
+    if (p == end) throw Trap("truncated constant expression");
+    uint8_t op = *p++;
+    if (op == 0x0b) return value;
+    if (op == 0x41) {
+      value = uint32_t(ReadS64(p, end));
+    } else if (op == 0x42) {
+      value = uint64_t(ReadS64(p, end));
+    } else if (op == 0x43 && end - p >= 4) {
+      std::memcpy(&value, p, 4);
+      p += 4;
+    } else if (op == 0x44 && end - p >= 8) {
+      std::memcpy(&value, p, 8);
+      p += 8;
+    } else if (op == 0x23) {
+      uint32_t index = ReadU32(p, end);
+      if (index >= globals_.size()) throw Trap("global index out of range");
+      value = globals_[index];
+    } else {
+      throw Trap("unsupported constant expression");
+    }
+  }
+}
+
+void Instance::Decode(const std::vector<uint8_t>& module,
+                      const std::map<std::string, HostFunction>& imports) {
+  wasm::Reader reader(module);
+  wasm::Bytes header = reader.Take(sizeof(wasm::kHeader));
+  if (std::memcmp(header.data(), wasm::kHeader, sizeof(wasm::kHeader)) != 0) {
+    throw Trap("not a wasm module");
+  }
+  std::vector<uint32_t> declared;
+  while (!reader.Done()) {
+    uint8_t id = reader.U8();
+    wasm::Bytes payload = reader.Take(reader.U32());
+    wasm::Reader section(payload);
+    const uint8_t* p = nullptr;
+    const uint8_t* end = payload.data() + payload.size();
+    switch (id) {
+      case wasm::kTypeSection:
+        for (uint32_t n = section.U32(); n > 0; n--) {
+          if (section.U8() != 0x60) throw Trap("bad function type");
+          param_types_.push_back(section.Take(section.U32()));
+          result_types_.push_back(section.Take(section.U32()));
+          if (result_types_.back().size() > 1) {
+            throw Trap("multi-value results are not supported");
+          }
+        }
+        break;
+      case wasm::kImportSection:
+        for (uint32_t n = section.U32(); n > 0; n--) {
+          section.Name();
+          std::string field = section.Name();
+          uint8_t kind = section.U8();
+          if (kind == wasm::kExternalFunction) {
+            Function f;
+            f.type = section.U32();
+            f.host = true;
+            f.name = field;
+            f.cost = schedule_.ImportCost(field);
+            auto it = imports.find(field);
+            if (it != imports.end()) f.call = it->second;
+            functions_.push_back(std::move(f));
+          } else if (kind == wasm::kExternalMemory) {
+            uint8_t flags = section.U8();
+            memory_.resize(size_t(section.U32()) * kPageSize);
+            if (flags & 1) max_pages_ = section.U32();
+          } else {
+            throw Trap("unsupported import " + field);
+          }
+        }
+        break;
+      case wasm::kFunctionSection:
+        for (uint32_t n = section.U32(); n > 0; n--) {
+          declared.push_back(section.U32());
+        }
+        break;
+      case wasm::kTableSection:
+        if (section.U32() > 0) {
+          section.U8();
+          uint8_t flags = section.U8();
+          table_.assign(section.U32(), kNone);
+          if (flags & 1) section.U32();
+        }
+        break;
+      case wasm::kMemorySection:
+        if (section.U32() > 0) {
+          uint8_t flags = section.U8();
+          memory_.resize(size_t(section.U32()) * kPageSize);
+          if (flags & 1) max_pages_ = section.U32();
+        }
+        break;
+      case wasm::kGlobalSection: {
+        uint32_t n = section.U32();
+        p = payload.data() + (payload.size() - section.Rest().size());
+        for (; n > 0; n--) {
+          if (end - p < 2) throw Trap("truncated global");
+          p += 2;
+          uint64_t value = ConstExpr(p, end);
+          globals_.push_back(value);
+        }
+        break;
+      }
+      case wasm::kExportSection:
+        for (uint32_t n = section.U32(); n > 0; n--) {
+          std::string name = section.Name();
+          uint8_t kind = section.U8();
+          uint32_t index = section.U32();
+          if (kind == wasm::kExternalFunction) exports_[name] = index;
+        }
+        break;
+      case wasm::kElementSection: {
+        uint32_t n = section.U32();
+        p = payload.data() + (payload.size() - section.Rest().size());
+        for (; n > 0; n--) {
+          if (ReadU32(p, end) != 0) throw Trap("unsupported element segment");
+          uint32_t offset = uint32_t(ConstExpr(p, end));
+          uint32_t count = ReadU32(p, end);
+          if (uint64_t(offset) + count > table_.size()) {
+            throw Trap("element segment out of bounds");
+          }
+          for (uint32_t i = 0; i < count; i++) {
+            table_[offset + i] = ReadU32(p, end);
+          }
+        }
+        break;
+      }
+      case wasm::kCodeSection: {
+        uint32_t count = section.U32();
+        if (count != declared.size()) throw Trap("function count mismatch");
+        for (uint32_t i = 0; i < count; i++) {
+          wasm::Bytes body = section.Take(section.U32());
+          wasm::Reader locals(body);
+          Function f;
+          f.type = declared[i];
+          for (uint32_t n = locals.U32(); n > 0; n--) {
+            f.locals += locals.U32();
+            locals.U8();
+          }
+          f.code = locals.Rest();
+          f.end_of.assign(f.code.size() + 1, kNone);
+          f.else_of.assign(f.code.size() + 1, kNone);
+          std::vector<uint32_t> open;
+          const uint8_t* begin = f.code.data();
+          const uint8_t* q = begin;
+          const uint8_t* code_end = begin + f.code.size();
+          while (q < code_end) {
+            uint8_t op = *q++;
+            SkipImmediates(op, q, code_end);
+            if (op == 0x02 || op == 0x03 || op == 0x04) {
+              open.push_back(uint32_t(q - begin));
+            } else if (op == 0x05 && !open.empty()) {
+              f.else_of[open.back()] = uint32_t(q - begin);
+            } else if (op == 0x0b && !open.empty()) {
+              f.end_of[open.back()] = uint32_t(q - begin);
+              open.pop_back();
+            }
+          }
+          functions_.push_back(std::move(f));
+        }
+        break;
+      }
+      case wasm::kDataSection: {
+        uint32_t n = section.U32();
+        p = payload.data() + (payload.size() - section.Rest().size());
+        for (; n > 0; n--) {
+          uint32_t flags = ReadU32(p, end);
+          if (flags == 2) ReadU32(p, end);
+          if (flags == 1) throw Trap("passive data segments are not supported");
+          uint32_t offset = uint32_t(ConstExpr(p, end));
+          uint32_t size = ReadU32(p, end);
+          if (size_t(end - p) < size ||
+              uint64_t(offset) + size > memory_.size()) {
+            throw Trap("data segment out of bounds");
+          }
+          std::memcpy(memory_.data() + offset, p, size);
+          p += size;
+        }
+        break;
+      }
+      case wasm::kCustomSection:
+        if (section.Name() == "name") ReadNames(section.Rest());
+        break;
+      default:
+        break;
+    }
+  }
+  for (const auto& f : functions_) {
+    if (f.type >= param_types_.size()) throw Trap("type index out of range");
+  }
+  for (const auto& e : exports_) {
+    if (e.second < functions_.size() && functions_[e.second].name.empty()) {
+      functions_[e.second].name = e.first;
+    }
+  }
+}
+
+// Names functions from the function names subsection; a malformed section
+// is ignored, like any other custom section.
+void Instance::ReadNames(const std::vector<uint8_t>& payload) {
+  try {
+    wasm::Reader reader(payload);
+    while (!reader.Done()) {
+      uint8_t id = reader.U8();
+      wasm::Bytes subsection = reader.Take(reader.U32());
+      if (id != 1) continue;
+      wasm::Reader names(subsection);
+      for (uint32_t n = names.U32(); n > 0; n--) {
+        uint32_t index = names.U32();
+        std::string name = names.Name();
+        if (index < functions_.size()) functions_[index].name = name;
+      }
+    }
+  } catch (const wasm::Error&) {
+  }
+}
+
+uint32_t Instance::EnterProfileNode(uint32_t function) {
+  uint64_t key = uint64_t(profile_node_) << 32 | function;
+  auto it = profile_children_.find(key);
+  if (it != profile_children_.end()) return it->second;
+  uint32_t node = uint32_t(profile_.size());
+  profile_.push_back(ProfileNode{profile_node_, function, 0, 0});
+  profile_children_[key] = node;
+  return node;
+}
+
+std::vector<ProfileEntry> Instance::Profile() const {
+  std::vector<ProfileEntry> entries;
+  for (const auto& node : profile_) {
+    if (node.instructions == 0) continue;
+    ProfileEntry entry{{}, node.gas, node.instructions};
+    for (const ProfileNode* n = &node; n != &profile_[0];
+         n = &profile_[n->parent]) {
+      const std::string& name = functions_[n->function].name;
+      entry.stack.push_back(name.empty()
+                                ? "func[" + std::to_string(n->function) + "]"
+                                : name);
+    }
+    std::reverse(entry.stack.begin(), entry.stack.end());
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+bool Instance::HasExport(const std::string& name) const {
+  return exports_.count(name) != 0;
+}
+
+size_t Instance::ParamCount(const std::string& name) const {
+  auto it = exports_.find(name);
+  if (it == exports_.end()) throw Trap("no export " + name);
+  return param_types_[functions_.at(it->second).type].size();
+}
+
+std::vector<uint64_t> Instance::Call(const std::string& name,
+                                     const std::vector<uint64_t>& args) {
+  auto it = exports_.find(name);
+  if (it == exports_.end()) throw Trap("no export " + name);
+  const Function& f = functions_.at(it->second);
+  if (args.size() != param_types_[f.type].size()) {
+    throw Trap("wrong argument count for " + name);
+  }
+  size_t base = stack_.size();
+  stack_.insert(stack_.end(), args.begin(), args.end());
+  try {
+    Execute(it->second);
+  } catch (...) {
+    stack_.resize(base);
+    depth_ = 0;
+    profile_node_ = 0;
+    throw;
+  }
+  std::vector<uint64_t> results(stack_.begin() + base, stack_.end());
+  stack_.resize(base);
+  return results;
+}
+
+uint8_t* Instance::Memory(uint32_t address, uint32_t size) {
+  if (uint64_t(address) + size > memory_.size()) {
+    throw Trap("out of bounds memory access");
+  }
+  return memory_.data() + address;
+}
+
+int32_t Instance::GrowMemory(uint32_t pages) {
+  uint32_t old = uint32_t(memory_.size() / kPageSize);
+  if (uint64_t(old) + pages > max_pages_ || uint64_t(old) + pages > 65536) {
+    return -1;
+  }
+  memory_.resize(size_t(old + pages) * kPageSize);
+  return int32_t(old);
+}
+
+void Instance::Branch(std::vector<Label>& labels, uint32_t depth,
+                      size_t& pc) {
+  if (depth >= labels.size()) throw Trap("branch depth out of range");
+  const Label target = labels[labels.size() - 1 - depth];
+  uint32_t arity = target.loop ? 0 : target.arity;
+  if (stack_.size() < target.height + arity) throw Trap("stack underflow");
+  std::copy(stack_.end() - arity, stack_.end(),
+            stack_.begin() + target.height);
+  stack_.resize(target.height + arity);
+  labels.resize(labels.size() - depth - (target.loop ? 0 : 1));
+  pc = target.cont;
+}
+
+void Instance::Execute(uint32_t index) {
+  Function& f = functions_[index];
+  const auto& params = param_types_[f.type];
+  uint32_t arity = uint32_t(result_types_[f.type].size());
+  if (stack_.size() < params.size()) throw Trap("stack underflow");
+  size_t base = stack_.size() - params.size();
+
+  if (f.host) {
+    if (!f.call) throw Trap("unresolved import " + f.name);
+    // Charged to the caller, whose call instruction is already counted.
+    gas_ += f.cost;
+    if (profiling_) profile_[profile_node_].gas += f.cost;
+    if (gas_ > gas_limit_) throw Trap("out of gas");
+    std::vector<uint64_t> args(stack_.begin() + base, stack_.end());
+    stack_.resize(base);
+    uint64_t result = f.call(*this, args.data());
+    if (arity) stack_.push_back(result);
+    return;
+  }
+
+  if (++depth_ > kMaxDepth) throw Trap("call stack exhausted");
+  uint32_t caller_node = profile_node_;
+  if (profiling_) profile_node_ = EnterProfileNode(index);
+  stack_.resize(stack_.size() + f.locals, 0);
+  size_t locals = params.size() + f.locals;
+
+  std::vector<Label> labels;
+  labels.reserve(16);
+  labels.push_back(Label{f.code.size(), base + locals, arity, false});
+
+  const uint8_t* code = f.code.data();
+  const uint8_t* code_end = code + f.code.size();
+  size_t pc = 0;
+
+#define POP() (stack_.pop_back(), stack_.data()[stack_.size()])
+#define TOP() stack_.back()
+#define I32(v) uint64_t(uint32_t(v))
+#define BINARY(T, expr)                      \
+  {                                          \
+    T b = Bits<T>(POP());                    \
+    T a = Bits<T>(TOP());                    \
+    TOP() = Raw<T>(expr);                    \
+  }                                          \
+  break
+#define COMPARE(T, expr)                     \
+  {                                          \
+    T b = Bits<T>(POP());                    \
+    T a = Bits<T>(TOP());                    \
+    TOP() = (expr) ? 1 : 0;                  \
+  }                                          \
+  break
+#define UNARY(T, R, expr)                    \
+  {                                          \
+    T a = Bits<T>(TOP());                    \
+    TOP() = Raw<R>(expr);                    \
+  }                                          \
+  break
+#define LOAD(T, M)                                           \
+  {                                                          \
+    ReadU32(p, code_end);                                    \
+    uint32_t offset = ReadU32(p, code_end);                  \
+    uint64_t ea = uint64_t(uint32_t(TOP())) + offset;        \
+    if (ea + sizeof(M) > memory_.size()) {                   \
+      throw Trap("out of bounds memory access");             \
+    }                                                        \
+    M m;                                                     \
+    std::memcpy(&m, memory_.data() + ea, sizeof(M));         \
+    TOP() = Raw<T>(T(m));                                    \
+  }                                                          \
+  break
+#define STORE(T, M)                                          \
+  {                                                          \
+    ReadU32(p, code_end);                                    \
+    uint32_t offset = ReadU32(p, code_end);                  \
+    M m = M(Bits<T>(POP()));                                 \
+    uint64_t ea = uint64_t(uint32_t(POP())) + offset;        \
+    if (ea + sizeof(M) > memory_.size()) {                   \
+      throw Trap("out of bounds memory access");             \
+    }                                                        \
+    std::memcpy(memory_.data() + ea, &m, sizeof(M));         \
+  }                                                          \
+  break
+
+  while (!labels.empty()) {
+    const uint8_t* p = code + pc;
+    uint8_t op = *p++;
+    gas_ += schedule_.cost[op];
+    instructions_++;
+    if (profiling_) {
+      profile_[profile_node_].gas += schedule_.cost[op];
+      profile_[profile_node_].instructions++;
+    }
+    if (gas_ > gas_limit_) throw Trap("out of gas");
+
+    switch (op) {
+      case 0x00:
+        throw Trap("unreachable executed");
+      case 0x01:
+        break;
+      case 0x02:
+      case 0x03: {
+        uint8_t type = *p++;
+        size_t start = p - code;
+        if (op == 0x02) {
+          labels.push_back(Label{f.end_of[start], stack_.size(),
+                                 type == 0x40 ? 0u : 1u, false});
+        } else {
+          labels.push_back(Label{start, stack_.size(), 0, true});
+        }
+        break;
+      }
+      case 0x04: {
+        uint8_t type = *p++;
+        size_t start = p - code;
+        uint32_t cond = uint32_t(POP());
+        if (cond) {
+          labels.push_back(Label{f.end_of[start], stack_.size(),
+                                 type == 0x40 ? 0u : 1u, false});
+        } else if (f.else_of[start] != kNone) {
+          labels.push_back(Label{f.end_of[start], stack_.size(),
+                                 type == 0x40 ? 0u : 1u, false});
+          p = code + f.else_of[start];
+        } else {
+          p = code + f.end_of[start];
+        }
+        break;
+      }
+      case 0x05:
+        p = code + labels.back().cont;
+        labels.pop_back();
+        break;
+      case 0x0b:
+        labels.pop_back();
+        break;
+      case 0x0c:
+        pc = p - code;
+        Branch(labels, ReadU32(p, code_end), pc);
+        continue;
+      case 0x0d: {
+        uint32_t depth = ReadU32(p, code_end);
+        if (uint32_t(POP())) {
+          pc = p - code;
+          Branch(labels, depth, pc);
+          continue;
+        }
+        break;
+      }
+      case 0x0e: {
+        uint32_t count = ReadU32(p, code_end);
+        uint32_t selected = uint32_t(POP());
+        uint32_t depth = 0;
+        for (uint32_t i = 0; i <= count; i++) {
+          uint32_t d = ReadU32(p, code_end);
+          if (i == selected || i == count) {
+            depth = d;
+            break;
+          }
+        }
+        Branch(labels, depth, pc);
+        continue;
+      }
+      case 0x0f:
+        pc = p - code;
+        Branch(labels, uint32_t(labels.size() - 1), pc);
+        continue;
+      case 0x10: {
+        uint32_t callee = ReadU32(p, code_end);
+        if (callee >= functions_.size()) throw Trap("call out of range");
+        Execute(callee);
+        break;
+      }
+      case 0x11: {
+        uint32_t type = ReadU32(p, code_end);
+        ReadU32(p, code_end);
+        uint32_t slot = uint32_t(POP());
+        if (slot >= table_.size() || table_[slot] == kNone) {
+          throw Trap("undefined table element");
+        }
+        const Function& callee = functions_[table_[slot]];
+        if (param_types_[callee.type] != param_types_[type] ||
+            result_types_[callee.type] != result_types_[type]) {
+          throw Trap("indirect call signature mismatch");
+        }
+        Execute(table_[slot]);
+        break;
+      }
+      case 0x1a:
+        stack_.pop_back();
+        break;
+      case 0x1b: {
+        uint32_t cond = uint32_t(POP());
+        uint64_t b = POP();
+        if (!cond) TOP() = b;
+        break;
+      }
+      case 0x20:
+        stack_.push_back(stack_[base + ReadU32(p, code_end)]);
+        break;
+      case 0x21:
+        stack_[base + ReadU32(p, code_end)] = POP();
+        break;
+      case 0x22:
+        stack_[base + ReadU32(p, code_end)] = TOP();
+        break;
+      case 0x23:
+        stack_.push_back(globals_.at(ReadU32(p, code_end)));
+        break;
+      case 0x24:
+        globals_.at(ReadU32(p, code_end)) = POP();
+        break;
+
+      case 0x28: LOAD(uint32_t, uint32_t);
+      case 0x29: LOAD(uint64_t, uint64_t);
+      case 0x2a: LOAD(uint32_t, uint32_t);
+      case 0x2b: LOAD(uint64_t, uint64_t);
+      case 0x2c: LOAD(uint32_t, int8_t);
+      case 0x2d: LOAD(uint32_t, uint8_t);
+      case 0x2e: LOAD(uint32_t, int16_t);
+      case 0x2f: LOAD(uint32_t, uint16_t);
+      case 0x30: LOAD(uint64_t, int8_t);
+      case 0x31: LOAD(uint64_t, uint8_t);
+      case 0x32: LOAD(uint64_t, int16_t);
+      case 0x33: LOAD(uint64_t, uint16_t);
+      case 0x34: LOAD(uint64_t, int32_t);
+      case 0x35: LOAD(uint64_t, uint32_t);
+      case 0x36: STORE(uint32_t, uint32_t);
+      case 0x37: STORE(uint64_t, uint64_t);
+      case 0x38: STORE(uint32_t, uint32_t);
+      case 0x39: STORE(uint64_t, uint64_t);
+      case 0x3a: STORE(uint32_t, uint8_t);
+      case 0x3b: STORE(uint32_t, uint16_t);
+      case 0x3c: STORE(uint64_t, uint8_t);
+      case 0x3d: STORE(uint64_t, uint16_t);
+      case 0x3e: STORE(uint64_t, uint32_t);
+
+      case 0x3f:
+        ReadU32(p, code_end);
+        stack_.push_back(memory_.size() / kPageSize);
+        break;
+      case 0x40:
+        ReadU32(p, code_end);
+        TOP() = I32(GrowMemory(uint32_t(TOP())));
+        break;
+      case 0x41:
+        stack_.push_back(I32(ReadS64(p, code_end)));
+        break;
+      case 0x42:
+        stack_.push_back(uint64_t(ReadS64(p, code_end)));
+        break;
+      case 0x43: {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        p += 4;
+        stack_.push_back(v);
+        break;
+      }
+      case 0x44: {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        p += 8;
+        stack_.push_back(v);
+        break;
+      }
+
+      case 0x45: TOP() = uint32_t(TOP()) == 0; break;
+      case 0x46: COMPARE(uint32_t, a == b);
+      case 0x47: COMPARE(uint32_t, a != b);
+      case 0x48: COMPARE(int32_t, a < b);
+      case 0x49: COMPARE(uint32_t, a < b);
+      case 0x4a: COMPARE(int32_t, a > b);
+      case 0x4b: COMPARE(uint32_t, a > b);
+      case 0x4c: COMPARE(int32_t, a <= b);
+      case 0x4d: COMPARE(uint32_t, a <= b);
+      case 0x4e: COMPARE(int32_t, a >= b);
+      case 0x4f: COMPARE(uint32_t, a >= b);
+      case 0x50: TOP() = TOP() == 0; break;
+      case 0x51: COMPARE(uint64_t, a == b);
+      case 0x52: COMPARE(uint64_t, a != b);
+      case 0x53: COMPARE(int64_t, a < b);
+      case 0x54: COMPARE(uint64_t, a < b);
+      case 0x55: COMPARE(int64_t, a > b);
+      case 0x56: COMPARE(uint64_t, a > b);
+      case 0x57: COMPARE(int64_t, a <= b);
+      case 0x58: COMPARE(uint64_t, a <= b);
+      case 0x59: COMPARE(int64_t, a >= b);
+      case 0x5a: COMPARE(uint64_t, a >= b);
+      case 0x5b: COMPARE(float, a == b);
+      case 0x5c: COMPARE(float, a != b);
+      case 0x5d: COMPARE(float, a < b);
+      case 0x5e: COMPARE(float, a > b);
+      case 0x5f: COMPARE(float, a <= b);
+      case 0x60: COMPARE(float, a >= b);
+      case 0x61: COMPARE(double, a == b);
+      case 0x62: COMPARE(double, a != b);
+      case 0x63: COMPARE(double, a < b);
+      case 0x64: COMPARE(double, a > b);
+      case 0x65: COMPARE(double, a <= b);
+      case 0x66: COMPARE(double, a >= b);
+
+      case 0x67: UNARY(uint32_t, uint32_t, a ? __builtin_clz(a) : 32);
+      case 0x68: UNARY(uint32_t, uint32_t, a ? __builtin_ctz(a) : 32);
+      case 0x69: UNARY(uint32_t, uint32_t, __builtin_popcount(a));
+      case 0x6a: BINARY(uint32_t, a + b);
+      case 0x6b: BINARY(uint32_t, a - b);
+      case 0x6c: BINARY(uint32_t, a * b);
+      case 0x6d: {
+        int32_t b = Bits<int32_t>(POP());
+        int32_t a = Bits<int32_t>(TOP());
+        if (b == 0) throw Trap("integer divide by zero");
+        if (a == INT32_MIN && b == -1) throw Trap("integer overflow");
+        TOP() = I32(a / b);
+        break;
+      }
+      case 0x6e: {
+        uint32_t b = uint32_t(POP());
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = uint32_t(TOP()) / b;
+        break;
+      }
+      case 0x6f: {
+        int32_t b = Bits<int32_t>(POP());
+        int32_t a = Bits<int32_t>(TOP());
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = (b == -1) ? 0 : I32(a % b);
+        break;
+      }
+      case 0x70: {
+        uint32_t b = uint32_t(POP());
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = uint32_t(TOP()) % b;
+        break;
+      }
+      case 0x71: BINARY(uint32_t, a & b);
+      case 0x72: BINARY(uint32_t, a | b);
+      case 0x73: BINARY(uint32_t, a ^ b);
+      case 0x74: BINARY(uint32_t, a << (b & 31));
+      case 0x75: BINARY(int32_t, a >> (b & 31));
+      case 0x76: BINARY(uint32_t, a >> (b & 31));
+      case 0x77: BINARY(uint32_t, Rotl(a, b));
+      case 0x78: BINARY(uint32_t, Rotr(a, b));
+
+      case 0x79: UNARY(uint64_t, uint64_t, a ? __builtin_clzll(a) : 64);
+      case 0x7a: UNARY(uint64_t, uint64_t, a ? __builtin_ctzll(a) : 64);
+      case 0x7b: UNARY(uint64_t, uint64_t, __builtin_popcountll(a));
+      case 0x7c: BINARY(uint64_t, a + b);
+      case 0x7d: BINARY(uint64_t, a - b);
+      case 0x7e: BINARY(uint64_t, a * b);
+      case 0x7f: {
+        int64_t b = Bits<int64_t>(POP());
+        int64_t a = Bits<int64_t>(TOP());
+        if (b == 0) throw Trap("integer divide by zero");
+        if (a == INT64_MIN && b == -1) throw Trap("integer overflow");
+        TOP() = uint64_t(a / b);
+        break;
+      }
+      case 0x80: {
+        uint64_t b = POP();
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = TOP() / b;
+        break;
+      }
+      case 0x81: {
+        int64_t b = Bits<int64_t>(POP());
+        int64_t a = Bits<int64_t>(TOP());
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = (b == -1) ? 0 : uint64_t(a % b);
+        break;
+      }
+      case 0x82: {
+        uint64_t b = POP();
+        if (b == 0) throw Trap("integer divide by zero");
+        TOP() = TOP() % b;
+        break;
+      }
+      case 0x83: BINARY(uint64_t, a & b);
+      case 0x84: BINARY(uint64_t, a | b);
+      case 0x85: BINARY(uint64_t, a ^ b);
+      case 0x86: BINARY(uint64_t, a << (b & 63));
+      case 0x87: BINARY(int64_t, a >> (b & 63));
+      case 0x88: BINARY(uint64_t, a >> (b & 63));
+      case 0x89: BINARY(uint64_t, Rotl(a, unsigned(b)));
+      case 0x8a: BINARY(uint64_t, Rotr(a, unsigned(b)));
+
+      case 0x8b: UNARY(float, float, std::fabs(a));
+      case 0x8c: UNARY(float, float, -a);
+      case 0x8d: UNARY(float, float, std::ceil(a));
+      case 0x8e: UNARY(float, float, std::floor(a));
+      case 0x8f: UNARY(float, float, std::trunc(a));
+      case 0x90: UNARY(float, float, std::nearbyint(a));
+      case 0x91: UNARY(float, float, std::sqrt(a));
+      case 0x92: BINARY(float, a + b);
+      case 0x93: BINARY(float, a - b);
+      case 0x94: BINARY(float, a * b);
+      case 0x95: BINARY(float, a / b);
+      case 0x96: BINARY(float, Min(a, b));
+      case 0x97: BINARY(float, Max(a, b));
+      case 0x98: BINARY(float, std::copysign(a, b));
+      case 0x99: UNARY(double, double, std::fabs(a));
+      case 0x9a: UNARY(double, double, -a);
+      case 0x9b: UNARY(double, double, std::ceil(a));
+      case 0x9c: UNARY(double, double, std::floor(a));
+      case 0x9d: UNARY(double, double, std::trunc(a));
+      case 0x9e: UNARY(double, double, std::nearbyint(a));
+      case 0x9f: UNARY(double, double, std::sqrt(a));
+      case 0xa0: BINARY(double, a + b);
+      case 0xa1: BINARY(double, a - b);
+      case 0xa2: BINARY(double, a * b);
+      case 0xa3: BINARY(double, a / b);
+      case 0xa4: BINARY(double, Min(a, b));
+      case 0xa5: BINARY(double, Max(a, b));
+      case 0xa6: BINARY(double, std::copysign(a, b));
+
+      case 0xa7: TOP() = I32(TOP()); break;
+      case 0xa8:
+        UNARY(float, int32_t,
+              (Truncate<int32_t>(a, -2147483649.0, 2147483648.0)));
+      case 0xa9:
+        UNARY(float, uint32_t, (Truncate<uint32_t>(a, -1.0, 4294967296.0)));
+      case 0xaa:
+        UNARY(double, int32_t,
+              (Truncate<int32_t>(a, -2147483649.0, 2147483648.0)));
+      case 0xab:
+        UNARY(double, uint32_t, (Truncate<uint32_t>(a, -1.0, 4294967296.0)));
+      case 0xac: TOP() = uint64_t(int64_t(int32_t(TOP()))); break;
+      case 0xad: TOP() = uint32_t(TOP()); break;
+      case 0xae:
+        UNARY(float, int64_t,
+              (Truncate<int64_t>(a, -9223372036854777856.0,
+                                 9223372036854775808.0)));
+      case 0xaf:
+        UNARY(float, uint64_t,
+              (Truncate<uint64_t>(a, -1.0, 18446744073709551616.0)));
+      case 0xb0:
+        UNARY(double, int64_t,
+              (Truncate<int64_t>(a, -9223372036854777856.0,
+                                 9223372036854775808.0)));
+      case 0xb1:
+        UNARY(double, uint64_t,
+              (Truncate<uint64_t>(a, -1.0, 18446744073709551616.0)));
+      case 0xb2: UNARY(int32_t, float, float(a));
+      case 0xb3: UNARY(uint32_t, float, float(a));
+      case 0xb4: UNARY(int64_t, float, float(a));
+      case 0xb5: UNARY(uint64_t, float, float(a));
+      case 0xb6: UNARY(double, float, float(a));
+      case 0xb7: UNARY(int32_t, double, double(a));
+      case 0xb8: UNARY(uint32_t, double, double(a));
+      case 0xb9: UNARY(int64_t, double, double(a));
+      case 0xba: UNARY(uint64_t, double, double(a));
+      case 0xbb: UNARY(float, double, double(a));
+      case 0xbc:
+      case 0xbe: TOP() = I32(TOP()); break;
+      case 0xbd:
+      case 0xbf: break;
+      case 0xc0: TOP() = I32(int32_t(int8_t(TOP()))); break;
+      case 0xc1: TOP() = I32(int32_t(int16_t(TOP()))); break;
+      case 0xc2: TOP() = uint64_t(int64_t(int8_t(TOP()))); break;
+      case 0xc3: TOP() = uint64_t(int64_t(int16_t(TOP()))); break;
+      case 0xc4: TOP() = uint64_t(int64_t(int32_t(TOP()))); break;
+      case 0xfc:
+        switch (ReadU32(p, code_end)) {
+          case 0: UNARY(float, int32_t, (TruncateSat<int32_t>(a)));
+          case 1: UNARY(float, uint32_t, (TruncateSat<uint32_t>(a)));
+          case 2: UNARY(double, int32_t, (TruncateSat<int32_t>(a)));
+          case 3: UNARY(double, uint32_t, (TruncateSat<uint32_t>(a)));
+          case 4: UNARY(float, int64_t, (TruncateSat<int64_t>(a)));
+          case 5: UNARY(float, uint64_t, (TruncateSat<uint64_t>(a)));
+          case 6: UNARY(double, int64_t, (TruncateSat<int64_t>(a)));
+          case 7: UNARY(double, uint64_t, (TruncateSat<uint64_t>(a)));
+          default: throw Trap("unsupported 0xfc instruction");
+        }
+        break;
+      default: {
+        std::ostringstream os;
+        os << "unsupported opcode 0x" << std::hex << unsigned(op);
+        throw Trap(os.str());
+      }
+    }
+    pc = p - code;
+  }
+
+#undef POP
+#undef TOP
+#undef I32
+#undef BINARY
+#undef COMPARE
+#undef UNARY
+#undef LOAD
+#undef STORE
+
+  // The function's own label was taken by its end, a return or a branch to
+  // it; its results are on top of the stack.
+  std::copy(stack_.end() - arity, stack_.end(), stack_.begin() + base);
+  stack_.resize(base + arity);
+  depth_--;
+  profile_node_ = caller_node;
+}
+
+}  // namespace native
+}  // namespace platon
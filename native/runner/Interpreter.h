@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace platon {
+namespace native {
+
+// Raised for a wasm trap, and for a module the interpreter cannot load.
+class Trap : public std::runtime_error {
+ public:
+  explicit Trap(const std::string& what) : std::runtime_error(what) {}
+};
+
+class Instance;
+
+// Gas and instructions spent in a function's own code on one call path,
+// outermost function first. Functions are named by the module's name
+// section, else by their export or import, else "func[<index>]".
+struct ProfileEntry {
+  std::vector<std::string> stack;
+  uint64_t gas;
+  uint64_t instructions;
+};
+
+// A host import. Arguments and the result are raw value bits: i32 in the low
+// 32 bits, floats as their IEEE encoding.
+typedef std::function<uint64_t(Instance& instance, const uint64_t* args)>
+    HostFunction;
+
+// Gas charged per executed instruction, indexed by opcode, and per call of a
+// host import, by field name. The 0xfc prefixed saturating conversions are
+// charged cost[0xfc]. The default schedule is flat, one per instruction and
+// nothing for host calls; it is not what the chain charges.
+struct GasSchedule {
+  GasSchedule();
+
+  // Reads "<opcode> <cost>" lines, opcodes in hex ("0x10 5"), and
+  // "import <name> <cost>" lines ("import setState 20000"); '#' starts a
+  // comment. Entries that are not listed keep their cost.
+  bool Load(const std::string& path, std::string& error);
+
+  uint64_t ImportCost(const std::string& name) const;
+
+  uint64_t cost[256];
+  std::map<std::string, uint64_t> imports;
+};
+
+// One instantiated module: its memory, globals and table, interpreted with
+// instruction metering. Not thread-safe.
+class Instance {
+ public:
+  // Decodes and instantiates the module. Function imports are looked up by
+  // field name; a missing one only traps once it is called. Throws Trap when
+  // the module uses a feature outside the wasm MVP.
+  Instance(const std::vector<uint8_t>& module,
+           const std::map<std::string, HostFunction>& imports,
+           const GasSchedule& schedule, uint64_t gas_limit);
+  ~Instance();
+
+  bool HasExport(const std::string& name) const;
+
+  // The parameter count of an exported function; throws Trap.
+  size_t ParamCount(const std::string& name) const;
+
+  // Calls an exported function; throws Trap.
+  std::vector<uint64_t> Call(const std::string& name,
+                             const std::vector<uint64_t>& args);
+
+  uint64_t GasUsed() const { return gas_; }
+  uint64_t Instructions() const { return instructions_; }
+
+  // Attributes the gas of the following calls to their call paths.
+  void EnableProfiling() { profiling_ = true; }
+  std::vector<ProfileEntry> Profile() const;
+
+  // Checked access to linear memory for host functions.
+  uint8_t* Memory(uint32_t address, uint32_t size);
+  uint32_t MemorySize() const { return uint32_t(memory_.size()); }
+
+  // Grows memory by pages of 64 KiB; returns the old page count or -1.
+  int32_t GrowMemory(uint32_t pages);
+
+ private:
+  struct Function;
+  struct Label;
+  struct ProfileNode {
+    uint32_t parent;
+    uint32_t function;
+    uint64_t gas;
+    uint64_t instructions;
+  };
+
+  void Decode(const std::vector<uint8_t>& module,
+              const std::map<std::string, HostFunction>& imports);
+  void Execute(uint32_t index);
+  void Branch(std::vector<Label>& labels, uint32_t depth, size_t& pc);
+  uint64_t ConstExpr(const uint8_t*& p, const uint8_t* end);
+  void ReadNames(const std::vector<uint8_t>& payload);
+  uint32_t EnterProfileNode(uint32_t function);
+
+  std::vector<std::vector<uint8_t>> param_types_;
+  std::vector<std::vector<uint8_t>> result_types_;
+  std::vector<Function> functions_;
+  std::vector<uint64_t> globals_;
+  std::vector<uint32_t> table_;
+  std::vector<uint8_t> memory_;
+  uint32_t max_pages_ = 65536;
+  std::map<std::string, uint32_t> exports_;
+  std::vector<uint64_t> stack_;
+  const GasSchedule& schedule_;
+  uint64_t gas_limit_;
+  uint64_t gas_ = 0;
+  uint64_t instructions_ = 0;
+  unsigned depth_ = 0;
+  bool profiling_ = false;
+  // A call tree; node 0 is the root above the exported functions.
+  std::vector<ProfileNode> profile_ = {ProfileNode{0, UINT32_MAX, 0, 0}};
+  std::unordered_map<uint64_t, uint32_t> profile_children_;
+  uint32_t profile_node_ = 0;
+};
+
+}  // namespace native
+}  // namespace platon
@@ -0,0 +1,627 @@
+// platon-run: runs test contracts in a bundled wasm interpreter, against
+// libplaton-host-native, with gas metering per instruction and host call.
+// The costs come from -gas-schedule; without one the schedule is flat, one
+// per instruction and nothing for host calls, which reports as "flat" and
+// is not what the chain charges. Every contract runs in a child process of
+// its own, so the emulated chain of one never leaks into the next and
+// several run at once.
+//
+// -profile writes where each contract spent its gas as folded stacks, one
+// "outer;...;inner gas" line per call path, for flamegraph.pl or speedscope.
+// Frames are the demangled names of the name section that contracts linked
+// with -keep-names carry; tests/unit builds such copies in named/.
+//
+// Every TEST_CASE of tests/unit/unittest.hpp reports its assertions, gas,
+// instructions and storage imports. -filter picks the cases to run, -json
+// writes all results for scripts, and -isolate runs each case as a job of
+// its own: in a fresh instance and chain, in parallel with the others.
+
+#include <cxxabi.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platon/native/host.hpp"
+
+#include "Imports.h"
+#include "Interpreter.h"
+
+namespace fs = std::filesystem;
+using namespace platon::native;
+
+const std::string kRunName = "platon-run";
+
+struct Options {
+  unsigned jobs = 1;
+  uint64_t gas_limit = UINT64_MAX;
+  std::string gas_schedule;
+  std::string entry;
+  std::string trace_dir;
+  std::string profile_dir;
+  std::string filter;
+  std::string json;
+  bool isolate = false;
+  bool verbose = false;
+  std::vector<std::string> inputs;
+};
+
+struct Result {
+  std::string status = "CRASH";
+  uint64_t gas = 0;
+  uint64_t instructions = 0;
+  double ms = 0;
+  std::string detail;
+  std::vector<TestCase> cases;
+};
+
+// A contract, or with -isolate one test case of it.
+struct Job {
+  size_t module;
+  std::string test;
+};
+
+static void Usage() {
+  std::cerr << "usage: " << kRunName
+            << " [-j N] [-gas-limit N] [-gas-schedule file] [-entry name]"
+               " [-trace dir] [-profile dir] [-filter patterns] [-isolate]"
+               " [-json file] [-v] <file.wasm|dir>...\n"
+               "  -j N                run N contracts at once, 0 for one per "
+               "core (default 1)\n"
+               "  -gas-limit N        trap a contract after N gas\n"
+               "  -gas-schedule file  per-opcode and per-import costs, "
+               "\"0x10 5\" and\n"
+               "                      \"import setState 20000\" lines; the "
+               "flat default charges\n"
+               "                      1 per opcode and 0 per host call\n"
+               "  -entry name         export to call instead of main\n"
+               "  -trace dir          write the state I/O trace of contracts "
+               "built with\n"
+               "                      -DPLATON_TRACE to dir/<name>.trace\n"
+               "  -profile dir        write the gas of every call path to "
+               "dir/<name>.folded\n"
+               "  -filter patterns    run the test cases matching one of the "
+               "':' separated\n"
+               "                      globs, as in \"map.*:list.batch\"\n"
+               "  -isolate            run every test case in a process and "
+               "chain of its own\n"
+               "  -json file          write the contract and test case results "
+               "as JSON\n"
+               "  -v                  echo what the contracts print\n";
+}
+
+static bool ParseOptions(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "-j" && has_value) {
+      opts.jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "-gas-limit" && has_value) {
+      opts.gas_limit = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "-gas-schedule" && has_value) {
+      opts.gas_schedule = argv[++i];
+    } else if (arg == "-entry" && has_value) {
+      opts.entry = argv[++i];
+    } else if (arg == "-trace" && has_value) {
+      opts.trace_dir = argv[++i];
+    } else if (arg == "-profile" && has_value) {
+      opts.profile_dir = argv[++i];
+    } else if (arg == "-filter" && has_value) {
+      opts.filter = argv[++i];
+    } else if (arg == "-json" && has_value) {
+      opts.json = argv[++i];
+    } else if (arg == "-isolate") {
+      opts.isolate = true;
+    } else if (arg == "-v") {
+      opts.verbose = true;
+    } else if (!arg.empty() && arg[0] == '-') {
+      return false;
+    } else {
+      opts.inputs.push_back(arg);
+    }
+  }
+  if (opts.jobs == 0) {
+    opts.jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return !opts.inputs.empty();
+}
+
+// Expands directories to the .wasm files directly inside them.
+static std::vector<std::string> CollectModules(
+    const std::vector<std::string>& inputs) {
+  std::vector<std::string> modules;
+  for (const auto& input : inputs) {
+    std::error_code ec;
+    if (!fs::is_directory(input, ec)) {
+      modules.push_back(input);
+      continue;
+    }
+    std::vector<std::string> found;
+    for (const auto& entry : fs::directory_iterator(input, ec)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".wasm") {
+        found.push_back(entry.path().string());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    modules.insert(modules.end(), found.begin(), found.end());
+  }
+  return modules;
+}
+
+static std::string EntryPoint(const Instance& instance, const Options& opts) {
+  if (!opts.entry.empty()) {
+    return opts.entry;
+  }
+  for (const char* name : {"main", "__main_argc_argv", "_Z4mainiPPc"}) {
+    if (instance.HasExport(name)) {
+      return name;
+    }
+  }
+  throw Trap("no main export, pass -entry");
+}
+
+// Finds the "N tests, A assertions, F failures" line of unittest.hpp.
+static bool ParseSummary(const std::string& log, unsigned& tests,
+                         unsigned& assertions, unsigned& failures) {
+  size_t pos = log.rfind(" failures");
+  if (pos == std::string::npos) {
+    return false;
+  }
+  size_t start = log.rfind('\n', pos);
+  start = start == std::string::npos ? 0 : start + 1;
+  std::string line = log.substr(start, pos - start);
+  return std::sscanf(line.c_str(), "%u tests, %u assertions, %u", &tests,
+                     &assertions, &failures) == 3;
+}
+
+static std::string Demangle(const std::string& name) {
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr,
+                                        &status);
+  if (status != 0) {
+    return name;
+  }
+  std::string result = demangled;
+  std::free(demangled);
+  return result;
+}
+
+static void WriteProfile(const std::string& path, const Instance& instance) {
+  std::map<std::string, uint64_t> stacks;
+  for (const auto& entry : instance.Profile()) {
+    std::string stack;
+    for (const auto& frame : entry.stack) {
+      stack += (stack.empty() ? "" : ";") + Demangle(frame);
+    }
+    stacks[stack] += entry.gas;
+  }
+  std::ofstream out(path);
+  for (const auto& stack : stacks) {
+    out << stack.first << " " << stack.second << "\n";
+  }
+}
+
+static bool ReadModule(const std::string& path, std::vector<uint8_t>& bytes) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  bytes.assign(std::istreambuf_iterator<char>(in),
+               std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Runs the contract once with every test case turned down, to learn the
+// names of the cases -filter selects. False if it is no unittest contract.
+static bool ListCases(const std::string& path, const Options& opts,
+                      const GasSchedule& schedule,
+                      std::vector<std::string>& cases) {
+  std::vector<uint8_t> bytes;
+  if (!ReadModule(path, bytes)) {
+    return false;
+  }
+  Reset();
+  SetEcho(false);
+  bool harness = false;
+  SetTestFilter([&](const std::string& name) {
+    harness = true;
+    if (opts.filter.empty() || MatchTestFilter(opts.filter, name)) {
+      cases.push_back(name);
+    }
+    return false;
+  });
+  try {
+    Instance instance(bytes, HostImports(), schedule, opts.gas_limit);
+    if (instance.HasExport("__wasm_call_ctors")) {
+      instance.Call("__wasm_call_ctors", {});
+    }
+    std::string entry = EntryPoint(instance, opts);
+    instance.Call(entry, std::vector<uint64_t>(instance.ParamCount(entry), 0));
+  } catch (const Trap&) {
+    harness = false;
+  }
+  Reset();
+  return harness;
+}
+
+static Result RunModule(const std::string& path, const std::string& test,
+                        const Options& opts, const GasSchedule& schedule) {
+  Result result;
+  Reset();
+  SetEcho(opts.verbose);
+
+  std::vector<uint8_t> bytes;
+  if (!ReadModule(path, bytes)) {
+    result.status = "ERROR";
+    result.detail = "can't read " + path;
+    return result;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<Instance> instance;
+  if (!test.empty()) {
+    SetTestFilter([&](const std::string& name) { return name == test; });
+  } else if (!opts.filter.empty()) {
+    SetTestFilter([&](const std::string& name) {
+      return MatchTestFilter(opts.filter, name);
+    });
+  }
+  SetTestMeter([&](uint64_t& gas, uint64_t& instructions) {
+    gas = instance->GasUsed();
+    instructions = instance->Instructions();
+  });
+  try {
+    instance.reset(new Instance(bytes, HostImports(), schedule,
+                                opts.gas_limit));
+    if (!opts.profile_dir.empty()) {
+      instance->EnableProfiling();
+    }
+    if (instance->HasExport("__wasm_call_ctors")) {
+      instance->Call("__wasm_call_ctors", {});
+    }
+    std::string entry = EntryPoint(*instance, opts);
+    std::vector<uint64_t> args(instance->ParamCount(entry), 0);
+    instance->Call(entry, args);
+    unsigned tests = 0, assertions = 0, failures = 0;
+    if (ParseSummary(Log(), tests, assertions, failures)) {
+      result.status = failures == 0 ? "PASS" : "FAIL";
+      result.detail = std::to_string(tests) + " tests, " +
+                      std::to_string(assertions) + " assertions, " +
+                      std::to_string(failures) + " failures";
+    } else {
+      result.status = "PASS";
+    }
+  } catch (const Trap& e) {
+    result.status = "TRAP";
+    result.detail = e.what();
+  }
+  result.ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+  if (instance) {
+    result.gas = instance->GasUsed();
+    result.instructions = instance->Instructions();
+  }
+  result.cases = TestCases();
+  std::string stem = fs::path(path).stem().string();
+  if (!test.empty()) {
+    stem += "." + test;
+  }
+  if (instance && !opts.profile_dir.empty()) {
+    WriteProfile((fs::path(opts.profile_dir) / (stem + ".folded")).string(),
+                 *instance);
+  }
+  if (!opts.trace_dir.empty() && !Trace().empty()) {
+    std::ofstream out(fs::path(opts.trace_dir) / (stem + ".trace"),
+                      std::ios::binary);
+    out.write(reinterpret_cast<const char*>(Trace().data()), Trace().size());
+  }
+  return result;
+}
+
+// A result file: status, "gas instructions ms", detail, then a line per
+// test case.
+static void WriteResult(const std::string& path, const Result& result) {
+  std::ofstream out(path);
+  out << result.status << "\n"
+      << result.gas << " " << result.instructions << " " << result.ms << "\n"
+      << result.detail << "\n";
+  for (const auto& c : result.cases) {
+    out << c.name << " " << c.finished << " " << c.assertions << " "
+        << c.failures << " " << c.gas << " " << c.instructions << " " << c.ms
+        << " " << c.stats.set_state << " " << c.stats.get_state << " "
+        << c.stats.get_state_size << " " << c.stats.bytes_written << " "
+        << c.stats.bytes_read << " " << c.stats.events << "\n";
+  }
+}
+
+static Result ReadResult(const std::string& path) {
+  Result result;
+  std::ifstream in(path);
+  std::string numbers;
+  if (std::getline(in, result.status) && std::getline(in, numbers)) {
+    std::istringstream(numbers) >> result.gas >> result.instructions >>
+        result.ms;
+    std::getline(in, result.detail);
+  } else {
+    result.status = "CRASH";
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    TestCase c;
+    std::istringstream(line) >> c.name >> c.finished >> c.assertions >>
+        c.failures >> c.gas >> c.instructions >> c.ms >> c.stats.set_state >>
+        c.stats.get_state >> c.stats.get_state_size >>
+        c.stats.bytes_written >> c.stats.bytes_read >> c.stats.events;
+    result.cases.push_back(c);
+  }
+  return result;
+}
+
+// Folds the results of the isolated test cases of a contract into one.
+static Result MergeResults(const std::vector<Result>& parts) {
+  if (parts.size() == 1) {
+    return parts[0];
+  }
+  Result merged;
+  merged.status = "PASS";
+  uint64_t assertions = 0, failures = 0;
+  for (const auto& part : parts) {
+    if (merged.status == "PASS" && part.status != "PASS") {
+      merged.status = part.status;
+      merged.detail = part.cases.empty()
+                          ? part.detail
+                          : part.cases[0].name + ": " + part.detail;
+    }
+    merged.gas += part.gas;
+    merged.instructions += part.instructions;
+    merged.ms += part.ms;
+    for (const auto& c : part.cases) {
+      assertions += c.assertions;
+      failures += c.failures;
+    }
+    merged.cases.insert(merged.cases.end(), part.cases.begin(),
+                        part.cases.end());
+  }
+  if (merged.status == "PASS" || merged.status == "FAIL") {
+    merged.detail = std::to_string(merged.cases.size()) + " tests, " +
+                    std::to_string(assertions) + " assertions, " +
+                    std::to_string(failures) + " failures";
+  }
+  return merged;
+}
+
+static std::string CaseStatus(const TestCase& c) {
+  if (!c.finished) {
+    return "ABORT";
+  }
+  return c.failures == 0 ? "PASS" : "FAIL";
+}
+
+// Prints the contract, then those of its test cases that did not pass, all
+// of them with -v.
+static void PrintResult(const std::string& path, const Result& result,
+                        const Options& opts) {
+  char line[160];
+  std::snprintf(line, sizeof(line),
+                "%-5s %-28s %14llu gas %14llu instrs %9.1f ms",
+                result.status.c_str(), fs::path(path).stem().c_str(),
+                (unsigned long long)result.gas,
+                (unsigned long long)result.instructions, result.ms);
+  std::cout << line;
+  if (!result.detail.empty()) {
+    std::cout << "  " << result.detail;
+  }
+  std::cout << std::endl;
+  for (const auto& c : result.cases) {
+    std::string status = CaseStatus(c);
+    if (status == "PASS" && !opts.verbose) {
+      continue;
+    }
+    std::snprintf(line, sizeof(line),
+                  "  %-5s %-26s %14llu gas %14llu instrs %9.1f ms  "
+                  "%llu set, %llu get",
+                  status.c_str(), c.name.c_str(), (unsigned long long)c.gas,
+                  (unsigned long long)c.instructions, c.ms,
+                  (unsigned long long)c.stats.set_state,
+                  (unsigned long long)c.stats.get_state);
+    std::cout << line << std::endl;
+  }
+}
+
+static std::string JsonString(const std::string& text) {
+  std::string out = "\"";
+  for (char ch : text) {
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+      out += ch;
+    } else if (uint8_t(ch) < 0x20) {
+      char escape[8];
+      std::snprintf(escape, sizeof(escape), "\\u%04x", unsigned(ch));
+      out += escape;
+    } else {
+      out += ch;
+    }
+  }
+  return out + "\"";
+}
+
+// The gas schedule as results name it: its file, or "flat" for the default.
+static std::string ScheduleName(const Options& opts) {
+  return opts.gas_schedule.empty() ? "flat" : opts.gas_schedule;
+}
+
+static bool WriteJson(const std::string& path, const Options& opts,
+                      const std::vector<std::string>& modules,
+                      const std::vector<Result>& results) {
+  std::ofstream out(path);
+  out << "{\n  \"gas_schedule\": " << JsonString(ScheduleName(opts))
+      << ",\n  \"contracts\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    out << (i ? "," : "") << "\n    {\"name\": "
+        << JsonString(fs::path(modules[i]).stem().string())
+        << ", \"path\": " << JsonString(modules[i])
+        << ", \"status\": " << JsonString(r.status) << ", \"gas\": " << r.gas
+        << ", \"instructions\": " << r.instructions << ", \"ms\": " << r.ms
+        << ", \"detail\": " << JsonString(r.detail) << ",\n     \"cases\": [";
+    for (size_t j = 0; j < r.cases.size(); j++) {
+      const TestCase& c = r.cases[j];
+      out << (j ? "," : "") << "\n      {\"name\": " << JsonString(c.name)
+          << ", \"status\": " << JsonString(CaseStatus(c))
+          << ", \"assertions\": " << c.assertions
+          << ", \"failures\": " << c.failures << ", \"gas\": " << c.gas
+          << ", \"instructions\": " << c.instructions << ", \"ms\": " << c.ms
+          << ", \"set_state\": " << c.stats.set_state
+          << ", \"get_state\": " << c.stats.get_state
+          << ", \"get_state_size\": " << c.stats.get_state_size
+          << ", \"bytes_written\": " << c.stats.bytes_written
+          << ", \"bytes_read\": " << c.stats.bytes_read
+          << ", \"events\": " << c.stats.events << "}";
+    }
+    out << (r.cases.empty() ? "]}" : "\n     ]}");
+  }
+  out << "\n  ]\n}\n";
+  return bool(out);
+}
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!ParseOptions(argc, argv, opts)) {
+    Usage();
+    return -1;
+  }
+  GasSchedule schedule;
+  std::string error;
+  if (!opts.gas_schedule.empty() && !schedule.Load(opts.gas_schedule, error)) {
+    std::cerr << kRunName << ": " << error << "\n";
+    return -1;
+  }
+  for (const auto& dir : {opts.trace_dir, opts.profile_dir}) {
+    std::error_code ec;
+    if (!dir.empty() && !fs::create_directories(dir, ec) && ec) {
+      std::cerr << kRunName << ": can't create " << dir << "\n";
+      return -1;
+    }
+  }
+  std::vector<std::string> modules = CollectModules(opts.inputs);
+  if (modules.empty()) {
+    std::cerr << kRunName << ": no wasm modules found\n";
+    return -1;
+  }
+
+  std::vector<Job> jobs;
+  std::vector<size_t> pending(modules.size(), 0);
+  for (size_t i = 0; i < modules.size(); i++) {
+    std::vector<std::string> cases;
+    if (opts.isolate && ListCases(modules[i], opts, schedule, cases) &&
+        !cases.empty()) {
+      for (const auto& test : cases) {
+        jobs.push_back(Job{i, test});
+      }
+    } else {
+      jobs.push_back(Job{i, ""});
+    }
+  }
+  for (const auto& job : jobs) {
+    pending[job.module]++;
+  }
+
+  std::vector<Result> parts(jobs.size());
+  std::vector<Result> results(modules.size());
+  std::map<pid_t, size_t> running;
+  std::vector<std::string> outputs(jobs.size());
+  size_t next = 0;
+  while (next < jobs.size() || !running.empty()) {
+    if (next < jobs.size() && running.size() < opts.jobs) {
+      char temp[] = "/tmp/platon-run-XXXXXX";
+      int fd = mkstemp(temp);
+      if (fd < 0) {
+        std::cerr << kRunName << ": can't create a temporary file\n";
+        return -1;
+      }
+      close(fd);
+      outputs[next] = temp;
+      std::cout.flush();
+      pid_t pid = fork();
+      if (pid == 0) {
+        const Job& job = jobs[next];
+        WriteResult(temp,
+                    RunModule(modules[job.module], job.test, opts, schedule));
+        std::cout.flush();
+        _exit(0);
+      }
+      if (pid < 0) {
+        std::cerr << kRunName << ": fork failed\n";
+        return -1;
+      }
+      running[pid] = next++;
+      continue;
+    }
+    int status = 0;
+    pid_t pid = wait(&status);
+    auto it = running.find(pid);
+    if (it == running.end()) {
+      continue;
+    }
+    size_t index = it->second;
+    running.erase(it);
+    parts[index] = ReadResult(outputs[index]);
+    if (WIFSIGNALED(status)) {
+      parts[index].status = "CRASH";
+      parts[index].detail = strsignal(WTERMSIG(status));
+    }
+    if (!jobs[index].test.empty() && parts[index].cases.empty()) {
+      TestCase lost;
+      lost.name = jobs[index].test;
+      parts[index].cases.push_back(lost);
+    }
+    std::remove(outputs[index].c_str());
+    size_t module = jobs[index].module;
+    if (--pending[module] > 0) {
+      continue;
+    }
+    std::vector<Result> done;
+    for (size_t j = 0; j < jobs.size(); j++) {
+      if (jobs[j].module == module) {
+        done.push_back(parts[j]);
+      }
+    }
+    results[module] = MergeResults(done);
+    PrintResult(modules[module], results[module], opts);
+  }
+
+  size_t passed = 0, cases = 0, cases_passed = 0;
+  uint64_t gas = 0;
+  for (const auto& result : results) {
+    passed += result.status == "PASS";
+    gas += result.gas;
+    for (const auto& c : result.cases) {
+      cases++;
+      cases_passed += CaseStatus(c) == "PASS";
+    }
+  }
+  std::cout << "\n"
+            << passed << "/" << results.size() << " contracts passed, "
+            << cases_passed << "/" << cases << " test cases passed, " << gas
+            << " gas in total (" << ScheduleName(opts) << " schedule)\n";
+  if (!opts.json.empty() && !WriteJson(opts.json, opts, modules, results)) {
+    std::cerr << kRunName << ": can't write " << opts.json << "\n";
+    return -1;
+  }
+  return passed == results.size() ? 0 : 1;
+}
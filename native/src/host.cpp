@@ -0,0 +1,623 @@
+#include "platon/native/host.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <fnmatch.h>
+
+#include "rapidjson/document.h"
+
+#include "keccak.h"
+
+// The imports are weak so a test can still define one itself, as
+// tests/unit/dispatcher.cpp does for the call data.
+#define PLATON_IMPORT extern "C" __attribute__((weak))
+
+namespace platon {
+namespace native {
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+typedef std::array<uint8_t, 20> Address;
+typedef std::array<uint8_t, 32> Word;
+
+struct Environment {
+  int64_t gas_price = 0;
+  std::map<int64_t, Word> block_hashes;
+  uint64_t number = 0;
+  uint64_t gas_limit = 0;
+  int64_t timestamp = 0;
+  Address coinbase{};
+  Word balance{};
+  Address origin{};
+  Address caller{};
+  Word value{};
+  Address address{};
+  int64_t nonce = 0;
+  std::map<Address, Word> accounts;
+};
+
+struct Host {
+  std::map<Bytes, Bytes> state;
+  Environment env;
+  std::string log;
+  bool echo = true;
+  CallHandler call_handler;
+  std::string call_result;
+  HostStats stats;
+  Bytes trace;
+  TestFilter test_filter;
+  TestMeter test_meter;
+  std::vector<TestCase> test_cases;
+  // Counters when the running test case started.
+  HostStats case_stats;
+  uint64_t case_gas = 0;
+  uint64_t case_instructions = 0;
+  std::chrono::steady_clock::time_point case_start;
+};
+
+Host& GetHost() {
+  static Host host;
+  return host;
+}
+
+void Print(const char* data, size_t size) {
+  Host& host = GetHost();
+  host.log.append(data, size);
+  if (host.echo) {
+    std::fwrite(data, 1, size, stdout);
+  }
+}
+
+void Print(const std::string& text) { Print(text.data(), text.size()); }
+
+std::string Hex(const uint8_t* data, size_t size) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(2 * size);
+  for (size_t i = 0; i < size; i++) {
+    hex += digits[data[i] >> 4];
+    hex += digits[data[i] & 0xf];
+  }
+  return hex;
+}
+
+int HexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Parses "0x..." into the low bytes of out, big-endian.
+bool ParseHex(const std::string& text, uint8_t* out, size_t size) {
+  std::string hex = text.compare(0, 2, "0x") == 0 ? text.substr(2) : text;
+  if (hex.size() % 2 != 0 || hex.size() / 2 > size) {
+    return false;
+  }
+  std::memset(out, 0, size);
+  uint8_t* p = out + size - hex.size() / 2;
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    int hi = HexDigit(hex[i]), lo = HexDigit(hex[i + 1]);
+    if (hi < 0 || lo < 0) {
+      return false;
+    }
+    *p++ = uint8_t(hi << 4 | lo);
+  }
+  return true;
+}
+
+template <size_t N>
+bool ParseHex(const rapidjson::Value& value, std::array<uint8_t, N>& out) {
+  return value.IsString() && ParseHex(value.GetString(), out.data(), N);
+}
+
+// Amounts are JSON numbers, "0x" hex or decimal strings.
+bool ParseAmount(const rapidjson::Value& value, Word& out) {
+  out.fill(0);
+  if (value.IsUint64()) {
+    uint64_t v = value.GetUint64();
+    for (size_t i = 0; i < 8; i++) {
+      out[31 - i] = uint8_t(v >> (8 * i));
+    }
+    return true;
+  }
+  if (!value.IsString()) {
+    return false;
+  }
+  std::string text = value.GetString();
+  if (text.compare(0, 2, "0x") == 0) {
+    return ParseHex(text, out.data(), out.size());
+  }
+  for (char c : text) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    unsigned carry = c - '0';
+    for (size_t i = out.size(); i-- > 0;) {
+      carry += out[i] * 10u;
+      out[i] = uint8_t(carry);
+      carry >>= 8;
+    }
+  }
+  return true;
+}
+
+bool Less(const Word& a, const Word& b) {
+  return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+void Add(Word& a, const Word& b) {
+  unsigned carry = 0;
+  for (size_t i = a.size(); i-- > 0;) {
+    carry += a[i] + b[i];
+    a[i] = uint8_t(carry);
+    carry >>= 8;
+  }
+}
+
+void Sub(Word& a, const Word& b) {
+  int borrow = 0;
+  for (size_t i = a.size(); i-- > 0;) {
+    int d = int(a[i]) - b[i] - borrow;
+    borrow = d < 0;
+    a[i] = uint8_t(d + (borrow << 8));
+  }
+}
+
+Word& Balance(Host& host) {
+  auto it = host.env.accounts.find(host.env.address);
+  return it != host.env.accounts.end() ? it->second : host.env.balance;
+}
+
+std::string Decimal(unsigned __int128 value, bool negative) {
+  char digits[41];
+  char* p = digits + sizeof(digits);
+  do {
+    *--p = char('0' + unsigned(value % 10));
+    value /= 10;
+  } while (value != 0);
+  if (negative) {
+    *--p = '-';
+  }
+  return std::string(p, digits + sizeof(digits));
+}
+
+Bytes Call(const uint8_t* address, const uint8_t* args, uint32_t len,
+           bool delegate) {
+  Host& host = GetHost();
+  Print(Hex(address, 20) + " " + Hex(args, len));
+  if (!host.call_handler) {
+    return Bytes();
+  }
+  return host.call_handler(address, Bytes(args, args + len), delegate);
+}
+
+char* CallString(const uint8_t* address, const uint8_t* args, uint32_t len,
+                 bool delegate) {
+  Bytes result = Call(address, args, len, delegate);
+  std::string& out = GetHost().call_result;
+  out.assign(result.begin(), result.end());
+  return &out[0];
+}
+
+int64_t CallInt64(const uint8_t* address, const uint8_t* args, uint32_t len,
+                  bool delegate) {
+  Bytes result = Call(address, args, len, delegate);
+  uint64_t value = 0;
+  for (uint8_t byte : result) {
+    value = value << 8 | byte;
+  }
+  return int64_t(value);
+}
+
+}  // namespace
+
+void Reset() {
+  Host& host = GetHost();
+  bool echo = host.echo;
+  host = Host();
+  host.echo = echo;
+}
+
+bool SetEnvironment(const std::string& json) {
+  rapidjson::Document doc;
+  doc.Parse(json.data(), json.size());
+  if (doc.HasParseError() || !doc.IsObject()) {
+    return false;
+  }
+  Environment env;
+  bool ok = true;
+  for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
+    std::string name = it->name.GetString();
+    const rapidjson::Value& value = it->value;
+    if (name == "gasPrice") {
+      ok &= value.IsInt64() && (env.gas_price = value.GetInt64(), true);
+    } else if (name == "number") {
+      ok &= value.IsUint64() && (env.number = value.GetUint64(), true);
+    } else if (name == "gasLimit") {
+      ok &= value.IsUint64() && (env.gas_limit = value.GetUint64(), true);
+    } else if (name == "timestamp") {
+      ok &= value.IsInt64() && (env.timestamp = value.GetInt64(), true);
+    } else if (name == "nonce") {
+      ok &= value.IsInt64() && (env.nonce = value.GetInt64(), true);
+    } else if (name == "coinbase") {
+      ok &= ParseHex(value, env.coinbase);
+    } else if (name == "origin") {
+      ok &= ParseHex(value, env.origin);
+    } else if (name == "caller") {
+      ok &= ParseHex(value, env.caller);
+    } else if (name == "address") {
+      ok &= ParseHex(value, env.address);
+    } else if (name == "balance") {
+      ok &= ParseAmount(value, env.balance);
+    } else if (name == "value") {
+      ok &= ParseAmount(value, env.value);
+    } else if (name == "blockHash" && value.IsObject()) {
+      for (auto hash = value.MemberBegin(); hash != value.MemberEnd();
+           ++hash) {
+        Word word;
+        ok &= ParseHex(hash->value, word);
+        env.block_hashes[std::strtoll(hash->name.GetString(), nullptr, 10)] =
+            word;
+      }
+    } else if (name == "account" && value.IsObject()) {
+      for (auto account = value.MemberBegin(); account != value.MemberEnd();
+           ++account) {
+        Address address;
+        Word amount;
+        ok &= ParseHex(account->name, address) &&
+              ParseAmount(account->value, amount);
+        env.accounts[address] = amount;
+      }
+    }
+  }
+  if (ok) {
+    GetHost().env = env;
+  }
+  return ok;
+}
+
+const std::string& Log() { return GetHost().log; }
+
+void ClearLog() { GetHost().log.clear(); }
+
+void SetEcho(bool echo) { GetHost().echo = echo; }
+
+void SetCallHandler(CallHandler handler) {
+  GetHost().call_handler = std::move(handler);
+}
+
+size_t StateEntries() { return GetHost().state.size(); }
+
+const HostStats& Stats() { return GetHost().stats; }
+
+void ResetStats() { GetHost().stats = HostStats(); }
+
+const std::vector<uint8_t>& Trace() { return GetHost().trace; }
+
+void SetTestFilter(TestFilter filter) {
+  GetHost().test_filter = std::move(filter);
+}
+
+bool MatchTestFilter(const std::string& patterns, const std::string& name) {
+  size_t start = 0;
+  for (;;) {
+    size_t end = patterns.find(':', start);
+    std::string pattern = patterns.substr(start, end - start);
+    if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
+      return true;
+    }
+    if (end == std::string::npos) {
+      return false;
+    }
+    start = end + 1;
+  }
+}
+
+void SetTestMeter(TestMeter meter) { GetHost().test_meter = std::move(meter); }
+
+const std::vector<TestCase>& TestCases() { return GetHost().test_cases; }
+
+}  // namespace native
+}  // namespace platon
+
+using platon::native::GetHost;
+using platon::native::Host;
+using platon::native::Print;
+
+// storage.hpp
+
+PLATON_IMPORT void setState(const uint8_t* key, size_t klen,
+                            const uint8_t* value, size_t vlen) {
+  Host& host = GetHost();
+  host.stats.set_state++;
+  host.stats.bytes_written += klen + vlen;
+  platon::native::Bytes k(key, key + klen);
+  if (vlen == 0) {
+    host.state.erase(k);
+  } else {
+    host.state[k].assign(value, value + vlen);
+  }
+}
+
+PLATON_IMPORT size_t getStateSize(const uint8_t* key, size_t klen) {
+  Host& host = GetHost();
+  host.stats.get_state_size++;
+  auto it = host.state.find(platon::native::Bytes(key, key + klen));
+  return it == host.state.end() ? 0 : it->second.size();
+}
+
+PLATON_IMPORT void getState(const uint8_t* key, size_t klen, uint8_t* value,
+                            size_t vlen) {
+  Host& host = GetHost();
+  host.stats.get_state++;
+  auto it = host.state.find(platon::native::Bytes(key, key + klen));
+  if (it == host.state.end()) {
+    return;
+  }
+  size_t size = std::min(vlen, it->second.size());
+  std::memcpy(value, it->second.data(), size);
+  host.stats.bytes_read += size;
+}
+
+// event.hpp
+
+PLATON_IMPORT void emitEvent(const char* topic, size_t topicLen,
+                             const uint8_t* data, size_t dataLen) {
+  GetHost().stats.events++;
+  Print(std::string(topic, topicLen) + " " +
+        platon::native::Hex(data, dataLen));
+}
+
+// state.hpp
+
+PLATON_IMPORT int64_t gasPrice() { return GetHost().env.gas_price; }
+
+PLATON_IMPORT void blockHash(int64_t num, uint8_t hash[32]) {
+  const auto& hashes = GetHost().env.block_hashes;
+  auto it = hashes.find(num);
+  if (it == hashes.end()) {
+    std::memset(hash, 0, 32);
+  } else {
+    std::memcpy(hash, it->second.data(), 32);
+  }
+}
+
+PLATON_IMPORT uint64_t number() { return GetHost().env.number; }
+
+PLATON_IMPORT uint64_t gasLimit() { return GetHost().env.gas_limit; }
+
+PLATON_IMPORT int64_t timestamp() { return GetHost().env.timestamp; }
+
+PLATON_IMPORT void coinbase(uint8_t hash[20]) {
+  std::memcpy(hash, GetHost().env.coinbase.data(), 20);
+}
+
+PLATON_IMPORT void balance(uint8_t amount[32]) {
+  std::memcpy(amount, platon::native::Balance(GetHost()).data(), 32);
+}
+
+PLATON_IMPORT void origin(uint8_t hash[20]) {
+  std::memcpy(hash, GetHost().env.origin.data(), 20);
+}
+
+PLATON_IMPORT void caller(uint8_t hash[20]) {
+  std::memcpy(hash, GetHost().env.caller.data(), 20);
+}
+
+PLATON_IMPORT void callValue(uint8_t val[32]) {
+  std::memcpy(val, GetHost().env.value.data(), 32);
+}
+
+PLATON_IMPORT void address(uint8_t hash[20]) {
+  std::memcpy(hash, GetHost().env.address.data(), 20);
+}
+
+PLATON_IMPORT void sha3(const uint8_t* src, size_t srcLen, uint8_t* dest,
+                        size_t destLen) {
+  uint8_t digest[32];
+  platon::native::Keccak256(src, srcLen, digest);
+  std::memcpy(dest, digest, std::min(destLen, sizeof(digest)));
+}
+
+PLATON_IMPORT int64_t getCallerNonce() { return GetHost().env.nonce; }
+
+// Moves amount from the contract's account to `to`; -1 if it is short.
+PLATON_IMPORT int64_t callTransfer(const uint8_t* to, size_t toLen,
+                                   uint8_t amount[32]) {
+  Host& host = GetHost();
+  platon::native::Address target{};
+  std::memcpy(target.data(), to, std::min(toLen, target.size()));
+  platon::native::Word value;
+  std::memcpy(value.data(), amount, 32);
+  platon::native::Word& from = platon::native::Balance(host);
+  if (platon::native::Less(from, value)) {
+    return -1;
+  }
+  platon::native::Sub(from, value);
+  platon::native::Add(host.env.accounts[target], value);
+  return 0;
+}
+
+// deployedcontract.hpp
+
+PLATON_IMPORT char* platonCallString(const uint8_t* address,
+                                     const uint8_t* args, uint32_t len) {
+  return platon::native::CallString(address, args, len, false);
+}
+
+PLATON_IMPORT char* platonDelegateCallString(const uint8_t* address,
+                                             const uint8_t* args,
+                                             uint32_t len) {
+  return platon::native::CallString(address, args, len, true);
+}
+
+PLATON_IMPORT int64_t platonCallInt64(const uint8_t* address,
+                                      const uint8_t* args, uint32_t len) {
+  return platon::native::CallInt64(address, args, len, false);
+}
+
+PLATON_IMPORT int64_t platonDelegateCallInt64(const uint8_t* address,
+                                              const uint8_t* args,
+                                              uint32_t len) {
+  return platon::native::CallInt64(address, args, len, true);
+}
+
+PLATON_IMPORT void platonCall(const uint8_t* address, const uint8_t* args,
+                              uint32_t len) {
+  platon::native::Call(address, args, len, false);
+}
+
+PLATON_IMPORT void platonDelegateCall(const uint8_t* address,
+                                      const uint8_t* args, uint32_t len) {
+  platon::native::Call(address, args, len, true);
+}
+
+// common.h: the VM stops freeing contract memory after the call returns,
+// which has no native counterpart.
+PLATON_IMPORT void disable_free() {}
+
+// trace.hpp, only imported by contracts built with PLATON_TRACE.
+
+PLATON_IMPORT void platonTrace(const uint8_t* data, size_t len) {
+  GetHost().trace.insert(GetHost().trace.end(), data, data + len);
+}
+
+// tests/unit/unittest.hpp, imported by the test contracts only.
+
+PLATON_IMPORT int32_t platonTestBegin(const uint8_t* name, size_t len) {
+  Host& host = GetHost();
+  std::string test(reinterpret_cast<const char*>(name), len);
+  if (host.test_filter) {
+    if (!host.test_filter(test)) {
+      return 0;
+    }
+  } else if (const char* patterns = std::getenv("PLATON_TEST_FILTER")) {
+    if (!platon::native::MatchTestFilter(patterns, test)) {
+      return 0;
+    }
+  }
+  platon::native::TestCase test_case;
+  test_case.name = test;
+  host.test_cases.push_back(test_case);
+  host.case_stats = host.stats;
+  if (host.test_meter) {
+    host.test_meter(host.case_gas, host.case_instructions);
+  }
+  host.case_start = std::chrono::steady_clock::now();
+  return 1;
+}
+
+PLATON_IMPORT void platonTestEnd(uint32_t assertions, uint32_t failures) {
+  Host& host = GetHost();
+  if (host.test_cases.empty()) {
+    return;
+  }
+  platon::native::TestCase& test_case = host.test_cases.back();
+  test_case.finished = true;
+  test_case.assertions = assertions;
+  test_case.failures = failures;
+  test_case.ms = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - host.case_start)
+                     .count();
+  if (host.test_meter) {
+    host.test_meter(test_case.gas, test_case.instructions);
+    test_case.gas -= host.case_gas;
+    test_case.instructions -= host.case_instructions;
+  }
+  const platon::native::HostStats& now = host.stats;
+  const platon::native::HostStats& start = host.case_stats;
+  test_case.stats.set_state = now.set_state - start.set_state;
+  test_case.stats.get_state = now.get_state - start.get_state;
+  test_case.stats.get_state_size = now.get_state_size - start.get_state_size;
+  test_case.stats.bytes_written = now.bytes_written - start.bytes_written;
+  test_case.stats.bytes_read = now.bytes_read - start.bytes_read;
+  test_case.stats.events = now.events - start.events;
+}
+
+// print.h
+
+PLATON_IMPORT void prints(const char* cstr) { Print(cstr, std::strlen(cstr)); }
+
+PLATON_IMPORT void prints_l(const char* cstr, uint32_t len) {
+  Print(cstr, len);
+}
+
+PLATON_IMPORT void printi(int64_t value) {
+  Print(platon::native::Decimal(
+      value < 0 ? -(unsigned __int128)value : value, value < 0));
+}
+
+PLATON_IMPORT void printui(uint64_t value) {
+  Print(platon::native::Decimal(value, false));
+}
+
+PLATON_IMPORT void printi128(const __int128* value) {
+  __int128 v = *value;
+  Print(platon::native::Decimal(v < 0 ? -(unsigned __int128)v : v, v < 0));
+}
+
+PLATON_IMPORT void printui128(const unsigned __int128* value) {
+  Print(platon::native::Decimal(*value, false));
+}
+
+PLATON_IMPORT void printsf(float value) {
+  char text[32];
+  Print(text, std::snprintf(text, sizeof(text), "%.8g", value));
+}
+
+PLATON_IMPORT void printdf(double value) {
+  char text[32];
+  Print(text, std::snprintf(text, sizeof(text), "%.16g", value));
+}
+
+PLATON_IMPORT void printqf(const long double* value) {
+  char text[48];
+  Print(text, std::snprintf(text, sizeof(text), "%.18Lg", *value));
+}
+
+PLATON_IMPORT void printhex(const void* data, uint32_t datalen) {
+  Print(platon::native::Hex(static_cast<const uint8_t*>(data), datalen));
+}
+
+// The test-only imports of tests/unit: log.h, state.h and bigint.cpp.
+
+PLATON_IMPORT size_t getTestLogSize() { return GetHost().log.size(); }
+
+PLATON_IMPORT size_t getTestLog(char* log, size_t size) {
+  const std::string& text = GetHost().log;
+  size = std::min(size, text.size());
+  std::memcpy(log, text.data(), size);
+  return size;
+}
+
+PLATON_IMPORT void clearLog() { GetHost().log.clear(); }
+
+PLATON_IMPORT void setStateDB(const char* data, size_t len) {
+  platon::native::SetEnvironment(std::string(data, len));
+}
+
+// dst = src + 1, big-endian; dst grows by a byte on a carry out.
+PLATON_IMPORT void bigintAdd(const uint8_t* src, size_t src_len, uint8_t* dst,
+                             size_t& dst_len) {
+  std::vector<uint8_t> sum(src, src + src_len);
+  unsigned carry = 1;
+  for (size_t i = sum.size(); i-- > 0 && carry;) {
+    carry += sum[i];
+    sum[i] = uint8_t(carry);
+    carry >>= 8;
+  }
+  if (carry) {
+    sum.insert(sum.begin(), 1);
+  }
+  std::memcpy(dst, sum.data(), sum.size());
+  dst_len = sum.size();
+}
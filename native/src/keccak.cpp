@@ -0,0 +1,94 @@
+#include "keccak.h"
+
+#include <cstring>
+
+namespace platon {
+namespace native {
+
+namespace {
+
+const uint64_t kRoundConstants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+    0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+    0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+    0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+    0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+    0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+    0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+const unsigned kRotations[24] = {1,  3,  6,  10, 15, 21, 28, 36,
+                                 45, 55, 2,  14, 27, 41, 56, 8,
+                                 25, 43, 62, 18, 39, 61, 20, 44};
+
+const unsigned kLanes[24] = {10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+                             15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1};
+
+// Rate of Keccak-256 in bytes.
+const size_t kRate = 136;
+
+uint64_t Rotl(uint64_t x, unsigned n) { return (x << n) | (x >> (64 - n)); }
+
+void Permute(uint64_t state[25]) {
+  for (unsigned round = 0; round < 24; round++) {
+    uint64_t c[5];
+    for (unsigned x = 0; x < 5; x++) {
+      c[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^
+             state[x + 20];
+    }
+    for (unsigned x = 0; x < 5; x++) {
+      uint64_t d = c[(x + 4) % 5] ^ Rotl(c[(x + 1) % 5], 1);
+      for (unsigned y = 0; y < 25; y += 5) {
+        state[y + x] ^= d;
+      }
+    }
+
+    uint64_t current = state[1];
+    for (unsigned i = 0; i < 24; i++) {
+      uint64_t next = state[kLanes[i]];
+      state[kLanes[i]] = Rotl(current, kRotations[i]);
+      current = next;
+    }
+
+    for (unsigned y = 0; y < 25; y += 5) {
+      uint64_t row[5];
+      std::memcpy(row, state + y, sizeof(row));
+      for (unsigned x = 0; x < 5; x++) {
+        state[y + x] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
+      }
+    }
+
+    state[0] ^= kRoundConstants[round];
+  }
+}
+
+void Absorb(uint64_t state[25], const uint8_t* block) {
+  for (size_t i = 0; i < kRate / 8; i++) {
+    uint64_t lane = 0;
+    for (unsigned b = 0; b < 8; b++) {
+      lane |= uint64_t(block[8 * i + b]) << (8 * b);
+    }
+    state[i] ^= lane;
+  }
+  Permute(state);
+}
+
+}  // namespace
+
+void Keccak256(const uint8_t* data, size_t size, uint8_t digest[32]) {
+  uint64_t state[25] = {0};
+  for (; size >= kRate; data += kRate, size -= kRate) {
+    Absorb(state, data);
+  }
+  uint8_t last[kRate] = {0};
+  std::memcpy(last, data, size);
+  last[size] ^= 0x01;
+  last[kRate - 1] ^= 0x80;
+  Absorb(state, last);
+  for (unsigned i = 0; i < 32; i++) {
+    digest[i] = uint8_t(state[i / 8] >> (8 * (i % 8)));
+  }
+}
+
+}  // namespace native
+}  // namespace platon
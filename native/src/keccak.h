@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace platon {
+namespace native {
+
+// Keccak-256 as used by the chain's sha3 import: the original Keccak padding,
+// not the one of the final SHA3-256 standard.
+void Keccak256(const uint8_t* data, size_t size, uint8_t digest[32]);
+
+}  // namespace native
+}  // namespace platon
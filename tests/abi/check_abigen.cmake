@@ -0,0 +1,29 @@
+# Runs platon-abigen on SOURCE, one file or a list, and compares the generated
+# ABI with EXPECTED, ignoring whitespace.
+#
+#   cmake -DABIGEN=<platon-abigen> -DSOURCE=<file.cpp> -DEXPECTED=<file.abi.json>
+#         -DOUTPUT_DIR=<dir> [-DFLAGS=<abigen flags>] -P check_abigen.cmake
+
+list(GET SOURCE 0 first)
+get_filename_component(name ${first} NAME)
+set(output ${OUTPUT_DIR}/${name}.abi.json)
+file(REMOVE ${output})
+
+execute_process(
+  COMMAND ${ABIGEN} ${SOURCE} ${FLAGS}
+    -abigen_output=${output}
+    -exports_output=${OUTPUT_DIR}/${name}.exports
+    -verbose=false
+    -- -std=c++17 --target=wasm32 -w
+  RESULT_VARIABLE result)
+if (NOT result EQUAL 0 OR NOT EXISTS ${output})
+  message(FATAL_ERROR "platon-abigen failed on ${SOURCE}")
+endif()
+
+file(READ ${output} actual)
+file(READ ${EXPECTED} expected)
+string(REGEX REPLACE "[ \t\r\n]" "" actual "${actual}")
+string(REGEX REPLACE "[ \t\r\n]" "" expected "${expected}")
+if (NOT actual STREQUAL expected)
+  message(FATAL_ERROR "${output} differs from ${EXPECTED}")
+endif()
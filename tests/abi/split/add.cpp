@@ -0,0 +1,11 @@
+#include "registry.hpp"
+
+namespace demo {
+
+void Registry::add(uint64_t n) {
+  if (count_.get() + n > limit_.get()) return;
+  *count_ += n;
+  EVENTadded(n);
+}
+
+}  // namespace demo
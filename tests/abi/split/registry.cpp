@@ -0,0 +1,16 @@
+#include "registry.hpp"
+
+char kCount[] = "count";
+char kLimit[] = "limit";
+
+namespace demo {
+
+void Registry::init() { *limit_ = 100; }
+
+uint64_t Registry::count() const { return count_.get(); }
+
+}  // namespace demo
+
+PLATON_ABI(demo::Registry, init)
+PLATON_ABI(demo::Registry, add)
+PLATON_ABI(demo::Registry, count)
@@ -0,0 +1,41 @@
+// Contract shared by the two source files of the multi-file platon-abigen
+// test in tests/CMakeLists.txt.
+#pragma once
+
+#define PLATON_ABI(NAME, MEMBER)
+#define PLATON_EVENT(NAME, ...) void EVENT##NAME(__VA_ARGS__) {}
+
+typedef unsigned long long uint64_t;
+
+// Stand-in for platon::StorageType; abigen matches it by name.
+namespace platon {
+template <const char *Name, typename T>
+class StorageType {
+ public:
+  T get() const { return t_; }
+  T &operator*() { return t_; }
+
+ private:
+  T t_;
+};
+}  // namespace platon
+
+extern char kCount[];
+extern char kLimit[];
+
+namespace demo {
+
+class Registry {
+ public:
+  void init();
+  void add(uint64_t n);
+  uint64_t count() const;
+
+  PLATON_EVENT(added, uint64_t)
+
+ private:
+  platon::StorageType<kCount, uint64_t> count_;
+  platon::StorageType<kLimit, uint64_t> limit_;
+};
+
+}  // namespace demo
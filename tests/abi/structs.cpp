@@ -0,0 +1,90 @@
+// Input for the platon-abigen -dispatch test in tests/CMakeLists.txt: class
+// types in method signatures. The stand-ins mirror the target headers, which
+// abigen matches by name.
+
+#define PLATON_ABI(NAME, MEMBER)
+
+#define PLATON_REFLECT_FIELD(elem) f(t.elem);
+#define PLATON_SERIALIZE2(TYPE, A, B)            \
+  template <typename F>                          \
+  friend void platonForEachField(TYPE &t, F &&f) { \
+    PLATON_REFLECT_FIELD(A) PLATON_REFLECT_FIELD(B) \
+  }
+#define PLATON_SERIALIZE_DERIVED2(TYPE, BASE, A, B)        \
+  template <typename F>                                    \
+  friend void platonForEachField(TYPE &t, F &&f) {         \
+    platonForEachField(static_cast<BASE &>(t), f);         \
+    PLATON_REFLECT_FIELD(A) PLATON_REFLECT_FIELD(B)        \
+  }
+
+typedef long long int64_t;
+typedef unsigned char uint8_t;
+
+namespace std {
+template <typename T>
+class allocator {};
+template <typename C>
+class char_traits {};
+template <typename T>
+class less {};
+template <typename C, typename T = char_traits<C>, typename A = allocator<C>>
+class basic_string {};
+typedef basic_string<char> string;
+template <typename T, typename A = allocator<T>>
+class vector {};
+template <typename K, typename V, typename C = less<K>, typename A = allocator<V>>
+class map {};
+}  // namespace std
+
+namespace boost {
+namespace multiprecision {
+enum cpp_integer_type { signed_magnitude = 1, unsigned_magnitude = 0 };
+enum cpp_int_check_type { checked = 1, unchecked = 0 };
+template <unsigned MinBits, unsigned MaxBits, cpp_integer_type S,
+          cpp_int_check_type C, typename A>
+class cpp_int_backend {};
+template <typename Backend>
+class number {};
+}  // namespace multiprecision
+}  // namespace boost
+
+namespace platon {
+using u256 = boost::multiprecision::number<boost::multiprecision::cpp_int_backend<
+    256, 256, boost::multiprecision::unsigned_magnitude,
+    boost::multiprecision::unchecked, void>>;
+class uint256 {};
+template <unsigned N>
+class FixedHash {};
+using h256 = FixedHash<32>;
+using Address = FixedHash<20>;
+using bytes = std::vector<uint8_t>;
+}  // namespace platon
+
+namespace demo {
+
+struct Point {
+  int64_t x;
+  int64_t y;
+  PLATON_SERIALIZE2(Point, x, y)
+};
+
+struct Owner : Point {
+  platon::Address addr;
+  std::vector<Point> path;
+  PLATON_SERIALIZE_DERIVED2(Owner, Point, addr, path)
+};
+
+class Registry {
+ public:
+  void init() {}
+  void store(const Owner &owner, std::map<std::string, platon::u256> balances) {}
+  std::vector<Point> path(platon::Address who) const { return {}; }
+  platon::bytes raw(platon::uint256 v, const platon::h256 &h) { return {}; }
+};
+
+}  // namespace demo
+
+PLATON_ABI(demo::Registry, init)
+PLATON_ABI(demo::Registry, store)
+PLATON_ABI(demo::Registry, path)
+PLATON_ABI(demo::Registry, raw)
@@ -0,0 +1,67 @@
+// Input for the platon-abigen test in tests/CMakeLists.txt. The macros mirror
+// platon/contract.hpp and platon/event.hpp so no target headers are needed.
+
+#define PLATON_ABI(NAME, MEMBER)
+#define PLATON_EVENT(NAME, ...) void EVENT##NAME(__VA_ARGS__) {}
+
+#define ADDRESS const char *
+
+typedef unsigned long long uint64_t;
+typedef uint64_t Amount;
+
+// Stand-in for platon::StorageType; abigen matches it by name.
+namespace platon {
+template <const char *Name, typename T>
+class StorageType {
+ public:
+  T get() const { return t_; }
+  T &operator*() { return t_; }
+  template <typename P>
+  T &operator+=(const P &p) { return t_ += p; }
+
+ private:
+  T t_;
+};
+}  // namespace platon
+
+char kSupply[] = "supply";
+char kOwner[] = "owner";
+
+namespace demo {
+
+template <typename T, int N>
+struct Traits {
+  typedef T type;
+};
+
+class Token {
+ public:
+  void init() {
+    *owner = 1;
+    mint(10);
+  }
+  void transfer(ADDRESS to, Amount value) {
+    if (supply.get() < value) return;
+  }
+  Traits<unsigned int, 4>::type decimals() const { return 4; }
+  Amount balance(char owner[20]) const { return supply.get(); }
+
+  PLATON_EVENT(moved, /* from, to */ ADDRESS, const char *,
+               Amount)
+
+ private:
+  void mint(Amount value) { supply += value; }
+
+  platon::StorageType<kSupply, Amount> supply;
+  platon::StorageType<kOwner, uint64_t> owner;
+};
+
+}  // namespace demo
+
+PLATON_EVENT(created, demo::Traits<unsigned, 4>::type)
+
+PLATON_ABI(demo::Token, init)
+PLATON_ABI(demo::Token, transfer)
+PLATON_ABI(demo :: Token, decimals)
+PLATON_ABI(demo::Token,
+           /* getter */ balance)
@@ -0,0 +1,29 @@
+# Compiles SOURCE twice with the compilation cache enabled and checks that
+# the second build is served from the cache and yields the same bitcode.
+#
+#   cmake -DPLATON_CPP=<platon-cpp> -DSOURCE=<file.cpp> -DOUTPUT_DIR=<dir>
+#         -P check_cache.cmake
+
+set(cache_dir ${OUTPUT_DIR}/cache)
+file(REMOVE_RECURSE ${cache_dir})
+
+foreach(run 1 2)
+  execute_process(
+    COMMAND ${PLATON_CPP} -c ${SOURCE} -o ${OUTPUT_DIR}/cached.${run}.o
+      -cache -cache-dir=${cache_dir} -cache-stats
+    RESULT_VARIABLE result
+    ERROR_VARIABLE stats)
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "platon-cpp failed on ${SOURCE}: ${stats}")
+  endif()
+endforeach()
+
+if (NOT stats MATCHES "cache hits 1 misses 1 entries 1 ")
+  message(FATAL_ERROR "second build was not served from the cache: ${stats}")
+endif()
+
+file(SHA256 ${OUTPUT_DIR}/cached.1.o first)
+file(SHA256 ${OUTPUT_DIR}/cached.2.o second)
+if (NOT first STREQUAL second)
+  message(FATAL_ERROR "cached bitcode differs from the compiled one")
+endif()
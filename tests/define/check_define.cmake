@@ -0,0 +1,22 @@
+# Compiles SOURCE with and without -DPLATON_DEFINE_VALUE=42 and checks that
+# platon-cpp passes the macro on: SOURCE only compiles when it is defined.
+#
+#   cmake -DPLATON_CPP=<platon-cpp> -DSOURCE=<file.cpp> -DOUTPUT_DIR=<dir>
+#         -P check_define.cmake
+
+execute_process(
+  COMMAND ${PLATON_CPP} -DPLATON_DEFINE_VALUE=42 -c ${SOURCE}
+    -o ${OUTPUT_DIR}/define.o
+  RESULT_VARIABLE result
+  ERROR_VARIABLE errors)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "platon-cpp -D failed on ${SOURCE}: ${errors}")
+endif()
+
+execute_process(
+  COMMAND ${PLATON_CPP} -c ${SOURCE} -o ${OUTPUT_DIR}/undefined.o
+  RESULT_VARIABLE result
+  ERROR_VARIABLE errors)
+if (result EQUAL 0)
+  message(FATAL_ERROR "${SOURCE} compiled without -DPLATON_DEFINE_VALUE=42")
+endif()
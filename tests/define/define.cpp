@@ -0,0 +1,8 @@
+// Only compiles when platon-cpp passes -DPLATON_DEFINE_VALUE=42 on.
+#include "platon/platon.hpp"
+
+#if PLATON_DEFINE_VALUE != 42
+#error "PLATON_DEFINE_VALUE did not reach the compiler"
+#endif
+
+int main() { return 0; }
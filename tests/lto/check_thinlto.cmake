@@ -0,0 +1,51 @@
+# Links SOURCE with full LTO and twice with ThinLTO, and checks that the
+# ThinLTO module stays within 10% of the full LTO one and that the second
+# ThinLTO link reproduces the first from the LTO cache.
+#
+#   cmake -DPLATON_CPP=<platon-cpp> -DSOURCE=<file.cpp> -DOUTPUT_DIR=<dir>
+#         -P check_thinlto.cmake
+
+set(lto_cache_dir ${OUTPUT_DIR}/lto-cache)
+file(REMOVE_RECURSE ${lto_cache_dir})
+
+foreach(run full thin.1 thin.2)
+  set(flags)
+  if (run MATCHES "^thin")
+    set(flags -thinlto -lto-cache-dir=${lto_cache_dir})
+  endif()
+  execute_process(
+    COMMAND ${PLATON_CPP} -abigen ${SOURCE} -o ${OUTPUT_DIR}/lto.${run}.wasm
+      ${flags}
+    WORKING_DIRECTORY ${OUTPUT_DIR}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors)
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "platon-cpp ${flags} failed on ${SOURCE}: ${errors}")
+  endif()
+endforeach()
+
+file(GLOB cached ${lto_cache_dir}/*)
+if (NOT cached)
+  message(FATAL_ERROR "ThinLTO link left ${lto_cache_dir} empty")
+endif()
+
+function(wasm_size file out)
+  file(READ ${file} hex HEX)
+  string(LENGTH "${hex}" digits)
+  math(EXPR bytes "${digits} / 2")
+  set(${out} ${bytes} PARENT_SCOPE)
+endfunction()
+
+wasm_size(${OUTPUT_DIR}/lto.full.wasm full_size)
+wasm_size(${OUTPUT_DIR}/lto.thin.1.wasm thin_size)
+math(EXPR limit "${full_size} + ${full_size} / 10")
+message(STATUS "full LTO ${full_size} bytes, ThinLTO ${thin_size} bytes")
+if (thin_size GREATER limit)
+  message(FATAL_ERROR "ThinLTO output is more than 10% larger than full LTO")
+endif()
+
+file(SHA256 ${OUTPUT_DIR}/lto.thin.1.wasm first)
+file(SHA256 ${OUTPUT_DIR}/lto.thin.2.wasm second)
+if (NOT first STREQUAL second)
+  message(FATAL_ERROR "cached ThinLTO link differs from the first one")
+endif()
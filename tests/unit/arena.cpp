@@ -0,0 +1,84 @@
+#include "platon/heap.h"
+#include "unittest.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace platon;
+
+// Linked with -allocator=arena-freelist, see CMakeLists.txt.
+
+TEST_CASE(arena, malloc) {
+  platon_heap_stats before;
+  platon_get_heap_stats(&before);
+
+  void *a = malloc(10);
+  void *b = malloc(100);
+  ASSERT(a != nullptr && b != nullptr);
+  ASSERT(reinterpret_cast<uintptr_t>(a) % 16 == 0);
+  ASSERT(reinterpret_cast<uintptr_t>(b) % 16 == 0);
+
+  // a is not the last block: it goes to its free list and is reused.
+  free(a);
+  void *c = malloc(12);
+  ASSERT(c == a);
+
+  platon_heap_stats after;
+  platon_get_heap_stats(&after);
+  ASSERT_EQ(after.allocs - before.allocs, 3);
+  ASSERT_EQ(after.frees - before.frees, 1);
+  ASSERT_EQ(after.reused - before.reused, 1);
+  free(b);
+  free(c);
+}
+
+TEST_CASE(arena, realloc) {
+  char *p = static_cast<char *>(malloc(4));
+  uintptr_t old = reinterpret_cast<uintptr_t>(p);
+  memcpy(p, "abc", 4);
+  // The newest block grows in place.
+  char *q = static_cast<char *>(realloc(p, 4096));
+  ASSERT(reinterpret_cast<uintptr_t>(q) == old);
+  ASSERT(strcmp(q, "abc") == 0);
+
+  // Once another block follows it has to move, keeping its contents.
+  char *r = static_cast<char *>(malloc(2048));
+  char *s = static_cast<char *>(realloc(q, 8192));
+  ASSERT(strcmp(s, "abc") == 0);
+  free(r);
+  free(s);
+
+  int *z = static_cast<int *>(calloc(16, sizeof(int)));
+  for (int i = 0; i < 16; i++) ASSERT_EQ(z[i], 0);
+  free(z);
+}
+
+TEST_CASE(arena, containers) {
+  platon_heap_stats before;
+  platon_get_heap_stats(&before);
+  {
+    std::vector<std::string> v;
+    std::map<int, std::string> m;
+    for (int i = 0; i < 100; i++) {
+      v.push_back(std::string(40, 'a' + i % 26));
+      m[i] = v.back();
+    }
+    ASSERT_EQ(m[42], v[42]);
+  }
+  platon_heap_stats after;
+  platon_get_heap_stats(&after);
+  ASSERT(after.allocs > before.allocs);
+  ASSERT_EQ(after.allocs - before.allocs, after.frees - before.frees);
+  ASSERT_EQ(after.in_use, before.in_use);
+  ASSERT(after.peak >= before.peak);
+}
+
+UNITTEST_MAIN() {
+  RUN_TEST(arena, malloc);
+  RUN_TEST(arena, realloc);
+  RUN_TEST(arena, containers);
+}
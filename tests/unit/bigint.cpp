@@ -148,6 +148,46 @@ TEST_CASE(bigint, operator) {
   ASSERT(i * 2 == 200);
 }
 
+TEST_CASE(bigint, decimal) {
+  ASSERT(toString(u256(0)) == "0");
+  ASSERT(toString(std::numeric_limits<u256>::max()) ==
+         std::numeric_limits<u256>::max().convert_to<std::string>());
+  ASSERT(toString(std::numeric_limits<u512>::max()) ==
+         std::numeric_limits<u512>::max().convert_to<std::string>());
+
+  u256 v;
+  ASSERT(fromString(std::numeric_limits<u256>::max().convert_to<std::string>(), v));
+  ASSERT(v == std::numeric_limits<u256>::max());
+  ASSERT(!fromString(std::string("115792089237316195423570985008687907853269984665640564039457584007913129639936"), v));
+  ASSERT(!fromString(std::string(""), v));
+  ASSERT(!fromString(std::string("12a"), v));
+  u160 v160;
+  ASSERT(!fromString((u512(1) << 160).convert_to<std::string>(), v160));
+
+  // xorshift64, random widths so that every limb count is covered
+  uint64_t seed = 88172645463325252ULL;
+  auto next = [&seed]() {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+  };
+  for (int i = 0; i < 200; ++i) {
+    u512 r = 0;
+    for (int j = 0; j < 8; ++j) r = (r << 64) | next();
+    r >>= next() % 512;
+    std::string expect = r.convert_to<std::string>();
+    ASSERT(toString(r) == expect, expect);
+    u512 back;
+    ASSERT(fromString(expect, back) && back == r, expect);
+
+    u256 r256 = u256(r);
+    expect = r256.convert_to<std::string>();
+    ASSERT(toString(r256) == expect, expect);
+    ASSERT(fromString(expect, v) && v == r256, expect);
+  }
+}
+
 UNITTEST_MAIN() {
   RUN_TEST(bigint, bigintAdd);
   RUN_TEST(bigint, u64Add);
@@ -158,4 +198,5 @@ UNITTEST_MAIN() {
   RUN_TEST(bigint, u64Overflow);
   RUN_TEST(bigint, convertStr);
   RUN_TEST(bigint, operator);
+  RUN_TEST(bigint, decimal);
 }
@@ -0,0 +1,119 @@
+#include "platon/dispatcher.hpp"
+#include "platon/serialize.hpp"
+#include "platon/txencode.hpp"
+#include "unittest.hpp"
+
+using namespace platon;
+
+namespace demo {
+struct Point {
+  int64_t x;
+  int64_t y;
+  PLATON_SERIALIZE(Point, (x)(y))
+};
+
+struct Owner : Point {
+  Address addr;
+  std::vector<Point> path;
+  PLATON_SERIALIZE_DERIVED(Owner, Point, (addr)(path))
+};
+}  // namespace demo
+
+// The call data the VM passes to invoke.
+template <typename... Args>
+std::string callData(const std::string &method, Args &&... args) {
+  RLPStream stream(sizeof...(args) + 2);
+  txEncode(stream, int64_t(9), method, args...);
+  return toHex(stream.out());
+}
+
+TEST_CASE(dispatcher, selector) {
+  static_assert(methodSelector("") == 2166136261u, "fnv-1a offset basis");
+  static_assert(methodSelector("a") == 0xe40c292cu, "fnv-1a of \"a\"");
+  ASSERT(methodSelector("init") != methodSelector("inir"));
+
+  std::string input = callData("transfer");
+  Dispatcher d(input.c_str());
+  int hit = 0;
+  switch (d.selector()) {
+    case methodSelector("init"):
+      hit = 1;
+      break;
+    case methodSelector("transfer"):
+      hit = d.is("transfer") ? 2 : 0;
+      break;
+  }
+  ASSERT_EQ(hit, 2);
+  ASSERT(!d.is("transfe"));
+  ASSERT(!d.is("transfers"));
+}
+
+TEST_CASE(dispatcher, args) {
+  std::string input =
+      callData("transfer", "abc", uint64_t(42), int32_t(-5), uint16_t(0xbeef));
+  Dispatcher d(input.c_str());
+  ASSERT_EQ(d.argCount(), 4);
+  ASSERT(d.arg<std::string>(0) == "abc");
+  ASSERT(d.arg<uint64_t>(1) == 42);
+  ASSERT_EQ(d.arg<int32_t>(2), -5);
+  ASSERT(d.arg<uint16_t>(3) == 0xbeef);
+  // Narrower encodings are zero extended.
+  ASSERT(d.arg<uint64_t>(3) == 0xbeef);
+}
+
+TEST_CASE(dispatcher, ret) {
+  std::string input = callData("get");
+  Dispatcher d(input.c_str());
+  ASSERT(d.output().empty());
+  d.ret(uint32_t(0x01020304));
+  ASSERT(d.output() == "01020304", d.output());
+  d.ret(int16_t(-2));
+  ASSERT(d.output() == "fffe", d.output());
+  d.ret(1.0);
+  ASSERT(d.output() == "3ff0000000000000", d.output());
+  d.ret("hi");
+  ASSERT(d.output() == "6869", d.output());
+  ASSERT(std::string(d.result()) == "6869");
+}
+
+TEST_CASE(dispatcher, structured) {
+  demo::Owner owner;
+  owner.x = -1;
+  owner.y = 2;
+  owner.addr = Address("00000000000000000000000000000000000000ff");
+  owner.path = {demo::Point{3, 4}, demo::Point{5, 6}};
+  std::map<std::string, u256> balances = {{"a", u256(1) << 200}, {"b", 7}};
+  bytes raw = {1, 2, 3};
+  std::string input = callData("store", owner, balances, raw, uint256(9), h256(5));
+  Dispatcher d(input.c_str());
+  ASSERT_EQ(d.argCount(), 5);
+
+  demo::Owner o = d.arg<demo::Owner>(0);
+  ASSERT(o.x == -1 && o.y == 2);
+  ASSERT(o.addr == owner.addr);
+  ASSERT_EQ(o.path.size(), 2);
+  ASSERT(o.path[1].x == 5 && o.path[1].y == 6);
+
+  std::map<std::string, u256> m = d.arg<std::map<std::string, u256>>(1);
+  ASSERT(m == balances);
+  ASSERT(d.arg<bytes>(2) == raw);
+  ASSERT(d.arg<uint256>(3) == uint256(9));
+  ASSERT(d.arg<h256>(4) == h256(5));
+
+  d.ret(owner.addr);
+  ASSERT(d.output() == "00000000000000000000000000000000000000ff",
+         d.output());
+  d.ret(std::string("hi"));
+  ASSERT(d.output() == "6869", d.output());
+  d.ret(owner.path);
+  bytes output = fromHex(d.output());
+  ASSERT_EQ(RLP(output).itemCount(), 2);
+  ASSERT(txDecode<std::vector<demo::Point>>(RLP(output))[0].y == 4);
+}
+
+UNITTEST_MAIN() {
+  RUN_TEST(dispatcher, selector)
+  RUN_TEST(dispatcher, args)
+  RUN_TEST(dispatcher, ret)
+  RUN_TEST(dispatcher, structured)
+}
@@ -221,6 +221,21 @@ TEST_CASE(test, print){
         ASSERT(test::getLog() == "false");
     }
 
+    {
+        LOG_TEST logTest;
+        u256 u = std::numeric_limits<unsigned __int128>::max();
+        println("a", -1, true, std::string("b"), u, FixedHash<2>("beef"));
+        ASSERT(test::getLog() == "a -1 true b 340282366920938463463374607431768211455 beef\n");
+
+        logTest = LOG_TEST();
+        print_f("x=% y=%", 7, "z");
+        ASSERT(test::getLog() == "x=7 y=z");
+
+        logTest = LOG_TEST();
+        println("f", 0.5, 1);
+        ASSERT(test::getLog() == "f 0.5 1\n");
+    }
+
 }
 
 UNITTEST_MAIN() {
@@ -28,6 +28,97 @@ SET_GET(uint64_t, uint64_t, 1)
 SET_GET(int64_t, int64_t, 1)
 SET_GET(string, std::string, "hello")
 
+char sLazy[] = "lazy";
+TEST_CASE(Lazy, flush) {
+  // With LazyDefault, values that are only read, or never touched, are not
+  // written back.
+  { platon::StorageType<sLazy, int64_t, true> v(5); }
+  {
+    platon::StorageType<sLazy, int64_t, true> v(7);
+    ASSERT(v == 7);
+  }
+  {
+    platon::StorageType<sLazy, int64_t, true> v(9);
+    ASSERT(v.get() == 9);
+    v += 1;
+  }
+  platon::StorageType<sLazy, int64_t, true> v(0);
+  ASSERT(v == 10);
+}
+
+char sDefault[] = "default";
+char sUntouched[] = "untouched";
+char sLazyDefault[] = "lazydefault";
+TEST_CASE(Default, persist) {
+  // A default is persisted by default, even if the value is never used.
+  int64_t stored = 0;
+  {
+    platon::StorageType<sDefault, int64_t> v(5);
+    ASSERT(v == 5);
+  }
+  ASSERT(platon::getState(std::string(sDefault), stored) != 0);
+  ASSERT(stored == 5);
+  { platon::StorageType<sDefault, int64_t> v(6); }
+  ASSERT(platon::getState(std::string(sDefault), stored) != 0);
+  ASSERT(stored == 5);
+  { platon::StorageType<sUntouched, int64_t> v(7); }
+  ASSERT(platon::getState(std::string(sUntouched), stored) != 0);
+  ASSERT(stored == 7);
+
+  // With LazyDefault it only stands in for a missing entry until the value
+  // changes.
+  {
+    platon::StorageType<sLazyDefault, int64_t, true> v(5);
+    ASSERT(v == 5);
+  }
+  ASSERT(platon::getState(std::string(sLazyDefault), stored) == 0);
+  { platon::StorageType<sLazyDefault, int64_t, true> v(5); v += 0; }
+  ASSERT(platon::getState(std::string(sLazyDefault), stored) != 0);
+  ASSERT(stored == 5);
+}
+
+char sOperators[] = "operators";
+TEST_CASE(Operators, compare_shift) {
+  platon::StorageType<sOperators, uint32_t> v(6);
+  ASSERT(v != 7);
+  ASSERT(!(v != 6));
+  ASSERT((v << 2) == 24);
+  ASSERT((v >> 1) == 3);
+  ASSERT(v == 6);
+  v <<= 3;
+  ASSERT(v == 48);
+  v >>= 4;
+  ASSERT(v == 3);
+  ASSERT(v++ == 3);
+  ASSERT(v == 4);
+}
+
+char sReadOnly[] = "readonly";
+// Leaves read-only mode again, so the cases after this one can write.
+struct ReadOnlyScope {
+  ReadOnlyScope() { platon::enterReadOnlyMode(); }
+  ~ReadOnlyScope() { platon::detail::readOnlyMode() = false; }
+};
+
+TEST_CASE(ReadOnly, flush) {
+  {
+    platon::StorageType<sReadOnly, int64_t> v(1);
+    v += 1;
+  }
+  {
+    ReadOnlyScope scope;
+    ASSERT(platon::isReadOnlyMode());
+    platon::StorageType<sReadOnly, int64_t> v(1);
+    ASSERT(v == 2);
+    ASSERT(v.get() == 2);
+    // Non-const references are reads here; the change is not written back.
+    *v = 7;
+  }
+  ASSERT(!platon::isReadOnlyMode());
+  platon::StorageType<sReadOnly, int64_t> v(1);
+  ASSERT(v == 2);
+}
+
 UNITTEST_MAIN() {
   RUN_TEST(SetGet, uint8_t)
   RUN_TEST(SetGet, int8_t)
@@ -38,4 +129,8 @@ UNITTEST_MAIN() {
   RUN_TEST(SetGet, uint64_t)
   RUN_TEST(SetGet, int64_t)
   RUN_TEST(SetGet, string)
+  RUN_TEST(Lazy, flush)
+  RUN_TEST(ReadOnly, flush)
+  RUN_TEST(Default, persist)
+  RUN_TEST(Operators, compare_shift)
 }
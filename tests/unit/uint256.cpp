@@ -0,0 +1,101 @@
+#include "platon/uint256.hpp"
+#include "unittest.hpp"
+
+using namespace platon;
+
+TEST_CASE(uint256, convert) {
+  u256 max = std::numeric_limits<u256>::max();
+  ASSERT(uint256(max) == uint256::max());
+  ASSERT(uint256::max().toU256() == max);
+
+  u256 v = 1234567890;
+  v <<= 130;
+  v += 987654321;
+  ASSERT(uint256(v).toU256() == v);
+  ASSERT(uint256(u256(0)).isZero());
+
+  bytes bs(32);
+  uint256(v).toBigEndian(bs.data());
+  ASSERT(fromBigEndian<u256>(bs) == v);
+  ASSERT(uint256::fromBigEndian(bs.data(), bs.size()) == uint256(v));
+}
+
+TEST_CASE(uint256, addsub) {
+  uint256 res;
+  ASSERT(!uint256::addOverflow(uint256(1), uint256(2), res));
+  ASSERT(res == 3);
+  ASSERT(uint256::addOverflow(uint256::max(), uint256(1), res));
+  ASSERT(res.isZero());
+
+  ASSERT(!uint256::subOverflow(uint256(5), uint256(3), res));
+  ASSERT(res == 2);
+  ASSERT(uint256::subOverflow(uint256(0), uint256(1), res));
+  ASSERT(res == uint256::max());
+
+  uint256 carry(0, 0, 0, ~uint64_t(0));
+  ++carry;
+  ASSERT(carry == uint256(0, 0, 1, 0));
+  --carry;
+  ASSERT(carry == uint256(0, 0, 0, ~uint64_t(0)));
+}
+
+TEST_CASE(uint256, mul) {
+  uint256 res;
+  uint256 a(0, 0, 1, 0);
+  ASSERT(!uint256::mulOverflow(a, a, res));
+  ASSERT(res == uint256(0, 1, 0, 0));
+  ASSERT(uint256::mulOverflow(uint256(uint64_t(1) << 63, 0, 0, 0), uint256(2), res));
+  ASSERT(res.isZero());
+
+  u256 x = 0xfedcba9876543210;
+  x = x * x * 12345;
+  u256 y = 0x123456789abcdef;
+  ASSERT((uint256(x) * uint256(y)).toU256() == u256(x * y));
+}
+
+TEST_CASE(uint256, div) {
+  u256 x = 0xfedcba9876543210;
+  x = x * x * x * 7;
+  uint64_t rem = 0;
+  uint256 q = uint256(x).divMod(10000000000000000000ULL, rem);
+  ASSERT(q.toU256() == x / 10000000000000000000ULL);
+  ASSERT(rem == uint64_t(x % 10000000000000000000ULL));
+
+  u256 y = 0x123456789abcdef;
+  y = y * y;
+  uint256 r;
+  q = uint256(x).divMod(uint256(y), r);
+  ASSERT(q.toU256() == x / y);
+  ASSERT(r.toU256() == x % y);
+  ASSERT((uint256(x) / uint256(y)).toU256() == x / y);
+  ASSERT((uint256(x) % uint256(y)).toU256() == x % y);
+}
+
+TEST_CASE(uint256, shift) {
+  uint256 one(1);
+  ASSERT((one << 255) == uint256(uint64_t(1) << 63, 0, 0, 0));
+  ASSERT(((one << 255) >> 255) == one);
+  ASSERT((one << 256).isZero());
+  ASSERT((one << 100).bits() == 101);
+  ASSERT(uint256(0).bits() == 0);
+}
+
+TEST_CASE(uint256, compare) {
+  uint256 a(0, 1, 0, 0);
+  uint256 b(0, 0, ~uint64_t(0), ~uint64_t(0));
+  ASSERT(b < a);
+  ASSERT(a > b);
+  ASSERT(a >= a);
+  ASSERT(b <= a);
+  ASSERT(a != b);
+  static_assert(uint256(2) * uint256(3) == uint256(6), "constexpr");
+}
+
+UNITTEST_MAIN() {
+  RUN_TEST(uint256, convert);
+  RUN_TEST(uint256, addsub);
+  RUN_TEST(uint256, mul);
+  RUN_TEST(uint256, div);
+  RUN_TEST(uint256, shift);
+  RUN_TEST(uint256, compare);
+}
@@ -1,9 +1,25 @@
 //
 // Created by zhou.yang on 2018/11/21.
 //
+#include <stdint.h>
 #include <vector>
 #include "platon/print.hpp"
 
+// Provided by the test hosts, platon-run and libplaton-host-native: whether
+// the case runs, and its results. The host meters each case and picks the
+// cases to run, one per process when it isolates them. Builds for those
+// hosts define PLATON_TEST_HOST; elsewhere, as on a chain VM that has no
+// such imports, every case runs and nothing is reported.
+#ifdef PLATON_TEST_HOST
+extern "C" {
+int32_t platonTestBegin(const uint8_t *name, size_t len);
+void platonTestEnd(uint32_t assertions, uint32_t failures);
+}
+#else
+inline int32_t platonTestBegin(const uint8_t *, size_t) { return 1; }
+inline void platonTestEnd(uint32_t, uint32_t) {}
+#endif
+
 struct TestResult {
   size_t testcases = 0;
   size_t assertions = 0;
@@ -28,10 +44,20 @@ struct TestResult {
   };                                                  \
   void testGroup##testName##Test::run()
 
-#define RUN_TEST(testName, testGroup)                       \
-  testGroup##testName##Test testGroup##testName##Instance = \
-      testGroup##testName##Test(testResult);                \
-  testGroup##testName##Instance.run();
+#define RUN_TEST(testName, testGroup)                                    \
+  {                                                                      \
+    if (platonTestBegin(                                                 \
+            reinterpret_cast<const uint8_t *>(#testName "." #testGroup), \
+            sizeof(#testName "." #testGroup) - 1)) {                     \
+      size_t assertions = testResult.assertions;                         \
+      size_t failures = testResult.failures;                             \
+      testGroup##testName##Test testGroup##testName##Instance =          \
+          testGroup##testName##Test(testResult);                         \
+      testGroup##testName##Instance.run();                               \
+      platonTestEnd(testResult.assertions - assertions,                  \
+                    testResult.failures - failures);                     \
+    }                                                                    \
+  }
 
 #define ASSERT(cond, ...)                                            \
   if (!testResult_.skip) {                                           \
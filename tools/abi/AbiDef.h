@@ -3,6 +3,14 @@
 #include <vector>
 
 namespace platon {
+    // ABI type of a value; tuples, tuple arrays and maps list their members
+    // in components.
+    struct AbiComponent {
+        std::string name;
+        std::string type;
+        std::vector<AbiComponent> components;
+    };
+
     struct TypdeDef {
         TypdeDef() = default;
         TypdeDef(std::string typeName, std::string realTypeName)
@@ -10,6 +18,11 @@ namespace platon {
 
         std::string typeName;
         std::string realTypeName;
+        std::string abiType;
+        std::vector<AbiComponent> components;
+        // Class types such as std::vector or PLATON_SERIALIZE structs, which
+        // are passed RLP encoded and need -dispatch.
+        bool structured = false;
     };
 
     struct ABI {
@@ -18,6 +31,9 @@ namespace platon {
         std::vector<TypdeDef> types;
         TypdeDef returnType;
         bool isConst = false;
+        // Storage members the method reads only, and those it may modify.
+        std::vector<std::string> storageReads;
+        std::vector<std::string> storageWrites;
     };
 
     struct ABIDef {
@@ -26,7 +42,12 @@ namespace platon {
 
     struct Event {
         std::string name;
+        // Argument spellings from the PLATON_EVENT expansion.
+        std::vector<std::string> params;
+        // ABI type of each argument, resolved from the generated event function.
         std::vector<std::string> args;
+        // Set once a source file declares the event function.
+        bool resolved = false;
     };
     struct EventDef {
         std::vector<Event> events;
@@ -35,6 +56,9 @@ namespace platon {
     struct ContractDef{
         std::string fullName;
         std::string name;
+        // Source file with the PLATON_ABI declarations, which receives the
+        // generated entry points.
+        std::string sourceFile;
         EventDef eventDef;
     };
 }
@@ -1,8 +1,9 @@
 #include <algorithm>
-#include <regex>
+#include <set>
 #include "AbiGenerator.h"
 #include "Exception.h"
-#include "Common.h"
+#include "AbiType.h"
+#include "StorageAccess.h"
 #include "Log.h"
 using namespace std;
 namespace cl = llvm::cl;
@@ -14,14 +15,6 @@ namespace platon {
 
 
 
-    static string convertBuildinType(const string &typeName){
-        regex r(R"(char\s*\[\d+\])");
-        smatch smatch;
-        if (regex_search(typeName, smatch, r)) {
-           return "char *";
-        }
-        return typeName;
-    }
     void ABIGenerator::getRealName(clang::QualType &type, clang::ASTContext* astContext, std::string &typeName, std::string &realTypeName) {
         if (isa<TypedefType>(type.getTypePtr())) {
             const auto* tdDecl = type->getAs<clang::TypedefType>()->getDecl();
@@ -38,20 +31,68 @@ namespace platon {
             if (isa<TypedefType>(underlyingType.getTypePtr())){
                 LOGDEBUG << "get typename again type:" << typeName << " realTypeName:" << realTypeName;
                 getRealName(underlyingType, astContext, typeName, realTypeName);
+            } else if (isCharArray(underlyingType)) {
+                realTypeName = "char *";
             } else {
                 auto qtType = clang::TypeName::getFullyQualifiedType(underlyingType, *astContext);
-                realTypeName = convertBuildinType(qtType.getAsString());
+                realTypeName = qtType.getAsString();
             }
 
+        } else if (isCharArray(type)) {
+            realTypeName = "char *";
         } else {
             auto qtType = clang::TypeName::getFullyQualifiedType(type, *astContext);
-            realTypeName = convertBuildinType(qtType.getAsString());
+            realTypeName = qtType.getAsString();
         }
         LOGDEBUG << "typeName:" << typeName << "  realTypeName:" << realTypeName;
     }
 
+    // Scalars and char * keep their spelling. Class types are decoded by value
+    // in the dispatcher, so they drop const to name the decoded type.
+    bool ABIGenerator::describeType(clang::QualType type, clang::ASTContext* astContext, TypdeDef &def, bool isReturn) {
+        def.abiType = abiTypeName(type, *astContext);
+        if (def.abiType == "void") {
+            getRealName(type, astContext, def.typeName, def.realTypeName);
+            return isReturn;
+        }
+        if (!def.abiType.empty()) {
+            getRealName(type, astContext, def.typeName, def.realTypeName);
+            return true;
+        }
+        clang::QualType unqualified = type.getNonReferenceType().getUnqualifiedType();
+        getRealName(unqualified, astContext, def.typeName, def.realTypeName);
+        AbiComponent desc;
+        if (!abiTypeDesc(unqualified, *astContext, desc)) {
+            return false;
+        }
+        def.abiType = desc.type;
+        def.components = desc.components;
+        def.structured = true;
+        return true;
+    }
+
+    // Every source file that includes the contract sees the same methods, but
+    // only the file defining a method body sees its storage accesses.
+    void ABIGenerator::mergeABI(const ABI &abi) {
+        for (ABI &seen : abiDef.abis) {
+            if (seen.methodName != abi.methodName) continue;
+            set<string> reads(seen.storageReads.begin(), seen.storageReads.end());
+            set<string> writes(seen.storageWrites.begin(), seen.storageWrites.end());
+            reads.insert(abi.storageReads.begin(), abi.storageReads.end());
+            writes.insert(abi.storageWrites.begin(), abi.storageWrites.end());
+            for (const string &name : writes) {
+                reads.erase(name);
+            }
+            seen.storageReads.assign(reads.begin(), reads.end());
+            seen.storageWrites.assign(writes.begin(), writes.end());
+            return;
+        }
+        abiDef.abis.push_back(abi);
+    }
+
     void ABIGenerator::handleTagDeclDefinition(TagDecl* tagDecl) {
         clang::ASTContext* astContext = &tagDecl->getASTContext();
+        const string &contract = contractDef.name;
         if (tagDecl->getName().str() == contract) {
             if (contract == "Token"){
                 LOGDEBUG << "contract == Token";
@@ -61,6 +102,8 @@ namespace platon {
             LOGDEBUG << "decl name:[" << tagDecl->getName().str() << "] contract:[" <<contract << "]";
             const auto* recDecl =  dyn_cast<CXXRecordDecl>(tagDecl);
             if (recDecl == nullptr) return;
+            contractDecl = recDecl;
+            StorageAnalyzer storage(recDecl);
             for (const CXXMethodDecl* method : recDecl->methods()) {
                 string methodName = method->getNameAsString();
                 if (std::find_if(actions.begin(), actions.end(), [methodName] (const string& o) -> bool {return o == methodName;}) == actions.end()) {
@@ -73,23 +116,60 @@ namespace platon {
                     abi.isConst = true;
                 }
                 clang::QualType returnType = method->getReturnType();
-                getRealName(returnType, astContext, abi.returnType.typeName, abi.returnType.realTypeName);
+                if (!describeType(returnType, astContext, abi.returnType, true)) {
+                    throw Exception() << ErrStr(methodName + ":" + abi.returnType.realTypeName + " is not buildin type");
+                }
 
                 for (const auto *p : method->parameters()) {
                     clang::QualType qt = p->getOriginalType().getNonReferenceType();
                     abi.args.push_back(p->getNameAsString());
                     LOGDEBUG << "parame name:" << p->getNameAsString();
-                    string typeName;
-                    string realTypeName;
-                    getRealName(qt, astContext, typeName, realTypeName);
-                    if (!isBuildinType(realTypeName)) {
-                        throw Exception() << ErrStr(methodName + ":" + p->getNameAsString() + ":" + realTypeName + " is not buildin type");
+                    TypdeDef def;
+                    if (!describeType(qt, astContext, def, false)) {
+                        throw Exception() << ErrStr(methodName + ":" + p->getNameAsString() + ":" + def.realTypeName + " is not buildin type");
                     }
-                    abi.types.push_back({typeName, realTypeName});
+                    abi.types.push_back(def);
                 }
-                abiDef.abis.push_back(abi);
+                StorageAccess access = storage.analyze(method);
+                abi.storageReads.assign(access.reads.begin(), access.reads.end());
+                abi.storageWrites.assign(access.writes.begin(), access.writes.end());
+                mergeABI(abi);
             }
             LOGDEBUG << "abis size:" << abiDef.abis.size();
         }
     }
+
+    // PLATON_EVENT(name, ...) expands to a function EVENT<name> taking the
+    // event arguments, declared in the contract or one of its enclosing
+    // scopes, so the argument types come straight from its declaration.
+    void ABIGenerator::handleEvents(clang::ASTContext &astContext) {
+        const DeclContext *scope = contractDecl;
+        if (scope == nullptr) {
+            scope = astContext.getTranslationUnitDecl();
+        }
+        for (Event &event : contractDef.eventDef.events) {
+            if (event.resolved) continue;
+            const FunctionDecl *func = nullptr;
+            IdentifierInfo &id = astContext.Idents.get("EVENT" + event.name);
+            for (const DeclContext *ctx = scope; ctx != nullptr && func == nullptr; ctx = ctx->getParent()) {
+                for (NamedDecl *decl : ctx->lookup(&id)) {
+                    if ((func = dyn_cast<FunctionDecl>(decl)) != nullptr) break;
+                }
+            }
+            // The event may be declared in another source file.
+            if (func == nullptr) continue;
+            if (func->getNumParams() != event.params.size()) {
+                throw Exception() << ErrStr("event " + event.name + " not found");
+            }
+            event.args.clear();
+            for (size_t i = 0; i < func->getNumParams(); i++) {
+                string type = abiTypeName(func->getParamDecl(i)->getOriginalType(), astContext);
+                if (type.empty() || type == "void") {
+                    throw Exception() << ErrStr(event.name + ":" + event.params[i] + " is not buildin type");
+                }
+                event.args.push_back(type);
+            }
+            event.resolved = true;
+        }
+    }
 }
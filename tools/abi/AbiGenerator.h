@@ -23,6 +23,7 @@
 #include "clang/AST/QualTypeNames.h"
 
 #include "AbiDef.h"
+#include "AbiMacro.h"
 
 namespace cl = llvm::cl;
 
@@ -33,12 +34,13 @@ namespace platon {
         private:
             clang::CompilerInstance *compilerInstance;
 
-            const std::string &contract;
+            ContractDef &contractDef;
             const std::vector<std::string> &actions;
             ABIDef &abiDef;
+            const clang::CXXRecordDecl *contractDecl = nullptr;
         public:
-            ABIGenerator(const std::string &contract, const std::vector<std::string> &actions, ABIDef &abiDef)
-            :contract(contract), actions(actions), abiDef(abiDef){}
+            ABIGenerator(ContractDef &contractDef, const std::vector<std::string> &actions, ABIDef &abiDef)
+            :contractDef(contractDef), actions(actions), abiDef(abiDef){}
 
             ~ABIGenerator(){}
 
@@ -46,6 +48,9 @@ namespace platon {
                 this->compilerInstance = &compilerInstance;
             }
             void handleTagDeclDefinition(clang::TagDecl* tagDecl);
+            void mergeABI(const ABI &abi);
+            bool describeType(clang::QualType type, clang::ASTContext* astContext, TypdeDef &def, bool isReturn);
+            void handleEvents(clang::ASTContext &astContext);
             void getRealName( clang::QualType &type, clang::ASTContext* astContext, std::string &typeName, std::string &realTypeName);
     };
 
@@ -59,26 +64,44 @@ namespace platon {
                 abiGen.setCompilerInstance(compilerInstance);
             }
 
+            // PLATON_ABI usually follows the contract definition, so the
+            // contract name is only known once the whole file is parsed.
             void HandleTagDeclDefinition(clang::TagDecl* tagDecl) override {
-                abiGen.handleTagDeclDefinition(tagDecl);
+                if (llvm::isa<clang::CXXRecordDecl>(tagDecl) && tagDecl->getIdentifier() != nullptr) {
+                    tagDecls.push_back(tagDecl);
+                }
             }
+
+            void HandleTranslationUnit(clang::ASTContext &astContext) override {
+                for (clang::TagDecl *tagDecl : tagDecls) {
+                    abiGen.handleTagDeclDefinition(tagDecl);
+                }
+                abiGen.handleEvents(astContext);
+            }
+
+        private:
+            std::vector<clang::TagDecl*> tagDecls;
     };
 
+    /// Collects PLATON_ABI/PLATON_EVENT expansions and the contract methods
+    /// in a single parse of the source file.
     class ABIAction : public clang::ASTFrontendAction {
 
         private:
-            const std::string &contract;
-            const std::vector<std::string> &actions;
+            ContractDef &contractDef;
+            std::vector<std::string> &actions;
             ABIDef &abiDef;
             ABIGenerator abiGen;
 
         public:
-            ABIAction(const std::string& contract, const std::vector<std::string>& actions, ABIDef &abiDef)
-                :contract(contract), actions(actions), abiDef(abiDef), abiGen(contract, actions, abiDef){}
+            ABIAction(ContractDef &contractDef, std::vector<std::string>& actions, ABIDef &abiDef)
+                :contractDef(contractDef), actions(actions), abiDef(abiDef), abiGen(contractDef, actions, abiDef){}
 
         protected:
             std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance& compilerInstance,
                     llvm::StringRef) override {
+                compilerInstance.getPreprocessor().addPPCallbacks(
+                        llvm::make_unique<MacroCallback>(compilerInstance, contractDef, actions));
                 return llvm::make_unique<ABIAstConsumer>(compilerInstance, abiGen);
             }
     };
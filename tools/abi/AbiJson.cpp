@@ -1,5 +1,4 @@
 #include <fstream>
-#include <regex>
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
@@ -13,37 +12,29 @@ using namespace std;
 
 namespace platon {
 
+    typedef rapidjson::PrettyWriter <rapidjson::StringBuffer> JsonWriter;
 
-    static const string convertBuildinType(const string &typeName) {
-        regex charReg(R"(\s*char\s+\*\s*)");
-        regex constCharReg(R"(\s*const\s+char\s*\*\s*)");
-        string buildInType = typeName;
-        if (typeName == "unsigned __int128" || typeName == "uint128_t") buildInType = "uint128";
-        else if (typeName == "__int128"          || typeName == "int128_t")  buildInType = "int128";
-
-        else if (typeName == "unsigned long long" || typeName == "uint64_t") buildInType = "uint64";
-        else if (typeName == "unsigned long"      || typeName == "uint32_t") buildInType = "uint32";
-        else if (typeName == "unsigned short"     || typeName == "uint16_t") buildInType = "uint16";
-        else if (typeName == "unsigned char"      || typeName == "uint8_t")  buildInType = "uint8";
-
-        else if (typeName == "long long"          || typeName == "int64_t")  buildInType = "int64";
-        else if (typeName == "long"  || typeName == "int32_t" || typeName == "int")  buildInType = "int32";
-        else if (typeName == "short"              || typeName == "int16_t")  buildInType = "int16";
-        else if (typeName == "char"               || typeName == "int8_t")   buildInType = "int8";
-        else if (typeName == "float") buildInType = "float32";
-        else if (typeName == "double")   buildInType = "float64";
-        else if (regex_search(typeName, charReg) || regex_search(typeName, constCharReg)) buildInType = "string";
-        else if (typeName == "void") buildInType = "void";
-        else {
-            throw Exception() << ErrStr(typeName + " is not buildin type");
+    static void writeComponents(JsonWriter &writer, const vector<AbiComponent> &components) {
+        if (components.empty()) {
+            return;
         }
-        return buildInType;
+        writer.Key("components");
+        writer.StartArray();
+        for (const AbiComponent &component : components) {
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(component.name);
+            writer.Key("type");
+            writer.String(component.type);
+            writeComponents(writer, component.components);
+            writer.EndObject();
+        }
+        writer.EndArray();
     }
 
-
     void outputJsonABI(const ABIDef &abiDef, const ContractDef &contractDef, std::ofstream &fs) {
         rapidjson::StringBuffer strBuf;
-        rapidjson::PrettyWriter <rapidjson::StringBuffer> writer(strBuf);
+        JsonWriter writer(strBuf);
         //writer.StartObject();
 //        writer.Key("version");
 //        writer.String("0.01");
@@ -64,23 +55,40 @@ namespace platon {
 //                writer.Key("typeName");
 //                writer.String(abiDef.abis[i].types[j].typeName);
                 writer.Key("type");
-                writer.String(convertBuildinType(abiDef.abis[i].types[j].realTypeName));
+                writer.String(abiDef.abis[i].types[j].abiType);
+                writeComponents(writer, abiDef.abis[i].types[j].components);
                 writer.EndObject();
             }
             writer.EndArray();
             writer.Key("outputs");
             writer.StartArray();
-            if (abiDef.abis[i].returnType.realTypeName != "void") {
+            if (abiDef.abis[i].returnType.abiType != "void") {
                 writer.StartObject();
                 writer.Key("name");
                 writer.String("");
                 writer.Key("type");
-                writer.String(convertBuildinType(abiDef.abis[i].returnType.realTypeName));
+                writer.String(abiDef.abis[i].returnType.abiType);
+                writeComponents(writer, abiDef.abis[i].returnType.components);
                 writer.EndObject();
             }
             writer.EndArray();
             writer.Key("constant");
             writer.String(abiDef.abis[i].isConst ? "true" : "false");
+            writer.Key("storage");
+            writer.StartObject();
+            writer.Key("read");
+            writer.StartArray();
+            for (const string &name : abiDef.abis[i].storageReads) {
+                writer.String(name);
+            }
+            writer.EndArray();
+            writer.Key("write");
+            writer.StartArray();
+            for (const string &name : abiDef.abis[i].storageWrites) {
+                writer.String(name);
+            }
+            writer.EndArray();
+            writer.EndObject();
             writer.Key("type");
             writer.String("function");
             writer.EndObject();
@@ -99,7 +107,7 @@ namespace platon {
             for (size_t j = 0; j < contractDef.eventDef.events[i].args.size(); j++) {
                 writer.StartObject();
                 writer.Key("type");
-                writer.String(convertBuildinType(contractDef.eventDef.events[i].args[j]));
+                writer.String(contractDef.eventDef.events[i].args[j]);
                 writer.EndObject();
             }
             writer.EndArray();
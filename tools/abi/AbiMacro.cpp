@@ -1,5 +1,6 @@
+#include <algorithm>
+#include <cctype>
 #include <iostream>
-#include <regex>
 
 #include "llvm/ADT/STLExtras.h"
 #include "clang/Basic/SourceLocation.h"
@@ -7,7 +8,6 @@
 #include "StringUtil.h"
 #include "AbiMacro.h"
 #include "Log.h"
-#include "Common.h"
 #include "Exception.h"
 using namespace std;
 namespace cl = llvm::cl;
@@ -35,39 +35,75 @@ namespace platon{
         return fullName;
     }
 
-    void FindMacroAction::ExecuteAction() {
-        // getCompilerInstance().getPreprocessor().SetMacroExpansionOnlyInDirectives();
-        getCompilerInstance().getPreprocessor().addPPCallbacks(
-                llvm::make_unique<MacroCallback>(getCompilerInstance(), *this)
-                );
-        PreprocessOnlyAction::ExecuteAction();
+    static bool isIdentifierChar(char c) {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_';
     }
 
-    void MacroCallback::handleEvent(const Token &token, const MacroDefinition &md, SourceRange range, const MacroArgs *args) {
-        const auto& sm = compilerInstance.getSourceManager();
-        auto file_name = sm.getFilename(range.getBegin());
-        clang::SourceLocation b(range.getBegin()), _e(range.getEnd());
-        clang::SourceLocation e(clang::Lexer::getLocForEndOfToken(_e, 0, sm, compilerInstance.getLangOpts()));
-        auto macrostr = string(sm.getCharacterData(b), sm.getCharacterData(e)-sm.getCharacterData(b));
+    // Spelling of one macro argument, rebuilt from its tokens so comments,
+    // line breaks and the layout of the call do not matter. A space is kept
+    // only where two words would otherwise run together.
+    static string spellTokens(const Preprocessor &pp, const Token *begin, const Token *end) {
+        string text;
+        for (const Token *tok = begin; tok != end; ++tok) {
+            string spelling = pp.getSpelling(*tok);
+            if (!text.empty() && isIdentifierChar(text.back()) && isIdentifierChar(spelling.front())) {
+                text += ' ';
+            }
+            text += spelling;
+        }
+        return text;
+    }
 
-        regex r(R"(PLATON_EVENT\s*\(\s*(.+?)\s*,((?:.+?)*)\s*\))");
-        smatch smatch;
-        auto res = regex_search(macrostr, smatch, r);
-        Event event;
-        string name = smatch[1];
-        trim(name);
-        event.name = name;
-        vector<string> eventArgs;
+    static const Token *argumentEnd(const Token *tok) {
+        while (tok->isNot(tok::eof)) ++tok;
+        return tok;
+    }
 
-        split(smatch[2], eventArgs,",");
-        for (size_t i = 0; i < eventArgs.size(); i++) {
-            trim(eventArgs[i]);
-            if (!isBuildinType(eventArgs[i])) {
-                throw Exception() << ErrStr(name +  + ":" + eventArgs[i] + " is not buildin type");
+    // Splits a variadic argument on the commas that are not nested in
+    // parentheses, brackets or template arguments.
+    static vector<string> splitArguments(const Preprocessor &pp, const Token *tok) {
+        vector<string> result;
+        const Token *begin = tok;
+        int depth = 0;
+        for (; tok->isNot(tok::eof); ++tok) {
+            switch (tok->getKind()) {
+                case tok::l_paren: case tok::l_square: case tok::l_brace: case tok::less:
+                    ++depth; break;
+                case tok::r_paren: case tok::r_square: case tok::r_brace: case tok::greater:
+                    --depth; break;
+                case tok::greatergreater:
+                    depth -= 2; break;
+                case tok::comma:
+                    if (depth == 0) {
+                        result.push_back(spellTokens(pp, begin, tok));
+                        begin = tok + 1;
+                    }
+                    break;
+                default:
+                    break;
             }
-            event.args.push_back(eventArgs[i]);
         }
-        act.contractDef.eventDef.events.push_back(event);
+        if (begin != tok) {
+            result.push_back(spellTokens(pp, begin, tok));
+        }
+        return result;
+    }
+
+    void MacroCallback::handleEvent(const Token &token, const MacroDefinition &md, SourceRange range, const MacroArgs *args) {
+        const Preprocessor &pp = compilerInstance.getPreprocessor();
+        if (args == nullptr || args->getNumMacroArguments() < 2) {
+            return;
+        }
+        const Token *nameTok = args->getUnexpArgument(0);
+        Event event;
+        event.name = spellTokens(pp, nameTok, argumentEnd(nameTok));
+        event.params = splitArguments(pp, args->getUnexpArgument(1));
+        LOGDEBUG << "event:" << event.name << " args:" << event.params.size();
+        // A header declaring the event may be included by several source files.
+        for (const Event &seen : contractDef.eventDef.events) {
+            if (seen.name == event.name) return;
+        }
+        contractDef.eventDef.events.push_back(event);
     }
 
     void MacroCallback::MacroExpands (const Token &token, const MacroDefinition &md, SourceRange range, const MacroArgs *args) {
@@ -83,41 +119,25 @@ namespace platon{
 
         LOGDEBUG << "token name:" << id->getName().str();
 
-        const auto& sm = compilerInstance.getSourceManager();
-        auto file_name = sm.getFilename(range.getBegin());
-        // if (!act.abi_context.empty() && !file_name.startswith(act.abi_context)) {
-        // return;
-        // }
-
-        // if (md.getMacroInfo()->getNumArgs() != 2){
-        // return;
-        // }
-
-        clang::SourceLocation b(range.getBegin()), _e(range.getEnd());
-        clang::SourceLocation e(clang::Lexer::getLocForEndOfToken(_e, 0, sm, compilerInstance.getLangOpts()));
-        auto macrostr = string(sm.getCharacterData(b), sm.getCharacterData(e)-sm.getCharacterData(b));
-
-        regex r(R"(PLATON_ABI\s*\(\s*(.+?)\s*,((?:.+?)*)\s*\))");
-        smatch smatch;
-        auto res = regex_search(macrostr, smatch, r);
-
-        act.contractDef.fullName = smatch[1].str();
-        act.contractDef.name = removeNamespace(smatch[1].str());
-        string action = smatch[2].str();
-        trim(action);
-        act.actions.push_back(action);
-        LOGDEBUG << "macrostr:" << macrostr
-            << "  contract:" << smatch[1].str()
-            << "  actions_str:" << action << endl;
-
-        // MacroInfo *info = md.getMacroInfo();
-        // if (info != nullptr) {
-        // vector<const IdentifierInfo *> ids = info->params().vec();
-        // for (int i = 0; i < ids.size(); i++) {
-        // cout << "IdentifierInfo:" << ids[i]->getName().str() << endl;
-        // }
-
-        // }
+        if (args == nullptr || args->getNumMacroArguments() != 2) {
+            return;
+        }
 
+        const Preprocessor &pp = compilerInstance.getPreprocessor();
+        const Token *contractTok = args->getUnexpArgument(0);
+        const Token *actionTok = args->getUnexpArgument(1);
+        string contract = spellTokens(pp, contractTok, argumentEnd(contractTok));
+        string action = spellTokens(pp, actionTok, argumentEnd(actionTok));
+
+        contractDef.fullName = contract;
+        contractDef.name = removeNamespace(contract);
+        if (contractDef.sourceFile.empty()) {
+            const SourceManager &sm = compilerInstance.getSourceManager();
+            contractDef.sourceFile = sm.getFileEntryForID(sm.getMainFileID())->getName().str();
+        }
+        if (std::find(actions.begin(), actions.end(), action) == actions.end()) {
+            actions.push_back(action);
+        }
+        LOGDEBUG << "contract:" << contract << "  actions_str:" << action << endl;
     }
 }
@@ -28,24 +28,14 @@ namespace cl = llvm::cl;
 
 namespace platon{
 
-    struct FindMacroAction : public clang::PreprocessOnlyAction {
-        ContractDef& contractDef;
-        std::vector<std::string>& actions;
-
-        FindMacroAction(ContractDef& contractDef, std::vector<std::string>& actions)
-            :contractDef(contractDef),
-            actions(actions){}
-
-        void ExecuteAction() override;
-    };
-
     struct MacroCallback : public clang::PPCallbacks {
 
         clang::CompilerInstance& compilerInstance;
-        FindMacroAction &act;
+        ContractDef& contractDef;
+        std::vector<std::string>& actions;
 
-        MacroCallback(clang::CompilerInstance& compilerInstance, FindMacroAction& act)
-            : compilerInstance(compilerInstance), act(act) {
+        MacroCallback(clang::CompilerInstance& compilerInstance, ContractDef& contractDef, std::vector<std::string>& actions)
+            : compilerInstance(compilerInstance), contractDef(contractDef), actions(actions) {
             }
         void handleEvent(const clang::Token &token, const clang::MacroDefinition &md, clang::SourceRange range, const clang::MacroArgs *args);
         void MacroExpands (const clang::Token &token, const clang::MacroDefinition &md, clang::SourceRange range, const clang::MacroArgs *args) override ;
@@ -0,0 +1,245 @@
+#include "AbiType.h"
+
+#include <algorithm>
+
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/ExprCXX.h"
+
+using namespace std;
+using namespace clang;
+
+namespace platon {
+
+    static bool isPlainChar(QualType type) {
+        const auto *builtin = type->getAs<BuiltinType>();
+        return builtin != nullptr &&
+               (builtin->getKind() == BuiltinType::Char_S || builtin->getKind() == BuiltinType::Char_U);
+    }
+
+    bool isCharArray(QualType type) {
+        const auto *array = dyn_cast<ConstantArrayType>(type.getCanonicalType().getTypePtr());
+        return array != nullptr && isPlainChar(array->getElementType());
+    }
+
+    string abiTypeName(QualType type, const ASTContext &astContext) {
+        QualType canonical = type.getNonReferenceType().getCanonicalType().getUnqualifiedType();
+
+        if (const auto *pointer = dyn_cast<PointerType>(canonical.getTypePtr())) {
+            return isPlainChar(pointer->getPointeeType()) ? "string" : "";
+        }
+        if (isCharArray(canonical)) {
+            return "string";
+        }
+
+        const auto *builtin = dyn_cast<BuiltinType>(canonical.getTypePtr());
+        if (builtin == nullptr) {
+            return "";
+        }
+        switch (builtin->getKind()) {
+            case BuiltinType::Void:
+                return "void";
+            case BuiltinType::Float:
+                return "float32";
+            case BuiltinType::Double:
+                return "float64";
+            case BuiltinType::Char_S:
+            case BuiltinType::Char_U:
+                return "int8";
+            case BuiltinType::Bool:
+            case BuiltinType::WChar_S:
+            case BuiltinType::WChar_U:
+            case BuiltinType::Char16:
+            case BuiltinType::Char32:
+                return "";
+            default:
+                break;
+        }
+        if (!builtin->isInteger()) {
+            return "";
+        }
+        string bits = to_string(astContext.getTypeSize(canonical));
+        return builtin->isSignedInteger() ? "int" + bits : "uint" + bits;
+    }
+
+    static bool describe(QualType type, const ASTContext &astContext,
+                         vector<const CXXRecordDecl *> &active, AbiComponent &desc);
+
+    // platon::Address is FixedHash<20> like h160, only the typedef tells them apart.
+    static bool isAddress(QualType type) {
+        while (const auto *typedefType = type->getAs<TypedefType>()) {
+            if (typedefType->getDecl()->getQualifiedNameAsString() == "platon::Address") {
+                return true;
+            }
+            type = typedefType->desugar();
+        }
+        return false;
+    }
+
+    static const ClassTemplateSpecializationDecl *specialization(const CXXRecordDecl *record, const char *name) {
+        const auto *spec = dyn_cast<ClassTemplateSpecializationDecl>(record);
+        if (spec == nullptr || record->getName() != name) {
+            return nullptr;
+        }
+        return spec;
+    }
+
+    static uint64_t integralArg(const ClassTemplateSpecializationDecl *spec, unsigned i) {
+        const TemplateArgument &arg = spec->getTemplateArgs()[i];
+        return arg.getKind() == TemplateArgument::Integral ? arg.getAsIntegral().getZExtValue() : ~0ull;
+    }
+
+    // boost::multiprecision::number<cpp_int_backend<N, N, unsigned_magnitude, unchecked>>,
+    // which u160, u256 and the other fixed-width aliases name. Returns the width or 0.
+    static uint64_t bigUintBits(const CXXRecordDecl *record) {
+        const auto *number = specialization(record, "number");
+        if (number == nullptr || record->getQualifiedNameAsString() != "boost::multiprecision::number") {
+            return 0;
+        }
+        const CXXRecordDecl *backend = number->getTemplateArgs()[0].getAsType()->getAsCXXRecordDecl();
+        const auto *spec = backend == nullptr ? nullptr : specialization(backend, "cpp_int_backend");
+        if (spec == nullptr || spec->getTemplateArgs().size() < 4) {
+            return 0;
+        }
+        uint64_t bits = integralArg(spec, 0);
+        // The third argument is cpp_integer_type, where unsigned_magnitude is 0;
+        // the fourth is cpp_int_check_type, where unchecked is 0.
+        if (bits == 0 || bits % 8 != 0 || integralArg(spec, 1) != bits ||
+            integralArg(spec, 2) != 0 || integralArg(spec, 3) != 0) {
+            return 0;
+        }
+        return bits;
+    }
+
+    // Fields visited by the platonForEachField friend that PLATON_SERIALIZE
+    // defines, in order. PLATON_SERIALIZE_DERIVED first visits the base,
+    // which shows up as a cast of the object to the base class.
+    static void collectFields(const Stmt *stmt, const CXXRecordDecl *record,
+                              vector<const CXXRecordDecl *> &bases, vector<const FieldDecl *> &fields) {
+        if (stmt == nullptr) {
+            return;
+        }
+        if (const auto *member = dyn_cast<MemberExpr>(stmt)) {
+            if (const auto *field = dyn_cast<FieldDecl>(member->getMemberDecl())) {
+                fields.push_back(field);
+                return;
+            }
+        }
+        if (const auto *cast = dyn_cast<CXXStaticCastExpr>(stmt)) {
+            const CXXRecordDecl *base = cast->getTypeAsWritten().getNonReferenceType()->getAsCXXRecordDecl();
+            if (base != nullptr && base != record && record->isDerivedFrom(base)) {
+                bases.push_back(base);
+                fields.push_back(nullptr);
+                return;
+            }
+        }
+        for (const Stmt *child : stmt->children()) {
+            collectFields(child, record, bases, fields);
+        }
+    }
+
+    static bool describeFields(const CXXRecordDecl *record, const ASTContext &astContext,
+                               vector<const CXXRecordDecl *> &active, AbiComponent &desc) {
+        const FunctionDecl *visit = nullptr;
+        for (const FriendDecl *friendDecl : record->friends()) {
+            const auto *tmpl = dyn_cast_or_null<FunctionTemplateDecl>(friendDecl->getFriendDecl());
+            if (tmpl != nullptr && tmpl->getName() == "platonForEachField" && tmpl->getTemplatedDecl()->hasBody()) {
+                visit = tmpl->getTemplatedDecl();
+                break;
+            }
+        }
+        if (visit == nullptr || find(active.begin(), active.end(), record) != active.end()) {
+            return false;
+        }
+        vector<const CXXRecordDecl *> bases;
+        vector<const FieldDecl *> fields;
+        collectFields(visit->getBody(), record, bases, fields);
+
+        active.push_back(record);
+        auto base = bases.begin();
+        for (const FieldDecl *field : fields) {
+            if (field == nullptr) {
+                AbiComponent inherited;
+                if (!describeFields(*base++, astContext, active, inherited)) {
+                    return false;
+                }
+                desc.components.insert(desc.components.end(), inherited.components.begin(), inherited.components.end());
+                continue;
+            }
+            AbiComponent member;
+            member.name = field->getNameAsString();
+            if (!describe(field->getType(), astContext, active, member)) {
+                return false;
+            }
+            desc.components.push_back(member);
+        }
+        active.pop_back();
+        desc.type = "tuple";
+        return true;
+    }
+
+    static bool describe(QualType type, const ASTContext &astContext,
+                         vector<const CXXRecordDecl *> &active, AbiComponent &desc) {
+        type = type.getNonReferenceType();
+        const CXXRecordDecl *record = type.getCanonicalType()->getAsCXXRecordDecl();
+        if (record == nullptr) {
+            desc.type = abiTypeName(type, astContext);
+            return !desc.type.empty() && desc.type != "void";
+        }
+
+        if (record->isInStdNamespace()) {
+            if (const auto *spec = specialization(record, "basic_string")) {
+                desc.type = "string";
+                return spec->getTemplateArgs()[0].getAsType()->isCharType();
+            }
+            if (const auto *spec = specialization(record, "vector")) {
+                QualType element = spec->getTemplateArgs()[0].getAsType();
+                if (element->isSpecificBuiltinType(BuiltinType::UChar)) {
+                    desc.type = "bytes";
+                    return true;
+                }
+                if (!describe(element, astContext, active, desc)) {
+                    return false;
+                }
+                desc.type += "[]";
+                return true;
+            }
+            if (const auto *spec = specialization(record, "map")) {
+                AbiComponent key, value;
+                key.name = "key";
+                value.name = "value";
+                if (!describe(spec->getTemplateArgs()[0].getAsType(), astContext, active, key) ||
+                    !describe(spec->getTemplateArgs()[1].getAsType(), astContext, active, value)) {
+                    return false;
+                }
+                desc.type = "tuple[]";
+                desc.components = {key, value};
+                return true;
+            }
+            return false;
+        }
+
+        string name = record->getQualifiedNameAsString();
+        if (name == "platon::uint256") {
+            desc.type = "uint256";
+            return true;
+        }
+        if (name == "platon::FixedHash") {
+            const auto *spec = specialization(record, "FixedHash");
+            desc.type = isAddress(type) ? "address" : "bytes" + to_string(integralArg(spec, 0));
+            return true;
+        }
+        if (uint64_t bits = bigUintBits(record)) {
+            desc.type = "uint" + to_string(bits);
+            return true;
+        }
+        return describeFields(record, astContext, active, desc);
+    }
+
+    bool abiTypeDesc(QualType type, const ASTContext &astContext, AbiComponent &desc) {
+        vector<const CXXRecordDecl *> active;
+        desc.components.clear();
+        return describe(type, astContext, active, desc);
+    }
+}
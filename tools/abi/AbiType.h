@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Type.h"
+
+#include "AbiDef.h"
+
+namespace platon {
+
+    /// ABI type name ("uint64", "string", ...) of a contract parameter or
+    /// return value, or an empty string when the type can not be passed
+    /// across the contract boundary. Typedefs and template aliases are looked
+    /// through, so only the canonical type matters.
+    std::string abiTypeName(clang::QualType type, const clang::ASTContext &astContext);
+
+    /// Like abiTypeName, but also accepts the class types the dispatcher
+    /// decodes: std::string ("string"), bytes, std::vector<T> ("T[]"),
+    /// std::map<K, V> ("tuple[]" of key and value), u256 and the other boost
+    /// fixed-width integers ("uintN"), platon::uint256, FixedHash<N>
+    /// ("bytesN", or "address" when spelled platon::Address) and classes
+    /// declared with PLATON_SERIALIZE ("tuple"). Returns false when the type
+    /// can not be passed.
+    bool abiTypeDesc(clang::QualType type, const clang::ASTContext &astContext, AbiComponent &desc);
+
+    /// char[N], which the generated C entry points take as char *.
+    bool isCharArray(clang::QualType type);
+}
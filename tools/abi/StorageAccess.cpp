@@ -0,0 +1,131 @@
+#include "StorageAccess.h"
+
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+
+using namespace std;
+using namespace clang;
+
+namespace platon {
+
+    bool isStorageType(QualType type) {
+        const auto *spec = dyn_cast_or_null<ClassTemplateSpecializationDecl>(
+                type.getCanonicalType()->getAsCXXRecordDecl());
+        if (spec == nullptr) {
+            return false;
+        }
+        string name = spec->getSpecializedTemplate()->getQualifiedNameAsString();
+        return name == "platon::StorageType" || name == "platon::db::Map" ||
+               name == "platon::db::List" || name == "platon::db::Array";
+    }
+
+    namespace {
+        // Storage member of the contract that expr names through `this`.
+        const FieldDecl *storageField(const Expr *expr) {
+            const auto *member = dyn_cast<MemberExpr>(expr->IgnoreParenImpCasts());
+            if (member == nullptr || !isa<CXXThisExpr>(member->getBase()->IgnoreParenImpCasts())) {
+                return nullptr;
+            }
+            const auto *field = dyn_cast<FieldDecl>(member->getMemberDecl());
+            return field != nullptr && isStorageType(field->getType()) ? field : nullptr;
+        }
+
+        class AccessVisitor : public RecursiveASTVisitor<AccessVisitor> {
+            public:
+                AccessVisitor(StorageAnalyzer &analyzer, StorageAccess &access)
+                    : analyzer(analyzer), access(access) {}
+
+                // Parents are visited before their children, so member calls
+                // classify their object before VisitMemberExpr sees it.
+                bool VisitCXXMemberCallExpr(CXXMemberCallExpr *call) {
+                    const CXXMethodDecl *callee = call->getMethodDecl();
+                    const Expr *object = call->getImplicitObjectArgument();
+                    if (callee == nullptr || object == nullptr) {
+                        return true;
+                    }
+                    if (isa<CXXThisExpr>(object->IgnoreParenImpCasts())) {
+                        if (analyzer.isContractMethod(callee)) {
+                            merge(analyzer.analyze(callee));
+                        }
+                        return true;
+                    }
+                    note(object, callee);
+                    return true;
+                }
+
+                bool VisitCXXOperatorCallExpr(CXXOperatorCallExpr *call) {
+                    const auto *callee = dyn_cast_or_null<CXXMethodDecl>(call->getDirectCallee());
+                    if (callee != nullptr && call->getNumArgs() > 0) {
+                        note(call->getArg(0), callee);
+                    }
+                    return true;
+                }
+
+                bool VisitMemberExpr(MemberExpr *expr) {
+                    const FieldDecl *field = storageField(expr);
+                    if (field != nullptr && handled.count(expr) == 0) {
+                        access.writes.insert(field->getNameAsString());
+                    }
+                    return true;
+                }
+
+            private:
+                void note(const Expr *object, const CXXMethodDecl *callee) {
+                    const FieldDecl *field = storageField(object);
+                    if (field == nullptr) {
+                        return;
+                    }
+                    handled.insert(object->IgnoreParenImpCasts());
+                    if (callee->isConst()) {
+                        access.reads.insert(field->getNameAsString());
+                    } else {
+                        access.writes.insert(field->getNameAsString());
+                    }
+                }
+
+                void merge(const StorageAccess &other) {
+                    access.reads.insert(other.reads.begin(), other.reads.end());
+                    access.writes.insert(other.writes.begin(), other.writes.end());
+                }
+
+                StorageAnalyzer &analyzer;
+                StorageAccess &access;
+                set<const Expr *> handled;
+        };
+    }
+
+    bool StorageAnalyzer::isContractMethod(const CXXMethodDecl *method) const {
+        const CXXRecordDecl *parent = method->getParent();
+        return parent == contract || contract->isDerivedFrom(parent);
+    }
+
+    StorageAccess StorageAnalyzer::analyze(const CXXMethodDecl *method) {
+        const FunctionDecl *def = nullptr;
+        if (!method->hasBody(def)) {
+            return StorageAccess();
+        }
+        auto iter = results.find(def);
+        if (iter != results.end()) {
+            return iter->second;
+        }
+        if (!active.insert(def).second) {
+            // Mutually recursive methods: the outermost call collects the
+            // union, results computed inside the cycle are not cached.
+            recursive = true;
+            return StorageAccess();
+        }
+
+        StorageAccess access;
+        AccessVisitor(*this, access).TraverseStmt(def->getBody());
+        active.erase(def);
+
+        for (const string &name : access.writes) {
+            access.reads.erase(name);
+        }
+        if (recursive && !active.empty()) {
+            return access;
+        }
+        recursive = false;
+        return results[def] = access;
+    }
+}
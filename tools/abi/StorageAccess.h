@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "clang/AST/DeclCXX.h"
+
+namespace platon {
+
+    struct StorageAccess {
+        std::set<std::string> reads;
+        std::set<std::string> writes;
+    };
+
+    /// Whether type is one of the persistent containers of platonlib:
+    /// platon::StorageType or platon::db::Map, List and Array.
+    bool isStorageType(clang::QualType type);
+
+    /// Finds the storage members of a contract that its methods read or
+    /// write. A member counts as written when a non-const member function or
+    /// operator is called on it, or when it is used in any other way that
+    /// can not be proven read-only. Calls to other methods of the contract
+    /// are followed.
+    class StorageAnalyzer {
+        public:
+            explicit StorageAnalyzer(const clang::CXXRecordDecl *contract) : contract(contract) {}
+
+            StorageAccess analyze(const clang::CXXMethodDecl *method);
+
+            bool isContractMethod(const clang::CXXMethodDecl *method) const;
+
+        private:
+            const clang::CXXRecordDecl *contract;
+            std::map<const clang::FunctionDecl *, StorageAccess> results;
+            std::set<const clang::FunctionDecl *> active;
+            bool recursive = false;
+    };
+}
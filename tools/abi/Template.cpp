@@ -10,6 +10,7 @@ namespace platon {
 
     string generateAbiCPlusPlus(ContractDef &contractDef, ABIDef &abiDef) {
         string code = "//platon autogen begin\n";
+        code += "#include <platon/trace.hpp>\n";
         code += "extern \"C\" { \n";
         for (auto method : abiDef.abis) {
             code += method.returnType.realTypeName + " ";
@@ -22,6 +23,10 @@ namespace platon {
                 }
             }
             code += ") {\n";
+            code += "PLATON_TRACE_METHOD(\"" + method.methodName + "\");\n";
+            if (method.isConst) {
+                code += "platon::enterReadOnlyMode();\n";
+            }
             code += contractDef.fullName + " ";
             string var = contractDef.name + "_platon";
             code += var + ";\n";
@@ -40,4 +45,55 @@ namespace platon {
         code += "\n}\n//platon autogen end";
         return code;
     }
+
+    string generateDispatcher(ContractDef &contractDef, ABIDef &abiDef) {
+        string var = contractDef.name + "_platon";
+        string code = "//platon autogen begin\n";
+        code += "#include <platon/dispatcher.hpp>\n";
+        code += "extern \"C\" { \n";
+        code += "const char* invoke(const char* input) {\n";
+        code += "platon::Dispatcher dispatcher(input);\n";
+        code += "switch (dispatcher.selector()) {\n";
+        for (auto method : abiDef.abis) {
+            string name = "\"" + method.methodName + "\"";
+            code += "case platon::methodSelector(" + name + "): {\n";
+            code += "if (!dispatcher.is(" + name + ")) break;\n";
+            code += "PLATON_TRACE_METHOD(" + name + ");\n";
+            code += "if (dispatcher.argCount() != " + to_string(method.args.size()) + ") platon::platonThrow(\"bad argument count\");\n";
+            string call = var + "." + method.methodName + "(";
+            for (int i = 0; i < method.args.size(); ++i) {
+                string index = to_string(i);
+                if (method.types[i].structured) {
+                    code += "auto arg" + index + " = dispatcher.arg<" + method.types[i].realTypeName + ">(" + index + ");\n";
+                    call += "std::move(arg" + index + ")";
+                } else if (method.types[i].abiType == "string") {
+                    code += "std::string arg" + index + " = dispatcher.arg<std::string>(" + index + ");\n";
+                    call += method.types[i].realTypeName.find("const") != string::npos
+                            ? "arg" + index + ".c_str()" : "&arg" + index + "[0]";
+                } else {
+                    call += "dispatcher.arg<" + method.types[i].realTypeName + ">(" + index + ")";
+                }
+                if (i != method.args.size()-1) {
+                    call += ",";
+                }
+            }
+            call += ")";
+            if (method.isConst) {
+                code += "platon::enterReadOnlyMode();\n";
+            }
+            code += contractDef.fullName + " " + var + ";\n";
+            if (method.returnType.abiType == "void") {
+                code += call + ";\n";
+            } else {
+                code += "dispatcher.ret(" + call + ");\n";
+            }
+            code += "RETURN(dispatcher.result());\n}\n";
+        }
+        code += "}\n";
+        code += "platon::platonThrow(\"unknown method\");\n";
+        code += "return \"\";\n";
+        code += "}\n";
+        code += "\n}\n//platon autogen end";
+        return code;
+    }
 }
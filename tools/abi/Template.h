@@ -5,4 +5,8 @@
 namespace platon {
 
     std::string generateAbiCPlusPlus(ContractDef &contractDef, ABIDef &abiDef);
+
+    // A single exported `invoke` that decodes the call data and switches on
+    // the method selector, see platon/dispatcher.hpp.
+    std::string generateDispatcher(ContractDef &contractDef, ABIDef &abiDef);
 }
\ No newline at end of file
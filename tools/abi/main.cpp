@@ -1,6 +1,7 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <regex>
+#include <iterator>
 #include <string>
 #include <vector>
 #define RAPIDJSON_HAS_STDSTRING 1
@@ -72,44 +73,29 @@ static cl::opt<std::string> abidef_output_opt("abidef_output",
                                               cl::desc("abi define output"),
                                               cl::cat(abiGeneratorOptions));
 
-std::unique_ptr<tooling::FrontendActionFactory> CreateFindMacroFactory(
-    ContractDef &contractDef, vector<string> &actions) {
-  struct FrontendMacroActionFactory : public tooling::FrontendActionFactory {
-    ContractDef &contractDef;
-    vector<string> &actions;
-
-    FrontendMacroActionFactory(ContractDef &contractDef,
-                               vector<string> &actions)
-        : contractDef(contractDef), actions(actions) {}
-
-    clang::FrontendAction *create() override {
-      return new FindMacroAction(contractDef, actions);
-    }
-  };
-
-  LOGDEBUG << "start create_find_macro_factory";
-  return std::unique_ptr<tooling::FrontendActionFactory>(
-      new FrontendMacroActionFactory(contractDef, actions));
-}
+static cl::opt<bool> dispatch_opt(
+    "dispatch",
+    cl::desc("export a single `invoke` entry that dispatches on the call data"),
+    cl::cat(abiGeneratorOptions));
 
 std::unique_ptr<tooling::FrontendActionFactory> createFactory(
-    const string &contract, const vector<string> &actions, ABIDef &abiDef) {
+    ContractDef &contractDef, vector<string> &actions, ABIDef &abiDef) {
   struct ABIFrontendActionFactory : public tooling::FrontendActionFactory {
-    const string &contract;
-    const vector<string> &actions;
+    ContractDef &contractDef;
+    vector<string> &actions;
     ABIDef &abiDef;
 
-    ABIFrontendActionFactory(const string &contract,
-                             const vector<string> &actions, ABIDef &abiDef)
-        : contract(contract), actions(actions), abiDef(abiDef) {}
+    ABIFrontendActionFactory(ContractDef &contractDef, vector<string> &actions,
+                             ABIDef &abiDef)
+        : contractDef(contractDef), actions(actions), abiDef(abiDef) {}
 
     clang::FrontendAction *create() override {
-      return new ABIAction(contract, actions, abiDef);
+      return new ABIAction(contractDef, actions, abiDef);
     }
   };
 
   return std::unique_ptr<tooling::FrontendActionFactory>(
-      new ABIFrontendActionFactory(contract, actions, abiDef));
+      new ABIFrontendActionFactory(contractDef, actions, abiDef));
 }
 
 void createJsonAbi(const ABIDef &abiDef, const ContractDef &contractDef,
@@ -167,8 +153,12 @@ void createExportsFile(const ABIDef &abiDef, const string &srcFile,
     throw Exception() << ErrStr("fs is not open:") << ErrStr(strerror(errno));
   }
 
-  for (size_t i = 0; i < abiDef.abis.size(); i++) {
-    fs << abiDef.abis[i].methodName << std::endl;
+  if (dispatch_opt) {
+    fs << "invoke" << std::endl;
+  } else {
+    for (size_t i = 0; i < abiDef.abis.size(); i++) {
+      fs << abiDef.abis[i].methodName << std::endl;
+    }
   }
   fs.close();
 
@@ -293,13 +283,20 @@ int main(int argc, const char **argv) {
   try {
     tooling::CommonOptionsParser op(argc, argv, abiGeneratorOptions);
 
-    if (op.getSourcePathList().size() > 1) {
-      // throw Exception() << ErrStr("only one contract file");
-      return -1;
+    // The contract may be split over several files. Parse those declaring
+    // PLATON_ABI first, so the contract is known when the others are parsed.
+    vector<string> sources = op.getSourcePathList();
+    for (const string &source : sources) {
+      prepareFile(source);
     }
-    prepareFile(op.getSourcePathList()[0]);
+    stable_partition(sources.begin(), sources.end(), [](const string &source) {
+      std::ifstream in(source);
+      string text((std::istreambuf_iterator<char>(in)),
+                  std::istreambuf_iterator<char>());
+      return text.find("PLATON_ABI") != string::npos;
+    });
 
-    tooling::ClangTool Tool(op.getCompilations(), op.getSourcePathList());
+    tooling::ClangTool Tool(op.getCompilations(), sources);
 
     llvm::SmallString<64> res;
     llvm::sys::path::system_temp_directory(true, res);
@@ -324,10 +321,11 @@ int main(int argc, const char **argv) {
     ContractDef contractDef;
 
     LOGDEBUG << "start run";
-    int result = Tool.run(CreateFindMacroFactory(contractDef, action).get());
+    ABIDef abiDef;
+    int result = Tool.run(createFactory(contractDef, action, abiDef).get());
 
     if (result != 0 || contractDef.name.empty()) {
-      // throw Exception() << ErrStr("find macro PLATON_ABI failed");
+      // throw Exception() << ErrStr("find contract abi defined failed");
       return -1;
     }
 
@@ -338,14 +336,6 @@ int main(int argc, const char **argv) {
       LOGDEBUG << "contract:" << contractDef.name << "  action:" << act;
     }
 
-    ABIDef abiDef;
-    result = Tool.run(createFactory(contractDef.name, action, abiDef).get());
-
-    if (result != 0) {
-      // throw Exception() << ErrStr("find contract abi defined failed");
-      return -1;
-    }
-
     LOGINFO << "find method success"
             << "find abi size:" << abiDef.abis.size();
     bool foundInit = false;
@@ -354,6 +344,17 @@ int main(int argc, const char **argv) {
       if (abiDef.abis[i].methodName == "init") {
         foundInit = true;
       }
+      // Per-method exports take wasm scalars, class types need the RLP call data.
+      bool structured = abiDef.abis[i].returnType.structured;
+      for (const TypdeDef &type : abiDef.abis[i].types) {
+        structured = structured || type.structured;
+      }
+      if (structured && !dispatch_opt) {
+        std::cerr << "ERROR: <platon-abigen> `" << abiDef.abis[i].methodName
+                  << "` takes or returns a class type, which needs -dispatch"
+                  << std::endl;
+        return -1;
+      }
       for (size_t j = 0; j < abiDef.abis[i].args.size(); ++j) {
         LOGDEBUG << "name:" << abiDef.abis[i].args[j]
                  << ", typeName:" << abiDef.abis[i].types[j].typeName
@@ -364,6 +365,14 @@ int main(int argc, const char **argv) {
                << " realTypeName:" << abiDef.abis[i].returnType.realTypeName;
     }
 
+    for (const Event &event : contractDef.eventDef.events) {
+      if (!event.resolved) {
+        std::cerr << "ERROR: <platon-abigen> event `" << event.name
+                  << "` not found in any input" << std::endl;
+        return -1;
+      }
+    }
+
     if (!foundInit) {
       std::cerr
           << "ERROR: <platon-abigen> `init` function not found!!! Please use "
@@ -376,15 +385,33 @@ int main(int argc, const char **argv) {
 
     string srcFilename =
         fs::path(op.getSourcePathList()[0]).filename().string();
-
-    createJsonAbi(abiDef, contractDef, srcFilename, abigen_output_opt,
+    string contractSource = contractDef.sourceFile.empty()
+                                ? op.getSourcePathList()[0]
+                                : contractDef.sourceFile;
+
+    // The VM calls invoke like the per-method exports, with the hex encoded
+    // call data as its string argument, see platon/dispatcher.hpp.
+    ABIDef jsonDef = abiDef;
+    if (dispatch_opt) {
+      TypdeDef hex("string", "const char*");
+      hex.abiType = "string";
+      platon::ABI invoke;
+      invoke.methodName = "invoke";
+      invoke.args.push_back("input");
+      invoke.types.push_back(hex);
+      invoke.returnType = hex;
+      jsonDef.abis.push_back(invoke);
+    }
+    createJsonAbi(jsonDef, contractDef, srcFilename, abigen_output_opt,
                   randomDir);
     createExportsFile(abiDef, srcFilename, exports_output_opt, randomDir);
 
-    string externC = generateAbiCPlusPlus(contractDef, abiDef);
+    string externC = dispatch_opt ? generateDispatcher(contractDef, abiDef)
+                                  : generateAbiCPlusPlus(contractDef, abiDef);
 
-    createContractFile(randomDir, op.getSourcePathList()[0], srcFilename,
-                       externC, abidef_output_opt);
+    createContractFile(randomDir, contractSource,
+                       fs::path(contractSource).filename().string(), externC,
+                       abidef_output_opt);
 
   } catch (Exception e) {
     cerr << *boost::get_error_info<ErrStr>(e) << endl;
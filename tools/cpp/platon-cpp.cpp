@@ -1,12 +1,18 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
 #include <fstream>
+#include <thread>
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 
 #include "platon/utils.hpp"
 
@@ -22,6 +28,221 @@ const std::string kCompilerName = "platon-cpp";
 
 using namespace llvm;
 
+// Reports the wall time of a build step on stderr when -time is given.
+class StepTimer {
+ public:
+  StepTimer(const Options& opts, std::string step)
+      : enabled_(opts.time),
+        step_(std::move(step)),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~StepTimer() {
+    if (!enabled_) return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_);
+    llvm::errs() << kCompilerName << ": " << step_ << " " << elapsed.count()
+                 << " ms\n";
+  }
+
+ private:
+  bool enabled_;
+  std::string step_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+using platon::cdt::cache::Cache;
+
+static std::string TempPath(const std::string& filename) {
+  llvm::SmallString<64> res;
+  llvm::sys::path::system_temp_directory(true, res);
+  return std::string(res.c_str()) + "/" + filename;
+}
+
+// Creates a file in the temp directory named after filename, unique to the
+// calling step so that inputs with the same name never share it.
+static bool UniqueTempPath(const std::string& filename, const std::string& suffix,
+                           std::string& path) {
+  llvm::SmallString<128> res;
+  if (llvm::sys::fs::createTemporaryFile(filename, suffix, res)) {
+    return false;
+  }
+  path = std::string(res.c_str());
+  return true;
+}
+
+// Builds the cache key of a step from the preprocessed inputs, the step's
+// flags and the toolchain version. Returns an empty key when an input does
+// not preprocess; the step then runs uncached and reports the error itself.
+static std::string SourceKey(const std::string& step,
+                             const std::vector<std::string>& inputs,
+                             const std::vector<std::string>& flags,
+                             const Options& opts) {
+  auto clang = llvm::sys::findProgramByName(
+      CLANG, {platon::cdt::utils::where()});
+  std::vector<std::string> parts = {
+      step, "${VERSION_FULL}", Cache::ToolStamp(clang ? *clang : CLANG)};
+  parts.insert(parts.end(), flags.begin(), flags.end());
+
+  for (const auto& input : inputs) {
+    std::string preprocessed;
+    if (!UniqueTempPath(llvm::sys::path::filename(input).str() + "." + step,
+                        "i", preprocessed)) {
+      return std::string();
+    }
+    std::vector<std::string> pp_opts = opts.compiler_opts;
+    pp_opts.insert(pp_opts.end(),
+                   {"-E", "-Qunused-arguments", input, "-o", preprocessed});
+    bool ok = platon::cdt::runtime::exec_subprogram(
+        CLANG, pp_opts, false, preprocessed + ".log");
+    std::string content;
+    ok = ok && Cache::ReadFile(preprocessed, content);
+    llvm::sys::fs::remove(preprocessed);
+    llvm::sys::fs::remove(preprocessed + ".log");
+    if (!ok) {
+      return std::string();
+    }
+    parts.push_back(content);
+  }
+  return Cache::Key(parts);
+}
+
+// Runs platon-abigen, or restores its ABI, exports and generated sources
+// from the cache when the preprocessed inputs are unchanged.
+static bool RunAbigen(const Options& opts, Cache* cache) {
+  if (!cache) {
+    // A stale ABI must not pass for the output of a failed run.
+    llvm::sys::fs::remove(opts.abi_filename);
+    llvm::sys::fs::remove(opts.exports_filename);
+    return platon::cdt::runtime::exec_subprogram("platon-abigen",
+                                                 opts.abigen_opts) &&
+           llvm::sys::fs::exists(opts.abi_filename);
+  }
+
+  platon::cdt::cache::EntryFiles files = {{"abi", opts.abi_filename},
+                                          {"exports", opts.exports_filename}};
+  for (size_t i = 0; i < opts.inputs.size(); i++) {
+    files.emplace_back("source." + std::to_string(i),
+                       TempPath(llvm::sys::path::filename(opts.inputs[i]).str()));
+  }
+  std::vector<std::string> flags = opts.abigen_opts;
+  if (!abidef_output_opt.empty()) {
+    std::string abidef;
+    Cache::ReadFile(abidef_output_opt, abidef);
+    flags.push_back(abidef);
+    files.emplace_back("abidef",
+                       TempPath(llvm::sys::path::filename(abidef_output_opt).str()));
+  }
+
+  std::string key = SourceKey("abigen", opts.inputs, flags, opts);
+  if (!key.empty() && cache->Fetch(key, files)) {
+    return true;
+  }
+
+  // Never store the outputs of an earlier run if this one fails.
+  llvm::sys::fs::remove(opts.abi_filename);
+  llvm::sys::fs::remove(opts.exports_filename);
+  bool ok =
+      platon::cdt::runtime::exec_subprogram("platon-abigen", opts.abigen_opts);
+  ok = ok && llvm::sys::fs::exists(opts.abi_filename);
+  if (ok && !key.empty()) {
+    cache->Store(key, files);
+  }
+  return ok;
+}
+
+struct CompileJob {
+  std::string input;
+  std::string output;
+  // abigen's copy of the input with the generated entry points, if any.
+  std::string tmp_file;
+  // Captures the diagnostics of a parallel compile.
+  std::string log_file;
+  bool ok = false;
+};
+
+static void Compile(CompileJob& job, const Options& opts, bool capture,
+                    Cache* cache) {
+  std::vector<std::string> new_opts = opts.compiler_opts;
+  if (!opts.pch.empty() && UsesPlatonPch(job.input)) {
+    new_opts.emplace_back("-include-pch");
+    new_opts.emplace_back(opts.pch);
+  }
+
+  std::string key;
+  platon::cdt::cache::EntryFiles files = {{"bitcode", job.output}};
+  if (cache) {
+    std::vector<std::string> flags = new_opts;
+    if (!opts.pch.empty()) {
+      flags.push_back(Cache::ToolStamp(opts.pch));
+    }
+    key = SourceKey("compile", {job.input}, flags, opts);
+    if (!key.empty() && cache->Fetch(key, files)) {
+      job.ok = true;
+      return;
+    }
+  }
+
+  new_opts.insert(new_opts.begin(), job.input);
+  new_opts.insert(new_opts.begin(), job.output);
+  new_opts.insert(new_opts.begin(), "-o");
+  job.ok = platon::cdt::runtime::exec_subprogram(
+      CLANG, new_opts, false, capture ? job.log_file : std::string());
+  if (job.ok && !key.empty()) {
+    cache->Store(key, files);
+  }
+}
+
+// Compiles every input, on up to opts.jobs threads. Parallel compiles write
+// their diagnostics to a log each, which is printed whole and in input order
+// so messages from different files never interleave.
+static bool RunCompileJobs(std::vector<CompileJob>& jobs, const Options& opts,
+                           Cache* cache) {
+  unsigned workers = opts.jobs;
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers = std::min<size_t>(workers, jobs.size());
+  bool capture = workers > 1;
+
+  if (!capture) {
+    bool ok = true;
+    for (auto& job : jobs) {
+      if (ok) {
+        Compile(job, opts, false, cache);
+        ok = job.ok;
+      }
+      llvm::sys::fs::remove(job.log_file);
+      llvm::sys::fs::remove(job.tmp_file);
+    }
+    return ok;
+  }
+
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+  for (unsigned i = 0; i < workers; i++) {
+    pool.emplace_back([&]() {
+      for (size_t j = next++; j < jobs.size(); j = next++) {
+        Compile(jobs[j], opts, true, cache);
+      }
+    });
+  }
+  for (auto& t : pool) {
+    t.join();
+  }
+
+  bool ok = true;
+  for (auto& job : jobs) {
+    std::string log;
+    if (Cache::ReadFile(job.log_file, log)) {
+      llvm::errs() << log;
+    }
+    llvm::sys::fs::remove(job.log_file);
+    llvm::sys::fs::remove(job.tmp_file);
+    ok = ok && job.ok;
+  }
+  return ok;
+}
+
 int main(int argc, const char** argv) {
   for (auto i = 0; i < argc; i++) {
     if (argv[i] == std::string("-v")) {
@@ -38,69 +259,122 @@ int main(int argc, const char** argv) {
   cl::ParseCommandLineOptions(
       argc, argv, kCompilerName + " (Platon C++ -> WebAssembly compiler)");
   auto opts = CreateOptions();
+  StepTimer total(opts, "total");
+  std::unique_ptr<Cache> cache;
+  if (opts.cache) {
+    cache.reset(new Cache(opts.cache_dir, opts.cache_size));
+  }
 
   if (opts.abigen) {
-    platon::cdt::runtime::exec_subprogram("platon-abigen", opts.abigen_opts);
-    if (!llvm::sys::fs::exists(opts.abi_filename)) {
+    StepTimer timer(opts, "abigen");
+    if (!RunAbigen(opts, cache.get())) {
       return -1;
     }
   }
 
-  std::vector<std::string> outputs;
-  try {
-    for (auto input : opts.inputs) {
-      std::vector<std::string> new_opts = opts.compiler_opts;
-      llvm::SmallString<64> res;
-      llvm::sys::path::system_temp_directory(true, res);
-      std::string tmp_file = std::string(res.c_str()) + "/" +
-                             llvm::sys::path::filename(input).str();
-      std::string output;
-
-      if (llvm::sys::fs::exists(tmp_file)) {
-        input = tmp_file;
-      }
-      output = tmp_file + ".o";
+  if (!opts.link && opts.inputs.size() > 1 && !o_opt.empty()) {
+    llvm::errs() << kCompilerName
+                 << ": -o can't be used with -c and several inputs\n";
+    return -1;
+  }
 
-      new_opts.insert(new_opts.begin(), input);
+  // abigen's copy of an input is only known by its file name, and -c writes
+  // <stem>.o for several inputs, so those names must not repeat.
+  std::set<std::string> names;
+  std::set<std::string> objects;
+  for (const auto& input : opts.inputs) {
+    std::string name = llvm::sys::path::filename(input).str();
+    if (opts.abigen && !names.insert(name).second) {
+      llvm::errs() << kCompilerName << ": two inputs are named " << name
+                   << ", which -abigen can't tell apart\n";
+      return -1;
+    }
+    llvm::SmallString<256> object(name);
+    llvm::sys::path::replace_extension(object, ".o");
+    if (!opts.link && opts.inputs.size() > 1 &&
+        !objects.insert(object.c_str()).second) {
+      llvm::errs() << kCompilerName << ": two inputs would write "
+                   << object.c_str() << "\n";
+      return -1;
+    }
+  }
 
-      if (!opts.link) {
-        output = opts.output_filename.empty() ? "a.out" : opts.output_filename;
-      }
+  // Objects and logs get a temp file of their own per input.
+  std::vector<CompileJob> jobs;
+  for (auto input : opts.inputs) {
+    CompileJob job;
+    std::string name = llvm::sys::path::filename(input).str();
+    job.tmp_file = TempPath(name);
 
-      new_opts.insert(new_opts.begin(), "-o " + output);
-      outputs.push_back(output);
+    if (llvm::sys::fs::exists(job.tmp_file)) {
+      input = job.tmp_file;
+    }
+    job.input = input;
 
-      if (!platon::cdt::runtime::exec_subprogram(CLANG, new_opts)) {
-        llvm::sys::fs::remove(tmp_file);
-        return -1;
+    bool ok = UniqueTempPath(name, "log", job.log_file);
+    if (opts.link) {
+      ok = ok && UniqueTempPath(name, "o", job.output);
+    } else if (opts.inputs.size() == 1) {
+      job.output =
+          opts.output_filename.empty() ? "a.out" : opts.output_filename;
+    } else {
+      llvm::SmallString<256> object(name);
+      llvm::sys::path::replace_extension(object, ".o");
+      job.output = std::string(object.c_str());
+    }
+    jobs.push_back(job);
+    if (!ok) {
+      llvm::errs() << kCompilerName << ": can't create a temporary file for "
+                   << name << "\n";
+      for (const auto& created : jobs) {
+        llvm::sys::fs::remove(created.log_file);
+        if (opts.link) {
+          llvm::sys::fs::remove(created.output);
+        }
       }
-      llvm::sys::fs::remove(tmp_file);
+      return -1;
+    }
+  }
+
+  try {
+    StepTimer timer(opts, "compile " + std::to_string(jobs.size()) + " files");
+    if (!RunCompileJobs(jobs, opts, cache.get())) {
+      return -1;
     }
   } catch (std::runtime_error& err) {
     llvm::errs() << err.what() << '\n';
     return -1;
   }
 
+  std::vector<std::string> outputs;
+  for (const auto& job : jobs) {
+    outputs.push_back(job.output);
+  }
+
   if (opts.link) {
+    StepTimer timer(opts, "link");
     std::vector<std::string> new_opts = opts.ld_opts;
     for (const auto& output : outputs) {
-      new_opts.insert(new_opts.begin(), std::string(" ") + output + " ");
+      new_opts.insert(new_opts.begin(), output);
     }
 
     if (opts.abigen) {
       std::fstream fs(opts.exports_filename);
       std::string line;
       while (std::getline(fs, line)) {
-        new_opts.emplace_back(" --export " + line + " ");
+        new_opts.emplace_back("--export");
+        new_opts.emplace_back(line);
       }
     } else {
-      new_opts.emplace_back(" --export _Z4mainiPPc ");
+      new_opts.emplace_back("--export");
+      new_opts.emplace_back("_Z4mainiPPc");
     }
 
-    if (!platon::cdt::runtime::exec_subprogram("platon-ld", new_opts)) {
-      for (const auto& output : outputs) {
-        llvm::sys::fs::remove(output);
-      }
+    bool ok = platon::cdt::runtime::exec_subprogram("platon-ld", new_opts);
+    for (const auto& output : outputs) {
+      llvm::sys::fs::remove(output);
+    }
+    if (!ok) {
       return -1;
     }
 
@@ -108,5 +382,14 @@ int main(int argc, const char** argv) {
       return -1;
     }
   }
+
+  if (opts.cache_stats) {
+    // Flush this run's counts first so they are part of the totals.
+    cache.reset();
+    auto stats = Cache(opts.cache_dir, UINT64_MAX).GetStats();
+    llvm::errs() << kCompilerName << ": cache hits " << stats.hits
+                 << " misses " << stats.misses << " entries " << stats.entries
+                 << " size " << stats.size << " bytes\n";
+  }
   return 0;
 }
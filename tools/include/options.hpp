@@ -1,13 +1,18 @@
 #ifndef __OPTIONS_H_
 #define __OPTIONS_H_
 
+#include <algorithm>
+#include <fstream>
+#include <regex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 
+#include "platon/cache.hpp"
 #include "platon/utils.hpp"
 
 #ifdef ONLY_LD
@@ -39,6 +44,77 @@ static llvm::cl::opt<std::string> export_file_opt(
   llvm::cl::cat(LD_CAT));
 #endif
 
+static llvm::cl::opt<bool> host_builtins_opt(
+    "host-builtins",
+    llvm::cl::desc("Import the 128-bit integer and long double compiler "
+                   "builtins from the VM instead of linking libbuiltins"),
+    llvm::cl::cat(LD_CAT));
+
+enum class Allocator { Host, Arena, ArenaFreelist };
+static llvm::cl::opt<Allocator> allocator_opt(
+    "allocator", llvm::cl::desc("Heap allocator to link"),
+    llvm::cl::values(
+        clEnumValN(Allocator::Host, "host", "malloc/free imported from the VM"),
+        clEnumValN(Allocator::Arena, "arena", "per-call bump allocator"),
+        clEnumValN(Allocator::ArenaFreelist, "arena-freelist",
+                   "bump allocator with size-class free lists")),
+    llvm::cl::init(Allocator::Host), llvm::cl::cat(LD_CAT));
+
+enum class Profile { Speed, Balanced, Size };
+static llvm::cl::opt<Profile> profile_opt(
+    "profile", llvm::cl::desc("Optimization profile of compile and link"),
+    llvm::cl::values(
+        clEnumValN(Profile::Speed, "speed", "-O3 compile and LTO"),
+        clEnumValN(Profile::Balanced, "balanced", "-O2 compile and LTO"),
+        clEnumValN(Profile::Size, "size",
+                   "-Oz compile, -O2 LTO and the post-link optimizer")),
+    llvm::cl::init(Profile::Speed), llvm::cl::cat(LD_CAT));
+
+// Optimization level of the compile step of the selected profile.
+static std::string ProfileOptLevel() {
+  switch (profile_opt) {
+    case Profile::Balanced:
+      return "-O2";
+    case Profile::Size:
+      return "-Oz";
+    default:
+      return "-O3";
+  }
+}
+
+static llvm::cl::opt<bool> keep_names_opt(
+    "keep-names",
+    llvm::cl::desc("Keep the function names section for platon-size instead "
+                   "of stripping all symbols"),
+    llvm::cl::cat(LD_CAT));
+
+static llvm::cl::opt<bool> thinlto_opt(
+    "thinlto",
+    llvm::cl::desc("Compile for ThinLTO and link with parallel, cached LTO "
+                   "backends"),
+    llvm::cl::cat(LD_CAT));
+static llvm::cl::opt<unsigned> thinlto_jobs_opt(
+    "thinlto-jobs",
+    llvm::cl::desc("Run up to <N> ThinLTO backends in parallel, 0 for one per "
+                   "hardware thread"),
+    llvm::cl::value_desc("N"), llvm::cl::init(0), llvm::cl::cat(LD_CAT));
+static llvm::cl::opt<std::string> lto_cache_dir_opt(
+    "lto-cache-dir",
+    llvm::cl::desc("ThinLTO cache directory, default = the lto/ directory of "
+                   "the compilation cache"),
+    llvm::cl::cat(LD_CAT));
+
+static llvm::cl::opt<bool> wasm_opt_opt(
+    "wasm-opt",
+    llvm::cl::desc("Optimize the linked module: merge identical functions, "
+                   "drop dead imports and exports, compact data segments and "
+                   "reorder locals"),
+    llvm::cl::cat(LD_CAT));
+static llvm::cl::opt<bool> wasm_opt_report_opt(
+    "wasm-opt-report",
+    llvm::cl::desc("Print the bytes saved by -wasm-opt"),
+    llvm::cl::cat(LD_CAT));
+
 static llvm::cl::opt<std::string> o_opt(
     "o", llvm::cl::desc("Write output to <file>"), llvm::cl::cat(LD_CAT));
 static llvm::cl::list<std::string> input_filename_opt(
@@ -52,6 +128,10 @@ static llvm::cl::list<std::string> I_opt(
     "I", llvm::cl::desc("Add directory to include search path"),
     llvm::cl::cat(PlatonCompilerToolCategory), llvm::cl::Prefix,
     llvm::cl::ZeroOrMore);
+static llvm::cl::list<std::string> D_opt(
+    "D", llvm::cl::desc("Define a macro, as in -DNAME or -DNAME=VALUE"),
+    llvm::cl::cat(PlatonCompilerToolCategory), llvm::cl::Prefix,
+    llvm::cl::ZeroOrMore);
 static llvm::cl::opt<bool> abigen_opt("abigen",
                                       llvm::cl::desc("Generate abi file"),
                                       llvm::cl::cat(LD_CAT));
@@ -61,6 +141,45 @@ static llvm::cl::opt<std::string> abigen_output_opt(
 static llvm::cl::opt<std::string> exports_output_opt(
     "exports_output", llvm::cl::desc("exports output"),
     llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<bool> dispatch_opt(
+    "dispatch",
+    llvm::cl::desc("Export a single `invoke` entry that dispatches on the "
+                   "call data (needs -abigen)"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<unsigned> jobs_opt(
+    "j",
+    llvm::cl::desc("Compile up to <N> inputs in parallel, 0 for one per "
+                   "hardware thread"),
+    llvm::cl::value_desc("N"), llvm::cl::init(1), llvm::cl::Prefix,
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<bool> time_opt(
+    "time",
+    llvm::cl::desc("Report the wall time of the abigen, compile and link "
+                   "steps"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<bool> cache_opt(
+    "cache",
+    llvm::cl::desc("Reuse bitcode and ABI outputs from the compilation cache"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<std::string> cache_dir_opt(
+    "cache-dir",
+    llvm::cl::desc("Compilation cache directory, default = "
+                   "$PLATON_CDT_CACHE_DIR or ~/.cache/platon-cdt"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<unsigned> cache_size_opt(
+    "cache-size",
+    llvm::cl::desc("Evict least recently used cache entries above <MB>"),
+    llvm::cl::value_desc("MB"), llvm::cl::init(1024),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<bool> cache_stats_opt(
+    "cache-stats",
+    llvm::cl::desc("Print the compilation cache statistics after the build"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
+static llvm::cl::opt<bool> no_pch_opt(
+    "no-pch",
+    llvm::cl::desc("Parse platon/platon.hpp instead of using its precompiled "
+                   "header"),
+    llvm::cl::cat(PlatonCompilerToolCategory));
 static llvm::cl::opt<std::string> abidef_output_opt(
   "abidef_output",
   llvm::cl::desc("abi define output"),
@@ -72,19 +191,32 @@ struct Options {
   std::vector<std::string> inputs;
   bool link;
   bool abigen;
+  unsigned jobs;
+  bool time;
+  bool cache;
+  bool cache_stats;
+  std::string cache_dir;
+  uint64_t cache_size;
+  // The precompiled platon/platon.hpp, empty if there is none to use.
+  std::string pch;
   std::vector<std::string> compiler_opts;
   std::vector<std::string> ld_opts;
   std::vector<std::string> abigen_opts;
   std::string abi_filename;
   std::string exports_filename;
   std::string export_file;
+  bool wasm_opt;
+  bool wasm_opt_report;
   std::string abidef_output;
 };
 
 static void GetCompilerOptDefaults(std::vector<std::string>& opts) {
   opts.emplace_back("-std=c++17");
   opts.emplace_back("-emit-llvm");
-  opts.emplace_back("-O3");
+  opts.emplace_back(ProfileOptLevel());
+  if (thinlto_opt) {
+    opts.emplace_back("-flto=thin");
+  }
   opts.emplace_back("--target=wasm32");
   opts.emplace_back("-ffreestanding");
   opts.emplace_back("-nostdlib");
@@ -98,16 +230,82 @@ static void GetCompilerOptDefaults(std::vector<std::string>& opts) {
   opts.emplace_back("-DRAPIDJSON_64BIT=1");
 }
 
+#ifndef ONLY_LD
+// Whether a -D macro leaves the precompiled platon/platon.hpp valid. The
+// header never tests PLATON_TEST_HOST; NDEBUG only switches assert(), which
+// the inline code of the PCH keeps as it was built, as a prebuilt library
+// would.
+static bool KeepsPlatonPch(const std::string& define) {
+  std::string name = define.substr(0, define.find('='));
+  return name == "PLATON_TEST_HOST" || name == "NDEBUG";
+}
+
+// The precompiled header can only stand in for platon/platon.hpp when that is
+// the first thing a source includes: a macro defined before the include could
+// change what the header expands to.
+static bool UsesPlatonPch(const std::string& input) {
+  static const std::regex include(
+      "^#[ \t]*include[ \t]*[\"<]platon/platon\\.hpp[\">]");
+  std::ifstream in(input);
+  std::string line;
+  bool comment = false;
+  while (std::getline(in, line)) {
+    line.erase(0, line.find_first_not_of(" \t\r"));
+    if (comment) {
+      comment = line.find("*/") == std::string::npos;
+      continue;
+    }
+    if (line.empty() || line.compare(0, 2, "//") == 0) {
+      continue;
+    }
+    if (line.compare(0, 2, "/*") == 0) {
+      comment = line.find("*/", 2) == std::string::npos;
+      continue;
+    }
+    return std::regex_search(line, include);
+  }
+  return false;
+}
+#endif
+
 #ifdef ONLY_LD
 static void GetLdOptDefaults(std::vector<std::string>& opts) {
-  opts.emplace_back("-O3");
-  opts.emplace_back("--lto-O3");
+  // wasm-ld has no size level, -Oz bitcode keeps its minsize attributes.
+  if (profile_opt == Profile::Speed) {
+    opts.emplace_back("-O3");
+    opts.emplace_back("--lto-O3");
+  } else {
+    opts.emplace_back("-O2");
+    opts.emplace_back("--lto-O2");
+  }
+  if (thinlto_opt) {
+    // The ThinLTO builds of the bundled libraries, found before lib/.
+    opts.emplace_back("-L" + platon::cdt::utils::where() + "/../lib/thin");
+    unsigned jobs = thinlto_jobs_opt;
+    if (jobs == 0) {
+      jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    opts.emplace_back("--thinlto-jobs=" + std::to_string(jobs));
+    opts.emplace_back("--thinlto-cache-dir=" +
+                      (lto_cache_dir_opt.empty()
+                           ? platon::cdt::cache::Cache::DefaultDir() + "/lto"
+                           : std::string(lto_cache_dir_opt)));
+  }
   opts.emplace_back("--gc-sections");
-  opts.emplace_back("--strip-all");
+  opts.emplace_back(keep_names_opt ? "--strip-debug" : "--strip-all");
   opts.emplace_back("--merge-data-segments");
   opts.emplace_back("--allow-undefined");
   opts.emplace_back("--no-entry");
-  opts.emplace_back("-lc++ -lc");
+  opts.emplace_back("-lc++");
+  opts.emplace_back("-lc");
+  if (!host_builtins_opt) {
+    opts.emplace_back("-lbuiltins");
+  }
+  if (allocator_opt == Allocator::Arena) {
+    opts.emplace_back("-larena");
+  } else if (allocator_opt == Allocator::ArenaFreelist) {
+    opts.emplace_back("-larena_freelist");
+  }
 }
 #endif
 
@@ -121,6 +319,24 @@ static Options CreateOptions() {
 #endif
 
 #ifndef ONLY_LD
+  opts.jobs = jobs_opt;
+  opts.time = time_opt;
+  opts.cache = cache_opt;
+  opts.cache_stats = cache_stats_opt;
+  opts.cache_dir = cache_dir_opt.empty()
+                       ? platon::cdt::cache::Cache::DefaultDir()
+                       : std::string(cache_dir_opt);
+  opts.cache_size = uint64_t(cache_size_opt) << 20;
+  // One PCH per profile, as the optimization level is part of its flags. A
+  // -D macro can change what platon.hpp expands to, so one outside
+  // KeepsPlatonPch disables the PCH.
+  std::string pch = platon::cdt::utils::where() +
+                    "/../include/platon/platon.hpp" + ProfileOptLevel() +
+                    ".pch";
+  if (!no_pch_opt && std::all_of(D_opt.begin(), D_opt.end(), KeepsPlatonPch) &&
+      llvm::sys::fs::exists(pch)) {
+    opts.pch = pch;
+  }
   opts.abigen = false;
   if (abigen_opt) {
     opts.abigen = true;
@@ -136,6 +352,37 @@ static Options CreateOptions() {
                                   platon::cdt::utils::where() + "/../include");
   }
 
+  if (host_builtins_opt) {
+    opts.ld_opts.emplace_back("-host-builtins");
+  }
+  if (profile_opt == Profile::Balanced) {
+    opts.ld_opts.emplace_back("-profile=balanced");
+  } else if (profile_opt == Profile::Size) {
+    opts.ld_opts.emplace_back("-profile=size");
+  }
+  if (keep_names_opt) {
+    opts.ld_opts.emplace_back("-keep-names");
+  }
+  if (thinlto_opt) {
+    opts.ld_opts.emplace_back("-thinlto");
+    opts.ld_opts.emplace_back("-thinlto-jobs=" +
+                              std::to_string(thinlto_jobs_opt));
+    if (!lto_cache_dir_opt.empty()) {
+      opts.ld_opts.emplace_back("-lto-cache-dir=" + lto_cache_dir_opt);
+    }
+  }
+  if (wasm_opt_opt) {
+    opts.ld_opts.emplace_back("-wasm-opt");
+  }
+  if (wasm_opt_report_opt) {
+    opts.ld_opts.emplace_back("-wasm-opt-report");
+  }
+  if (allocator_opt == Allocator::Arena) {
+    opts.ld_opts.emplace_back("-allocator=arena");
+  } else if (allocator_opt == Allocator::ArenaFreelist) {
+    opts.ld_opts.emplace_back("-allocator=arena-freelist");
+  }
+
   if (c_opt) {
     opts.link = false;
     opts.compiler_opts.emplace_back("-c");
@@ -145,6 +392,10 @@ static Options CreateOptions() {
     opts.compiler_opts.emplace_back("-I" + inc_dir);
     opts.abigen_opts.emplace_back("-extra-arg=-I" + inc_dir);
   }
+  for (auto define : D_opt) {
+    opts.compiler_opts.emplace_back("-D" + define);
+    opts.abigen_opts.emplace_back("-extra-arg=-D" + define);
+  }
 #endif
 
 #ifdef ONLY_LD
@@ -172,7 +423,8 @@ static Options CreateOptions() {
 
 #ifndef ONLY_LD
   if (abigen_opt && opts.inputs.size() > 0) {
-    opts.abigen_opts.push_back(opts.inputs[0]);
+    opts.abigen_opts.insert(opts.abigen_opts.end(), opts.inputs.begin(),
+                            opts.inputs.end());
     std::string abigen_output = abigen_output_opt;
     llvm::SmallString<256> fn = llvm::sys::path::filename(opts.inputs[0]);
     if (abigen_output_opt.empty()) {
@@ -190,6 +442,24 @@ static Options CreateOptions() {
     opts.abigen_opts.emplace_back("-abigen_output=" + abigen_output);
     opts.abigen_opts.emplace_back("-exports_output=" + exports_output);
     opts.abigen_opts.emplace_back("-abidef_output=" + abidef_output_opt);
+    if (dispatch_opt) {
+      opts.abigen_opts.emplace_back("-dispatch");
+    }
+    // The PCH is only valid with the flags it was built with.
+    if (!opts.pch.empty() && std::all_of(opts.inputs.begin(),
+                                         opts.inputs.end(), UsesPlatonPch)) {
+      std::vector<std::string> pch_opts;
+      GetCompilerOptDefaults(pch_opts);
+      for (const auto& opt : pch_opts) {
+        if (opt != "-emit-llvm") {
+          opts.abigen_opts.emplace_back("-extra-arg=" + opt);
+        }
+      }
+      opts.abigen_opts.emplace_back("-extra-arg=--sysroot=" +
+                                    platon::cdt::utils::where() + "/../");
+      opts.abigen_opts.emplace_back("-extra-arg=-include-pch");
+      opts.abigen_opts.emplace_back("-extra-arg=" + opts.pch);
+    }
     opts.abigen_opts.emplace_back("--");
     opts.abigen_opts.emplace_back("-w");
   }
@@ -203,38 +473,31 @@ static Options CreateOptions() {
     opts.ld_opts.emplace_back("-L" + opt);
   }
   for (const auto& opt : export_opt) {
-    opts.ld_opts.emplace_back("--export " + opt);
+    opts.ld_opts.emplace_back("--export");
+    opts.ld_opts.emplace_back(opt);
   }
   opts.export_file = export_file_opt;
+  opts.wasm_opt = wasm_opt_opt || wasm_opt_report_opt ||
+                  profile_opt == Profile::Size;
+  opts.wasm_opt_report = wasm_opt_report_opt;
 #endif
 
   if (o_opt.empty()) {
-#ifndef ONLY_LD
+    // platon-cpp passes its objects to platon-ld itself.
     if (opts.inputs.size() == 1) {
       llvm::SmallString<256> fn = llvm::sys::path::filename(opts.inputs[0]);
-      llvm::SmallString<256> fn2 = fn;
       llvm::sys::path::replace_extension(fn, ".wasm");
+      opts.ld_opts.emplace_back("-o");
+      opts.ld_opts.emplace_back(std::string(fn.str()));
       opts.output_filename = fn.str();
-      llvm::SmallString<256> res;
-      llvm::sys::path::system_temp_directory(true, res);
-      opts.ld_opts.emplace_back(std::string(std::string(res.str()) + "/" +
-                                            std::string(fn2.str()) + ".o"));
     } else {
+      opts.ld_opts.emplace_back("-o");
       opts.ld_opts.emplace_back("a.out");
-    }
-#endif
-
-    if (opts.inputs.size() == 1) {
-      llvm::SmallString<256> fn = llvm::sys::path::filename(opts.inputs[0]);
-      llvm::sys::path::replace_extension(fn, ".wasm");
-      opts.ld_opts.emplace_back("-o " + std::string(fn.str()));
-      opts.output_filename = fn.str();
-    } else {
-      opts.ld_opts.emplace_back("-o a.out");
       opts.output_filename = "a.out";
     }
   } else {
-    opts.ld_opts.emplace_back("-o " + o_opt);
+    opts.ld_opts.emplace_back("-o");
+    opts.ld_opts.emplace_back(o_opt);
     opts.output_filename = o_opt;
   }
   return opts;
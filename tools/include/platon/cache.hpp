@@ -0,0 +1,246 @@
+#ifndef __CACHE_H_
+#define __CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+namespace platon {
+namespace cdt {
+namespace cache {
+
+// The files of one build step: their name inside a cache entry and the path
+// they are copied from on a store, or to on a hit.
+typedef std::vector<std::pair<std::string, std::string>> EntryFiles;
+
+struct Stats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t entries = 0;
+  uint64_t size = 0;
+};
+
+// Content-addressed store for build outputs, shared by every tool of the
+// toolchain. An entry lives in <dir>/<key[0,2)>/<key>; its "stamp" file holds
+// the time of the last store or hit, and the least recently used entries are
+// evicted first once the cache grows past its size limit. Entries are built
+// in <dir>/tmp and renamed into place, so concurrent builds never see a
+// partial entry.
+class Cache {
+ public:
+  Cache(std::string dir, uint64_t max_size)
+      : dir_(std::move(dir)), max_size_(max_size) {}
+
+  // Records this run's statistics and trims the cache to its size limit.
+  ~Cache() {
+    std::ofstream log(dir_ + "/stats", std::ios::app);
+    if (log.is_open() && (hits_ != 0 || misses_ != 0)) {
+      log << hits_ << " " << misses_ << "\n";
+    }
+    log.close();
+    Evict();
+  }
+
+  // $PLATON_CDT_CACHE_DIR, or ~/.cache/platon-cdt.
+  static std::string DefaultDir() {
+    if (const char* dir = std::getenv("PLATON_CDT_CACHE_DIR")) {
+      return dir;
+    }
+    llvm::SmallString<128> home;
+    llvm::sys::path::home_directory(home);
+    llvm::sys::path::append(home, ".cache", "platon-cdt");
+    return std::string(home.str());
+  }
+
+  // Hashes the parts of a key, which have to cover everything the outputs
+  // depend on. Each part is length-prefixed so their boundaries count.
+  static std::string Key(const std::vector<std::string>& parts) {
+    llvm::MD5 hash;
+    for (const auto& part : parts) {
+      hash.update(std::to_string(part.size()) + ":");
+      hash.update(part);
+    }
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    return std::string(result.digest().str());
+  }
+
+  // Identifies a tool binary by its size and modification time, so a
+  // rebuilt toolchain never reuses outputs of the previous one.
+  static std::string ToolStamp(const std::string& path) {
+    llvm::sys::fs::file_status status;
+    if (llvm::sys::fs::status(path, status)) {
+      return path;
+    }
+    return path + ":" + std::to_string(status.getSize()) + ":" +
+           std::to_string(
+               status.getLastModificationTime().time_since_epoch().count());
+  }
+
+  static bool ReadFile(const std::string& path, std::string& content) {
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      return false;
+    }
+    content = (*buffer)->getBuffer().str();
+    return true;
+  }
+
+  // Copies the files of entry key to their paths. Files the entry does not
+  // hold are left alone.
+  bool Fetch(const std::string& key, const EntryFiles& files) {
+    std::string entry = EntryPath(key);
+    if (!llvm::sys::fs::exists(entry + "/stamp")) {
+      misses_++;
+      return false;
+    }
+    for (const auto& file : files) {
+      std::string cached = entry + "/" + file.first;
+      if (!llvm::sys::fs::exists(cached)) {
+        continue;
+      }
+      if (llvm::sys::fs::copy_file(cached, file.second)) {
+        misses_++;
+        return false;
+      }
+    }
+    WriteStamp(entry);
+    hits_++;
+    return true;
+  }
+
+  // Adds the files that exist to a new entry key.
+  void Store(const std::string& key, const EntryFiles& files) {
+    std::string entry = EntryPath(key);
+    if (llvm::sys::fs::exists(entry)) {
+      return;
+    }
+    llvm::SmallString<128> tmp;
+    if (llvm::sys::fs::create_directories(dir_ + "/tmp") ||
+        llvm::sys::fs::createUniqueDirectory(dir_ + "/tmp/entry", tmp)) {
+      return;
+    }
+    std::string tmp_dir(tmp.str());
+    for (const auto& file : files) {
+      if (!llvm::sys::fs::exists(file.second)) {
+        continue;
+      }
+      if (llvm::sys::fs::copy_file(file.second, tmp_dir + "/" + file.first)) {
+        llvm::sys::fs::remove_directories(tmp_dir);
+        return;
+      }
+    }
+    WriteStamp(tmp_dir);
+    llvm::sys::fs::create_directories(llvm::sys::path::parent_path(entry));
+    // Another build may have stored the same entry in the meantime.
+    if (llvm::sys::fs::rename(tmp_dir, entry)) {
+      llvm::sys::fs::remove_directories(tmp_dir);
+    }
+  }
+
+  // Hits and misses over every run recorded so far, and the current size.
+  Stats GetStats() const {
+    Stats stats;
+    std::ifstream log(dir_ + "/stats");
+    uint64_t hits = 0, misses = 0;
+    while (log >> hits >> misses) {
+      stats.hits += hits;
+      stats.misses += misses;
+    }
+    for (const auto& entry : Entries()) {
+      stats.entries++;
+      stats.size += entry.size;
+    }
+    return stats;
+  }
+
+ private:
+  struct EntryInfo {
+    std::string path;
+    uint64_t used;
+    uint64_t size;
+  };
+
+  std::string EntryPath(const std::string& key) const {
+    return dir_ + "/" + key.substr(0, 2) + "/" + key;
+  }
+
+  static void WriteStamp(const std::string& entry) {
+    std::ofstream stamp(entry + "/stamp", std::ios::trunc);
+    stamp << std::time(nullptr) << "\n";
+  }
+
+  std::vector<EntryInfo> Entries() const {
+    namespace fs = llvm::sys::fs;
+    std::vector<EntryInfo> entries;
+    std::error_code ec;
+    for (fs::directory_iterator shard(dir_, ec), end; shard != end && !ec;
+         shard.increment(ec)) {
+      if (llvm::sys::path::filename(shard->path()).size() != 2) {
+        continue;
+      }
+      std::error_code shard_ec;
+      for (fs::directory_iterator it(shard->path(), shard_ec);
+           it != end && !shard_ec; it.increment(shard_ec)) {
+        EntryInfo entry{it->path(), 0, 0};
+        std::ifstream stamp(entry.path + "/stamp");
+        stamp >> entry.used;
+        std::error_code file_ec;
+        for (fs::directory_iterator file(entry.path, file_ec);
+             file != end && !file_ec; file.increment(file_ec)) {
+          uint64_t size = 0;
+          if (!fs::file_size(file->path(), size)) {
+            entry.size += size;
+          }
+        }
+        entries.push_back(entry);
+      }
+    }
+    return entries;
+  }
+
+  void Evict() const {
+    auto entries = Entries();
+    uint64_t total = 0;
+    for (const auto& entry : entries) {
+      total += entry.size;
+    }
+    if (total <= max_size_) {
+      return;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const EntryInfo& a, const EntryInfo& b) {
+                return a.used < b.used;
+              });
+    for (const auto& entry : entries) {
+      if (total <= max_size_) {
+        break;
+      }
+      llvm::sys::fs::remove_directories(entry.path);
+      total -= entry.size;
+    }
+  }
+
+  std::string dir_;
+  uint64_t max_size_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace cache
+}  // namespace cdt
+}  // namespace platon
+
+#endif  // __CACHE_H_
@@ -3,11 +3,11 @@
 
 #include <string>
 #include <vector>
-#include <sstream>
 
 #include "boost/dll/runtime_symbol_info.hpp"
 #include "boost/filesystem.hpp"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace platon {
 namespace cdt {
@@ -24,21 +24,37 @@ static std::string pwd() {
 } // namespace utils
 
 namespace runtime {
+// Runs prog with options as its argument vector, without a shell, and
+// reports whether it exited with status 0. With error_file set, its stderr
+// goes to that file instead of the terminal.
 static bool exec_subprogram(const std::string prog,
                             std::vector<std::string> options,
-                            bool root = false) {
-  std::stringstream args;
-  for (const auto& s : options) {
-    args << s << " ";
-  }
+                            bool root = false,
+                            const std::string& error_file = std::string()) {
   std::string find_path = utils::where();
   if (root) find_path = "/usr/bin";
-  if (auto path = llvm::sys::findProgramByName(prog.c_str(), {find_path})) {
-    std::system((*path + " " + args.str()).c_str());
-  } else {
+  auto path = llvm::sys::findProgramByName(prog.c_str(), {find_path});
+  if (!path) {
     return false;
   }
-  return true;
+
+  std::vector<llvm::StringRef> args;
+  args.push_back(*path);
+  for (const auto& s : options) {
+    args.push_back(s);
+  }
+  std::vector<llvm::Optional<llvm::StringRef>> redirects;
+  if (!error_file.empty()) {
+    redirects = {llvm::None, llvm::None, llvm::StringRef(error_file)};
+  }
+
+  std::string error;
+  int status = llvm::sys::ExecuteAndWait(*path, args, llvm::None, redirects,
+                                         0, 0, &error);
+  if (status < 0) {
+    llvm::errs() << prog << ": " << error << "\n";
+  }
+  return status == 0;
 }
 
 }  // namespace runtime
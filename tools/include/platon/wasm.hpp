@@ -0,0 +1,163 @@
+#ifndef __WASM_H_
+#define __WASM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace platon {
+namespace cdt {
+namespace wasm {
+
+typedef std::vector<uint8_t> Bytes;
+
+static const uint8_t kHeader[] = {0, 'a', 's', 'm', 1, 0, 0, 0};
+
+enum SectionId : uint8_t {
+  kCustomSection = 0,
+  kTypeSection = 1,
+  kImportSection = 2,
+  kFunctionSection = 3,
+  kTableSection = 4,
+  kMemorySection = 5,
+  kGlobalSection = 6,
+  kExportSection = 7,
+  kStartSection = 8,
+  kElementSection = 9,
+  kCodeSection = 10,
+  kDataSection = 11,
+  kDataCountSection = 12,
+};
+
+enum ExternalKind : uint8_t {
+  kExternalFunction = 0,
+  kExternalTable = 1,
+  kExternalMemory = 2,
+  kExternalGlobal = 3,
+};
+
+inline const char* SectionName(uint8_t id) {
+  static const char* const names[] = {
+      "custom", "type",  "import", "function", "table", "memory",   "global",
+      "export", "start", "elem",   "code",     "data",  "datacount"};
+  return id < sizeof(names) / sizeof(names[0]) ? names[id] : "unknown";
+}
+
+// Thrown for a truncated or malformed module.
+class Error : public std::runtime_error {
+ public:
+  explicit Error(const std::string& what) : std::runtime_error(what) {}
+};
+
+// Reads the binary encoding of a module, or of one of its sections.
+class Reader {
+ public:
+  Reader(const uint8_t* begin, const uint8_t* end) : p_(begin), end_(end) {}
+  explicit Reader(const Bytes& bytes)
+      : Reader(bytes.data(), bytes.data() + bytes.size()) {}
+
+  bool Done() const { return p_ == end_; }
+
+  uint8_t U8() {
+    Need(1);
+    return *p_++;
+  }
+
+  uint64_t ULeb() {
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+      byte = U8();
+      if (shift < 64) value |= uint64_t(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    return value;
+  }
+
+  int64_t SLeb() {
+    uint64_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+      byte = U8();
+      if (shift < 64) value |= uint64_t(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (shift < 64 && (byte & 0x40)) value |= ~uint64_t(0) << shift;
+    return int64_t(value);
+  }
+
+  uint32_t U32() { return uint32_t(ULeb()); }
+
+  Bytes Take(size_t n) {
+    Need(n);
+    Bytes bytes(p_, p_ + n);
+    p_ += n;
+    return bytes;
+  }
+
+  Bytes Rest() { return Take(end_ - p_); }
+
+  std::string Name() {
+    Bytes bytes = Take(U32());
+    return std::string(bytes.begin(), bytes.end());
+  }
+
+ private:
+  void Need(size_t n) const {
+    if (size_t(end_ - p_) < n) throw Error("truncated module");
+  }
+
+  const uint8_t* p_;
+  const uint8_t* end_;
+};
+
+inline void PutULeb(Bytes& out, uint64_t value) {
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if (value != 0) byte |= 0x80;
+    out.push_back(byte);
+  } while (value != 0);
+}
+
+inline void PutSLeb(Bytes& out, int64_t value) {
+  bool more = true;
+  while (more) {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    more = !((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40)));
+    if (more) byte |= 0x80;
+    out.push_back(byte);
+  }
+}
+
+inline void PutBytes(Bytes& out, const Bytes& bytes) {
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+inline void PutName(Bytes& out, const std::string& name) {
+  PutULeb(out, name.size());
+  out.insert(out.end(), name.begin(), name.end());
+}
+
+inline size_t ULebSize(uint64_t value) {
+  Bytes out;
+  PutULeb(out, value);
+  return out.size();
+}
+
+inline size_t SLebSize(int64_t value) {
+  Bytes out;
+  PutSLeb(out, value);
+  return out.size();
+}
+
+}  // namespace wasm
+}  // namespace cdt
+}  // namespace platon
+
+#endif  // __WASM_H_
@@ -0,0 +1,829 @@
+#include "WasmOptimizer.h"
+
+#include "platon/wasm.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace platon {
+namespace ld {
+namespace {
+
+using namespace platon::cdt::wasm;
+
+// Raised for features the optimizer does not know; like a malformed module,
+// that leaves the module as it is.
+typedef Error Unsupported;
+
+// A constant expression, kept as encoded. address is set for `i32.const N`.
+struct ConstExpr {
+  Bytes bytes;
+  bool is_address = false;
+  uint32_t address = 0;
+};
+
+ConstExpr ReadConstExpr(Reader &reader) {
+  ConstExpr expr;
+  Bytes &out = expr.bytes;
+  for (;;) {
+    uint8_t op = reader.U8();
+    out.push_back(op);
+    switch (op) {
+      case 0x0b:
+        return expr;
+      case 0x41: {
+        auto value = int32_t(reader.SLeb());
+        PutSLeb(out, value);
+        expr.is_address = out.size() == 1 + SLebSize(value);
+        expr.address = uint32_t(value);
+        break;
+      }
+      case 0x42:
+        PutSLeb(out, reader.SLeb());
+        break;
+      case 0x43:
+        PutBytes(out, reader.Take(4));
+        break;
+      case 0x44:
+        PutBytes(out, reader.Take(8));
+        break;
+      case 0x23:
+        PutULeb(out, reader.U32());
+        expr.is_address = false;
+        break;
+      default:
+        throw Unsupported("constant expression opcode " + std::to_string(op));
+    }
+  }
+}
+
+Bytes ReadLimits(Reader &reader) {
+  Bytes out;
+  uint8_t flags = reader.U8();
+  out.push_back(flags);
+  PutULeb(out, reader.U32());
+  if (flags & 1) PutULeb(out, reader.U32());
+  return out;
+}
+
+struct Import {
+  std::string module;
+  std::string field;
+  uint8_t kind;
+  uint32_t type = 0;
+  // Encoded descriptor of table, memory and global imports.
+  Bytes desc;
+};
+
+struct Export {
+  std::string name;
+  uint8_t kind;
+  uint32_t index;
+};
+
+struct Element {
+  ConstExpr offset;
+  std::vector<uint32_t> funcs;
+};
+
+struct Data {
+  uint32_t flags;
+  uint32_t memory = 0;
+  ConstExpr offset;
+  Bytes bytes;
+};
+
+struct Function {
+  uint32_t type;
+  // Types of the locals after the parameters, one per local.
+  Bytes locals;
+  // The instructions, every immediate encoded minimally.
+  Bytes code;
+};
+
+struct Section {
+  uint8_t id;
+  Bytes payload;
+};
+
+struct Module {
+  std::vector<Section> sections;
+  std::vector<uint32_t> type_params;
+  std::vector<Import> imports;
+  uint32_t imported_funcs = 0;
+  bool imported_memory = false;
+  std::vector<Function> funcs;
+  std::vector<Export> exports;
+  bool has_start = false;
+  uint32_t start = 0;
+  std::vector<Element> elements;
+  std::vector<Data> datas;
+
+  uint32_t FuncCount() const { return imported_funcs + funcs.size(); }
+};
+
+// What a body references, collected while it is rewritten. Locals are only
+// counted when local_uses is sized to the function's locals.
+struct Usage {
+  std::vector<uint32_t> calls;
+  std::vector<uint32_t> local_uses;
+  bool data_index = false;
+};
+
+// Index maps applied while a body is rewritten; null maps are the identity.
+struct Remap {
+  const std::vector<uint32_t> *funcs = nullptr;
+  const std::vector<uint32_t> *locals = nullptr;
+};
+
+uint32_t Map(const std::vector<uint32_t> *map, uint32_t index) {
+  if (!map) return index;
+  if (index >= map->size()) throw Unsupported("index out of range");
+  return (*map)[index];
+}
+
+// Decodes the instructions of a body and appends them to out with every
+// immediate encoded minimally and function and local indices remapped.
+void RewriteCode(const Bytes &code, Bytes &out, const Remap &remap,
+                 Usage *usage) {
+  Reader reader(code);
+  while (!reader.Done()) {
+    uint8_t op = reader.U8();
+    out.push_back(op);
+    switch (op) {
+      case 0x00: case 0x01: case 0x05: case 0x0b: case 0x0f:
+      case 0x1a: case 0x1b: case 0xd1:
+        break;
+      case 0x02: case 0x03: case 0x04:  // block type
+        PutSLeb(out, reader.SLeb());
+        break;
+      case 0x0c: case 0x0d: case 0x23: case 0x24: case 0x25: case 0x26:
+      case 0x3f: case 0x40:
+        PutULeb(out, reader.U32());
+        break;
+      case 0x0e: {
+        uint32_t count = reader.U32();
+        PutULeb(out, count);
+        for (uint32_t i = 0; i <= count; i++) PutULeb(out, reader.U32());
+        break;
+      }
+      case 0x10: case 0xd2: {
+        uint32_t func = reader.U32();
+        if (usage) usage->calls.push_back(func);
+        PutULeb(out, Map(remap.funcs, func));
+        break;
+      }
+      case 0x11:
+        PutULeb(out, reader.U32());
+        PutULeb(out, reader.U32());
+        break;
+      case 0x1c: {
+        uint32_t count = reader.U32();
+        PutULeb(out, count);
+        PutBytes(out, reader.Take(count));
+        break;
+      }
+      case 0x20: case 0x21: case 0x22: {
+        uint32_t local = reader.U32();
+        if (usage && !usage->local_uses.empty()) {
+          if (local >= usage->local_uses.size()) {
+            throw Unsupported("local index out of range");
+          }
+          usage->local_uses[local]++;
+        }
+        PutULeb(out, Map(remap.locals, local));
+        break;
+      }
+      case 0x41:
+        PutSLeb(out, int32_t(reader.SLeb()));
+        break;
+      case 0x42:
+        PutSLeb(out, reader.SLeb());
+        break;
+      case 0x43:
+        PutBytes(out, reader.Take(4));
+        break;
+      case 0x44:
+        PutBytes(out, reader.Take(8));
+        break;
+      case 0xd0:
+        out.push_back(reader.U8());
+        break;
+      case 0xfc: {
+        uint32_t sub = reader.U32();
+        PutULeb(out, sub);
+        switch (sub) {
+          case 0: case 1: case 2: case 3: case 4: case 5: case 6: case 7:
+            break;
+          case 8: case 9:  // memory.init, data.drop
+            if (usage) usage->data_index = true;
+            PutULeb(out, reader.U32());
+            if (sub == 8) PutULeb(out, reader.U32());
+            break;
+          case 10: case 12: case 14:
+            PutULeb(out, reader.U32());
+            PutULeb(out, reader.U32());
+            break;
+          case 11: case 13: case 15: case 16: case 17:
+            PutULeb(out, reader.U32());
+            break;
+          default:
+            throw Unsupported("opcode 0xfc " + std::to_string(sub));
+        }
+        break;
+      }
+      default:
+        if (op >= 0x28 && op <= 0x3e) {  // loads and stores
+          PutULeb(out, reader.U32());
+          PutULeb(out, reader.U32());
+        } else if (op < 0x45 || op > 0xc4) {  // numeric ops take nothing
+          throw Unsupported("opcode " + std::to_string(op));
+        }
+    }
+  }
+}
+
+Module Parse(const Bytes &bytes) {
+  if (bytes.size() < sizeof(kHeader) ||
+      !std::equal(kHeader, kHeader + sizeof(kHeader), bytes.begin())) {
+    throw Unsupported("not a wasm module");
+  }
+
+  Module module;
+  std::vector<uint32_t> func_types;
+  Reader sections(bytes.data() + sizeof(kHeader), bytes.data() + bytes.size());
+  while (!sections.Done()) {
+    Section section;
+    section.id = sections.U8();
+    section.payload = sections.Take(sections.U32());
+    Reader reader(section.payload);
+
+    switch (section.id) {
+      case kTypeSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          if (reader.U8() != 0x60) throw Unsupported("type form");
+          uint32_t params = reader.U32();
+          reader.Take(params);
+          reader.Take(reader.U32());
+          module.type_params.push_back(params);
+        }
+        break;
+      case kImportSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          Import import;
+          import.module = reader.Name();
+          import.field = reader.Name();
+          import.kind = reader.U8();
+          switch (import.kind) {
+            case kExternalFunction:
+              import.type = reader.U32();
+              module.imported_funcs++;
+              break;
+            case kExternalTable:
+              import.desc.push_back(reader.U8());
+              PutBytes(import.desc, ReadLimits(reader));
+              break;
+            case kExternalMemory:
+              import.desc = ReadLimits(reader);
+              module.imported_memory = true;
+              break;
+            case kExternalGlobal:
+              import.desc = reader.Take(2);
+              break;
+            default:
+              throw Unsupported("import kind");
+          }
+          module.imports.push_back(import);
+        }
+        break;
+      case kFunctionSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          func_types.push_back(reader.U32());
+        }
+        break;
+      case kExportSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          Export exp;
+          exp.name = reader.Name();
+          exp.kind = reader.U8();
+          exp.index = reader.U32();
+          module.exports.push_back(exp);
+        }
+        break;
+      case kStartSection:
+        module.has_start = true;
+        module.start = reader.U32();
+        break;
+      case kElementSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          if (reader.U32() != 0) throw Unsupported("element segment kind");
+          Element element;
+          element.offset = ReadConstExpr(reader);
+          for (uint32_t m = reader.U32(); m > 0; m--) {
+            element.funcs.push_back(reader.U32());
+          }
+          module.elements.push_back(element);
+        }
+        break;
+      case kCodeSection: {
+        uint32_t n = reader.U32();
+        if (n != func_types.size()) throw Unsupported("code section count");
+        for (uint32_t i = 0; i < n; i++) {
+          Bytes body = reader.Take(reader.U32());
+          Reader body_reader(body);
+          Function func;
+          func.type = func_types[i];
+          for (uint32_t m = body_reader.U32(); m > 0; m--) {
+            uint32_t count = body_reader.U32();
+            uint8_t type = body_reader.U8();
+            if (func.locals.size() + count > 50000) {
+              throw Unsupported("too many locals");
+            }
+            func.locals.insert(func.locals.end(), count, type);
+          }
+          func.code = body_reader.Rest();
+          module.funcs.push_back(func);
+        }
+        break;
+      }
+      case kDataSection:
+        for (uint32_t n = reader.U32(); n > 0; n--) {
+          Data data;
+          data.flags = reader.U32();
+          if (data.flags > 2) throw Unsupported("data segment kind");
+          if (data.flags == 2) data.memory = reader.U32();
+          if (data.flags != 1) data.offset = ReadConstExpr(reader);
+          data.bytes = reader.Take(reader.U32());
+          module.datas.push_back(data);
+        }
+        break;
+      default:
+        break;
+    }
+    module.sections.push_back(std::move(section));
+  }
+
+  if (module.funcs.size() != func_types.size()) {
+    throw Unsupported("function section without code");
+  }
+  for (const auto &func : module.funcs) {
+    if (func.type >= module.type_params.size()) {
+      throw Unsupported("type index out of range");
+    }
+  }
+  return module;
+}
+
+void RemapBodies(Module &module, const std::vector<uint32_t> &funcs) {
+  Remap remap;
+  remap.funcs = &funcs;
+  for (auto &func : module.funcs) {
+    Bytes code;
+    RewriteCode(func.code, code, remap, nullptr);
+    func.code.swap(code);
+  }
+}
+
+// Points every call of a function at the first function with the same type,
+// locals and instructions. Bodies are compared with the calls already
+// redirected, so this repeats until wrappers of merged functions stop
+// becoming identical. Table entries keep their function, which preserves
+// distinct function pointers.
+void MergeFunctions(Module &module, WasmOptStats &stats) {
+  std::vector<uint32_t> target(module.FuncCount());
+  std::iota(target.begin(), target.end(), 0);
+  Remap remap;
+  remap.funcs = &target;
+
+  for (bool changed = true; changed;) {
+    changed = false;
+    std::map<Bytes, uint32_t> seen;
+    for (uint32_t i = 0; i < module.funcs.size(); i++) {
+      const Function &func = module.funcs[i];
+      Bytes key;
+      PutULeb(key, func.type);
+      PutName(key, std::string(func.locals.begin(), func.locals.end()));
+      RewriteCode(func.code, key, remap, nullptr);
+      uint32_t index = module.imported_funcs + i;
+      auto it = seen.emplace(std::move(key), index).first;
+      if (target[index] != it->second) {
+        target[index] = it->second;
+        changed = true;
+      }
+    }
+  }
+
+  for (uint32_t i = module.imported_funcs; i < target.size(); i++) {
+    if (target[i] != i) stats.merged_functions++;
+  }
+  if (stats.merged_functions == 0) return;
+  RemapBodies(module, target);
+  for (auto &exp : module.exports) {
+    if (exp.kind == kExternalFunction) exp.index = Map(&target, exp.index);
+  }
+  if (module.has_start) module.start = Map(&target, module.start);
+}
+
+const uint32_t kDead = UINT32_MAX;
+
+// Drops the functions and function imports that no export, table entry,
+// start function or live function refers to, and renumbers the rest.
+// Returns the new index of every function, kDead for the dropped ones, or
+// nothing if all of them stay.
+std::vector<uint32_t> RemoveDeadFunctions(Module &module, WasmOptStats &stats) {
+  uint32_t count = module.FuncCount();
+  std::vector<bool> live(count);
+  std::vector<uint32_t> work;
+  auto mark = [&](uint32_t func) {
+    if (func >= count) throw Unsupported("function index out of range");
+    if (!live[func]) {
+      live[func] = true;
+      work.push_back(func);
+    }
+  };
+  for (const auto &exp : module.exports) {
+    if (exp.kind == kExternalFunction) mark(exp.index);
+  }
+  for (const auto &element : module.elements) {
+    for (uint32_t func : element.funcs) mark(func);
+  }
+  if (module.has_start) mark(module.start);
+  while (!work.empty()) {
+    uint32_t func = work.back();
+    work.pop_back();
+    if (func < module.imported_funcs) continue;
+    Usage usage;
+    Bytes code;
+    RewriteCode(module.funcs[func - module.imported_funcs].code, code,
+                Remap(), &usage);
+    for (uint32_t callee : usage.calls) mark(callee);
+  }
+
+  std::vector<uint32_t> index(count);
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (live[i]) {
+      index[i] = next++;
+    } else {
+      index[i] = kDead;
+      if (i < module.imported_funcs) {
+        stats.removed_imports++;
+      } else {
+        stats.removed_functions++;
+      }
+    }
+  }
+  if (next == count) return std::vector<uint32_t>();
+
+  std::vector<Import> imports;
+  uint32_t func = 0;
+  for (const auto &import : module.imports) {
+    if (import.kind != kExternalFunction || live[func++]) {
+      imports.push_back(import);
+    }
+  }
+  module.imports.swap(imports);
+  module.imported_funcs -= stats.removed_imports;
+
+  std::vector<Function> funcs;
+  for (uint32_t i = 0; i < module.funcs.size(); i++) {
+    if (live[func + i]) funcs.push_back(std::move(module.funcs[i]));
+  }
+  module.funcs.swap(funcs);
+
+  RemapBodies(module, index);
+  for (auto &exp : module.exports) {
+    if (exp.kind == kExternalFunction) exp.index = index[exp.index];
+  }
+  for (auto &element : module.elements) {
+    for (auto &func : element.funcs) func = index[func];
+  }
+  if (module.has_start) module.start = index[module.start];
+  return index;
+}
+
+size_t LocalsSize(const Bytes &types) {
+  size_t runs = 0, size = 0;
+  for (size_t i = 0; i < types.size();) {
+    size_t j = i;
+    while (j < types.size() && types[j] == types[i]) j++;
+    runs++;
+    size += ULebSize(j - i) + 1;
+    i = j;
+  }
+  return ULebSize(runs) + size;
+}
+
+// Drops unused locals and renumbers the others, picking whichever of a few
+// orders encodes smallest: busiest first gets the one-byte indices, grouping
+// by type gets the shortest declarations. Returns whether anything changed.
+bool ReorderLocals(Function &func, uint32_t params, bool &data_index) {
+  Usage usage;
+  usage.local_uses.resize(params + func.locals.size());
+  Bytes scratch;
+  RewriteCode(func.code, scratch, Remap(), &usage);
+  data_index = data_index || usage.data_index;
+  const auto &uses = usage.local_uses;
+
+  std::vector<uint32_t> used;
+  for (uint32_t i = 0; i < func.locals.size(); i++) {
+    if (uses[params + i] != 0) used.push_back(i);
+  }
+  auto by_uses = [&](uint32_t a, uint32_t b) {
+    return uses[params + a] > uses[params + b];
+  };
+  std::vector<std::vector<uint32_t>> orders(3, used);
+  std::stable_sort(orders[1].begin(), orders[1].end(), by_uses);
+  std::map<uint8_t, uint64_t> type_uses;
+  for (uint32_t i : used) type_uses[func.locals[i]] += uses[params + i];
+  std::stable_sort(orders[2].begin(), orders[2].end(),
+                   [&](uint32_t a, uint32_t b) {
+                     uint8_t ta = func.locals[a], tb = func.locals[b];
+                     if (ta != tb) {
+                       if (type_uses[ta] != type_uses[tb]) {
+                         return type_uses[ta] > type_uses[tb];
+                       }
+                       return ta < tb;
+                     }
+                     return by_uses(a, b);
+                   });
+
+  auto cost = [&](const std::vector<uint32_t> &order) {
+    Bytes types;
+    size_t size = 0;
+    for (uint32_t pos = 0; pos < order.size(); pos++) {
+      types.push_back(func.locals[order[pos]]);
+      size += uses[params + order[pos]] * ULebSize(params + pos);
+    }
+    return size + LocalsSize(types);
+  };
+  const std::vector<uint32_t> *best = &orders[0];
+  for (const auto &order : orders) {
+    if (cost(order) < cost(*best)) best = &order;
+  }
+  bool identity = best->size() == func.locals.size();
+  for (uint32_t pos = 0; identity && pos < best->size(); pos++) {
+    identity = (*best)[pos] == pos;
+  }
+  if (identity) return false;
+
+  std::vector<uint32_t> map(params + func.locals.size());
+  std::iota(map.begin(), map.begin() + params, 0);
+  Bytes locals;
+  for (uint32_t pos = 0; pos < best->size(); pos++) {
+    map[params + (*best)[pos]] = params + pos;
+    locals.push_back(func.locals[(*best)[pos]]);
+  }
+  Remap remap;
+  remap.locals = &map;
+  Bytes code;
+  RewriteCode(func.code, code, remap, nullptr);
+  func.code.swap(code);
+  func.locals.swap(locals);
+  return true;
+}
+
+// Cuts the zero bytes out of active data segments: memory starts zeroed, so
+// only leading and trailing zeros and runs longer than the header of another
+// segment are worth dropping. Needs constant, non-overlapping segments and no
+// instruction naming a segment by index.
+void CompactData(Module &module, bool data_index, WasmOptStats &stats) {
+  if (data_index || module.imported_memory) return;
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  for (const auto &data : module.datas) {
+    if (data.flags != 0 || !data.offset.is_address) return;
+    ranges.emplace_back(data.offset.address,
+                        data.offset.address + data.bytes.size());
+    if (ranges.back().second < ranges.back().first) return;
+  }
+  std::sort(ranges.begin(), ranges.end());
+  for (size_t i = 1; i < ranges.size(); i++) {
+    if (ranges[i].first < ranges[i - 1].second) return;
+  }
+
+  std::vector<Data> datas;
+  for (const auto &data : module.datas) {
+    const Bytes &bytes = data.bytes;
+    size_t size = bytes.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < size;) {
+      while (i < size && bytes[i] == 0) i++;
+      if (i == size) break;
+      size_t begin = i, end = i;
+      while (end < size) {
+        size_t zeros = end;
+        while (zeros < size && bytes[zeros] == 0) zeros++;
+        if (zeros == size) break;
+        uint32_t address = data.offset.address + zeros;
+        size_t header =
+            3 + SLebSize(int32_t(address)) + ULebSize(size - zeros);
+        if (zeros - end > header) break;
+        end = zeros;
+        while (end < size && bytes[end] != 0) end++;
+      }
+      Data piece;
+      piece.flags = 0;
+      piece.offset.bytes.push_back(0x41);
+      PutSLeb(piece.offset.bytes, int32_t(data.offset.address + begin));
+      piece.offset.bytes.push_back(0x0b);
+      piece.offset.is_address = true;
+      piece.offset.address = data.offset.address + begin;
+      piece.bytes.assign(bytes.begin() + begin, bytes.begin() + end);
+      kept += end - begin;
+      datas.push_back(std::move(piece));
+      i = end;
+    }
+    stats.dropped_data_bytes += size - kept;
+  }
+  module.datas.swap(datas);
+}
+
+// Renumbers the function names of a name section after dead functions were
+// dropped. The other subsections name locals, globals or data segments by
+// index, which may have changed as well, so they go.
+Bytes RewriteNames(const Bytes &payload, const std::vector<uint32_t> &index) {
+  Reader reader(payload);
+  Bytes out;
+  PutName(out, reader.Name());
+  while (!reader.Done()) {
+    uint8_t id = reader.U8();
+    Bytes sub = reader.Take(reader.U32());
+    if (id == 1 && !index.empty()) {
+      Reader names(sub);
+      Bytes kept;
+      uint32_t count = 0;
+      for (uint32_t n = names.U32(); n > 0; n--) {
+        uint32_t func = names.U32();
+        std::string name = names.Name();
+        if (func < index.size() && index[func] != kDead) {
+          PutULeb(kept, index[func]);
+          PutName(kept, name);
+          count++;
+        }
+      }
+      sub.clear();
+      PutULeb(sub, count);
+      PutBytes(sub, kept);
+    } else if (id != 0 && id != 1) {
+      continue;
+    }
+    out.push_back(id);
+    PutULeb(out, sub.size());
+    PutBytes(out, sub);
+  }
+  return out;
+}
+
+Bytes Encode(const Module &module, const std::vector<uint32_t> &index) {
+  Bytes out(std::begin(kHeader), std::end(kHeader));
+  for (const auto &section : module.sections) {
+    Bytes payload;
+    switch (section.id) {
+      case kImportSection:
+        PutULeb(payload, module.imports.size());
+        for (const auto &import : module.imports) {
+          PutName(payload, import.module);
+          PutName(payload, import.field);
+          payload.push_back(import.kind);
+          if (import.kind == kExternalFunction) {
+            PutULeb(payload, import.type);
+          } else {
+            PutBytes(payload, import.desc);
+          }
+        }
+        break;
+      case kFunctionSection:
+        PutULeb(payload, module.funcs.size());
+        for (const auto &func : module.funcs) PutULeb(payload, func.type);
+        break;
+      case kExportSection:
+        PutULeb(payload, module.exports.size());
+        for (const auto &exp : module.exports) {
+          PutName(payload, exp.name);
+          payload.push_back(exp.kind);
+          PutULeb(payload, exp.index);
+        }
+        break;
+      case kStartSection:
+        PutULeb(payload, module.start);
+        break;
+      case kElementSection:
+        PutULeb(payload, module.elements.size());
+        for (const auto &element : module.elements) {
+          PutULeb(payload, 0);
+          PutBytes(payload, element.offset.bytes);
+          PutULeb(payload, element.funcs.size());
+          for (uint32_t func : element.funcs) PutULeb(payload, func);
+        }
+        break;
+      case kCodeSection:
+        PutULeb(payload, module.funcs.size());
+        for (const auto &func : module.funcs) {
+          Bytes body;
+          Bytes runs;
+          uint32_t count = 0;
+          for (size_t i = 0; i < func.locals.size();) {
+            size_t j = i;
+            while (j < func.locals.size() && func.locals[j] == func.locals[i]) {
+              j++;
+            }
+            PutULeb(runs, j - i);
+            runs.push_back(func.locals[i]);
+            count++;
+            i = j;
+          }
+          PutULeb(body, count);
+          PutBytes(body, runs);
+          PutBytes(body, func.code);
+          PutULeb(payload, body.size());
+          PutBytes(payload, body);
+        }
+        break;
+      case kDataSection:
+        PutULeb(payload, module.datas.size());
+        for (const auto &data : module.datas) {
+          PutULeb(payload, data.flags);
+          if (data.flags == 2) PutULeb(payload, data.memory);
+          if (data.flags != 1) PutBytes(payload, data.offset.bytes);
+          PutULeb(payload, data.bytes.size());
+          PutBytes(payload, data.bytes);
+        }
+        break;
+      case kDataCountSection:
+        PutULeb(payload, module.datas.size());
+        break;
+      case kCustomSection: {
+        Reader reader(section.payload);
+        if (reader.Name() == "name") {
+          payload = RewriteNames(section.payload, index);
+        } else {
+          payload = section.payload;
+        }
+        break;
+      }
+      default:
+        payload = section.payload;
+        break;
+    }
+    out.push_back(section.id);
+    PutULeb(out, payload.size());
+    PutBytes(out, payload);
+  }
+  return out;
+}
+
+}  // namespace
+
+bool OptimizeWasm(std::vector<uint8_t> &bytes,
+                  const std::set<std::string> &keep_exports,
+                  WasmOptStats &stats, std::string &error) {
+  stats = WasmOptStats();
+  stats.size_before = bytes.size();
+  try {
+    Module module = Parse(bytes);
+    for (auto &func : module.funcs) {
+      Bytes code;
+      RewriteCode(func.code, code, Remap(), nullptr);
+      func.code.swap(code);
+    }
+
+    if (!keep_exports.empty()) {
+      std::vector<Export> exports;
+      for (const auto &exp : module.exports) {
+        if (exp.kind != kExternalFunction || keep_exports.count(exp.name)) {
+          exports.push_back(exp);
+        } else {
+          stats.removed_exports++;
+        }
+      }
+      module.exports.swap(exports);
+    }
+
+    MergeFunctions(module, stats);
+    std::vector<uint32_t> index = RemoveDeadFunctions(module, stats);
+
+    bool data_index = false;
+    for (auto &func : module.funcs) {
+      if (ReorderLocals(func, module.type_params[func.type], data_index)) {
+        stats.reordered_locals++;
+      }
+    }
+    CompactData(module, data_index, stats);
+
+    Bytes out = Encode(module, index);
+    if (out.size() < bytes.size()) bytes.swap(out);
+  } catch (const Unsupported &e) {
+    error = e.what();
+    stats.size_after = bytes.size();
+    return false;
+  }
+  stats.size_after = bytes.size();
+  return true;
+}
+
+}  // namespace ld
+}  // namespace platon
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace platon {
+namespace ld {
+
+struct WasmOptStats {
+  size_t size_before = 0;
+  size_t size_after = 0;
+  unsigned merged_functions = 0;
+  unsigned removed_functions = 0;
+  unsigned removed_imports = 0;
+  unsigned removed_exports = 0;
+  unsigned reordered_locals = 0;
+  size_t dropped_data_bytes = 0;
+};
+
+/// Shrinks a linked wasm module in place. Identical functions are merged,
+/// function exports that were not asked for are dropped along with the
+/// functions and imports nothing references any more, the zero runs are cut
+/// out of constant data segments, and locals are renumbered so the busiest
+/// get the shortest indices. Every LEB128 immediate is re-encoded minimally,
+/// which also drops the padding wasm-ld leaves on relocated operands.
+///
+/// keep_exports names the function exports to keep; when it is empty all of
+/// them are kept. Returns false and leaves the module alone, with the reason
+/// in error, if it uses a feature the optimizer does not know.
+bool OptimizeWasm(std::vector<uint8_t> &module,
+                  const std::set<std::string> &keep_exports,
+                  WasmOptStats &stats, std::string &error);
+
+}  // namespace ld
+}  // namespace platon
@@ -1,18 +1,73 @@
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <set>
 #include <string>
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 
 #include "platon/utils.hpp"
 
+#include "WasmOptimizer.h"
+
 #define ONLY_LD 1
 #include "options.hpp"
 
 const std::string kLdName = "platon-ld";
 
+// Runs the post-link optimizer over the linked module. A module it does not
+// understand is kept as wasm-ld wrote it.
+static bool OptimizeOutput(const Options& opts) {
+  std::ifstream in(opts.output_filename, std::ios::binary);
+  std::vector<uint8_t> module((std::istreambuf_iterator<char>(in)),
+                              std::istreambuf_iterator<char>());
+  in.close();
+
+  std::set<std::string> keep_exports;
+  for (size_t i = 0; i + 1 < opts.ld_opts.size(); i++) {
+    if (opts.ld_opts[i] == "--export") {
+      keep_exports.insert(opts.ld_opts[i + 1]);
+    }
+  }
+
+  platon::ld::WasmOptStats stats;
+  std::string error;
+  if (!platon::ld::OptimizeWasm(module, keep_exports, stats, error)) {
+    llvm::errs() << kLdName << ": warning: " << opts.output_filename
+                 << " not optimized: " << error << "\n";
+    return true;
+  }
+
+  std::ofstream out(opts.output_filename, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(module.data()), module.size());
+  if (!out) {
+    llvm::errs() << kLdName << ": can't write " << opts.output_filename
+                 << "\n";
+    return false;
+  }
+
+  if (opts.wasm_opt_report) {
+    size_t saved = stats.size_before - stats.size_after;
+    double percent =
+        stats.size_before ? 100.0 * saved / stats.size_before : 0.0;
+    llvm::errs() << kLdName << ": " << opts.output_filename << ": "
+                 << stats.size_before << " -> " << stats.size_after
+                 << " bytes, saved " << saved << " ("
+                 << llvm::format("%.1f", percent) << "%); merged "
+                 << stats.merged_functions
+                 << " functions, removed " << stats.removed_functions
+                 << " functions, " << stats.removed_imports << " imports and "
+                 << stats.removed_exports << " exports, dropped "
+                 << stats.dropped_data_bytes
+                 << " zero data bytes, reordered locals of "
+                 << stats.reordered_locals << " functions\n";
+  }
+  return true;
+}
+
 int main(int argc, const char** argv) {
   for (auto i = 0; i < argc; i++) {
     if (argv[i] == std::string("-v")) {
@@ -34,7 +89,8 @@ int main(int argc, const char** argv) {
     std::fstream fs(opts.export_file);
     std::string line;
     while (std::getline(fs, line)) {
-      opts.ld_opts.emplace_back("--export " + line);
+      opts.ld_opts.emplace_back("--export");
+      opts.ld_opts.emplace_back(line);
     }
   }
 
@@ -45,5 +101,9 @@ int main(int argc, const char** argv) {
   if (!llvm::sys::fs::exists(opts.output_filename)) {
     return -1;
   }
+
+  if (opts.wasm_opt && !OptimizeOutput(opts)) {
+    return -1;
+  }
   return 0;
 }
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llvm/Demangle/Demangle.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "platon/wasm.hpp"
+
+using namespace platon::cdt::wasm;
+
+const std::string kSizeName = "platon-size";
+
+static llvm::cl::OptionCategory SizeToolCategory("platon-size options");
+
+static llvm::cl::opt<std::string> input_opt(llvm::cl::Positional,
+                                            llvm::cl::desc("<input wasm>"),
+                                            llvm::cl::Required,
+                                            llvm::cl::cat(SizeToolCategory));
+
+static llvm::cl::opt<unsigned> top_opt(
+    "top", llvm::cl::desc("Number of functions and templates to list"),
+    llvm::cl::init(20), llvm::cl::cat(SizeToolCategory));
+
+struct Section {
+  uint8_t id;
+  std::string name;
+  size_t size;
+};
+
+struct Function {
+  uint32_t index;
+  std::string name;
+  size_t size;
+};
+
+struct Segment {
+  int64_t offset;
+  size_t size;
+  size_t zeros;
+};
+
+struct Module {
+  size_t size = 0;
+  std::vector<Section> sections;
+  std::vector<Function> functions;
+  std::vector<Segment> segments;
+  bool named = false;
+};
+
+static void SkipLimits(Reader& reader) {
+  uint8_t flags = reader.U8();
+  reader.U32();
+  if (flags & 1) {
+    reader.U32();
+  }
+}
+
+static uint32_t CountFunctionImports(Reader reader) {
+  uint32_t functions = 0;
+  for (uint32_t count = reader.U32(); count > 0; count--) {
+    reader.Name();
+    reader.Name();
+    switch (reader.U8()) {
+      case kExternalFunction:
+        reader.U32();
+        functions++;
+        break;
+      case kExternalTable:
+        reader.U8();
+        SkipLimits(reader);
+        break;
+      case kExternalMemory:
+        SkipLimits(reader);
+        break;
+      case kExternalGlobal:
+        reader.U8();
+        reader.U8();
+        break;
+      default:
+        throw Error("unknown import kind");
+    }
+  }
+  return functions;
+}
+
+// Reads the constant offset of an active segment; -1 when it is a global.
+static int64_t ReadOffset(Reader& reader) {
+  int64_t offset = -1;
+  for (uint8_t op = reader.U8(); op != 0x0b; op = reader.U8()) {
+    if (op == 0x41) {
+      offset = reader.SLeb();
+    } else if (op == 0x23) {
+      reader.U32();
+    } else {
+      throw Error("unsupported segment offset");
+    }
+  }
+  return offset;
+}
+
+static void ReadData(Reader reader, Module& module) {
+  for (uint32_t count = reader.U32(); count > 0; count--) {
+    uint32_t flags = reader.U32();
+    Segment segment{-1, 0, 0};
+    if (flags == 2) {
+      reader.U32();
+    }
+    if (flags != 1) {
+      segment.offset = ReadOffset(reader);
+    }
+    Bytes bytes = reader.Take(reader.U32());
+    segment.size = bytes.size();
+    segment.zeros = std::count(bytes.begin(), bytes.end(), 0);
+    module.segments.push_back(segment);
+  }
+}
+
+static void ReadNames(Reader reader, uint32_t imports, Module& module) {
+  while (!reader.Done()) {
+    uint8_t id = reader.U8();
+    Bytes payload = reader.Take(reader.U32());
+    if (id != 1) {
+      continue;
+    }
+    Reader names(payload);
+    for (uint32_t count = names.U32(); count > 0; count--) {
+      uint32_t index = names.U32();
+      std::string name = names.Name();
+      if (index >= imports && index - imports < module.functions.size()) {
+        module.functions[index - imports].name = name;
+        module.named = true;
+      }
+    }
+  }
+}
+
+static Module ReadModule(const Bytes& bytes) {
+  Module module;
+  module.size = bytes.size();
+  Reader reader(bytes);
+  Bytes header = reader.Take(sizeof(kHeader));
+  if (!std::equal(header.begin(), header.end(), kHeader)) {
+    throw Error("not a wasm module");
+  }
+  uint32_t imports = 0;
+  Bytes names;
+  while (!reader.Done()) {
+    uint8_t id = reader.U8();
+    uint32_t size = reader.U32();
+    Bytes payload = reader.Take(size);
+    Section section{id, SectionName(id), 1 + ULebSize(size) + size};
+    Reader content(payload);
+    if (id == kCustomSection) {
+      section.name = content.Name();
+      if (section.name == "name") {
+        names = content.Rest();
+      }
+      section.name = "custom \"" + section.name + "\"";
+    } else if (id == kImportSection) {
+      imports = CountFunctionImports(content);
+    } else if (id == kCodeSection) {
+      uint32_t count = content.U32();
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t body = content.U32();
+        content.Take(body);
+        module.functions.push_back(
+            Function{imports + i, "", ULebSize(body) + body});
+      }
+    } else if (id == kDataSection) {
+      ReadData(content, module);
+    }
+    module.sections.push_back(section);
+  }
+  if (!names.empty()) {
+    ReadNames(Reader(names), imports, module);
+  }
+  return module;
+}
+
+// wasm-ld writes demangled names unless it runs with --no-demangle.
+static std::string Demangle(const std::string& name) {
+  if (name.compare(0, 2, "_Z") != 0) {
+    return name;
+  }
+  int status = 0;
+  char* demangled =
+      llvm::itaniumDemangle(name.c_str(), nullptr, nullptr, &status);
+  if (status != 0 || demangled == nullptr) {
+    return name;
+  }
+  std::string result(demangled);
+  std::free(demangled);
+  return result;
+}
+
+// Folds the instantiations of one template together: template arguments
+// become "<>" and the parameter list is dropped. Returns an empty string for
+// a function that is no template instantiation.
+static std::string TemplateKey(std::string name) {
+  const std::string anonymous = "(anonymous namespace)";
+  for (size_t pos = name.find(anonymous); pos != std::string::npos;
+       pos = name.find(anonymous, pos)) {
+    name.replace(pos, anonymous.size(), "{anonymous}");
+  }
+  std::string key;
+  int depth = 0;
+  bool templated = false;
+  const std::string op = "operator";
+  for (size_t i = 0; i < name.size(); i++) {
+    char c = name[i];
+    // The symbol of operator<, operator<<, operator-> or operator() is part
+    // of the name, not a bracket.
+    if (name.compare(i, op.size(), op) == 0 &&
+        (i == 0 || !(isalnum(name[i - 1]) || name[i - 1] == '_'))) {
+      size_t end = i + op.size();
+      if (name.compare(end, 2, "()") == 0) {
+        end += 2;
+      } else {
+        while (end < name.size() && strchr("<>=!+-*/%^&|~,[]", name[end])) {
+          end++;
+        }
+      }
+      if (depth == 0) {
+        key += name.substr(i, end - i);
+      }
+      i = end - 1;
+      continue;
+    }
+    if (c == '<') {
+      if (depth++ == 0) {
+        key += "<>";
+      }
+      templated = true;
+    } else if (c == '>' && depth > 0) {
+      depth--;
+    } else if (c == '(' && depth == 0) {
+      break;
+    } else if (depth == 0) {
+      key += c;
+    }
+  }
+  return templated ? key : "";
+}
+
+static double Percent(size_t part, size_t total) {
+  return total ? 100.0 * part / total : 0.0;
+}
+
+static void PrintRow(size_t size, size_t total, const std::string& what) {
+  llvm::outs() << llvm::format("%10zu %5.1f%%  ", size, Percent(size, total))
+               << what << "\n";
+}
+
+static void PrintReport(const Module& module) {
+  size_t total = module.size;
+  llvm::outs() << input_opt << ": " << total << " bytes\n\nsections:\n";
+  for (const auto& section : module.sections) {
+    PrintRow(section.size, total, section.name);
+  }
+
+  std::vector<Function> functions = module.functions;
+  std::map<std::string, std::pair<size_t, unsigned>> templates;
+  for (auto& function : functions) {
+    function.name = function.name.empty()
+                        ? "function[" + std::to_string(function.index) + "]"
+                        : Demangle(function.name);
+    std::string key = TemplateKey(function.name);
+    if (!key.empty()) {
+      templates[key].first += function.size;
+      templates[key].second++;
+    }
+  }
+  std::stable_sort(functions.begin(), functions.end(),
+                   [](const Function& a, const Function& b) {
+                     return a.size > b.size;
+                   });
+  llvm::outs() << "\nfunctions (" << functions.size() << "):\n";
+  for (size_t i = 0; i < functions.size() && i < top_opt; i++) {
+    PrintRow(functions[i].size, total, functions[i].name);
+  }
+  if (!module.named && !functions.empty()) {
+    llvm::outs() << "  (no name section, link with -keep-names)\n";
+  }
+
+  typedef std::pair<std::string, std::pair<size_t, unsigned>> Group;
+  std::vector<Group> groups(templates.begin(), templates.end());
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](const Group& a, const Group& b) {
+                     return a.second.first > b.second.first;
+                   });
+  llvm::outs() << "\ntemplates (" << groups.size() << "):\n";
+  for (size_t i = 0; i < groups.size() && i < top_opt; i++) {
+    PrintRow(groups[i].second.first, total,
+             groups[i].first + " x" + std::to_string(groups[i].second.second));
+  }
+
+  llvm::outs() << "\ndata segments (" << module.segments.size() << "):\n";
+  for (const auto& segment : module.segments) {
+    std::string where = segment.offset < 0
+                            ? std::string("passive")
+                            : "offset " + std::to_string(segment.offset);
+    PrintRow(segment.size, total,
+             where + ", " + std::to_string(segment.zeros) + " zero bytes");
+  }
+}
+
+int main(int argc, const char** argv) {
+  llvm::cl::SetVersionPrinter([](llvm::raw_ostream& os) {
+    os << kSizeName << " version "
+       << "${VERSION_FULL}"
+       << "\n";
+  });
+  llvm::cl::HideUnrelatedOptions(SizeToolCategory);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, kSizeName + " (attribute wasm bytes to functions and data)");
+
+  std::ifstream in(input_opt, std::ios::binary);
+  if (!in) {
+    llvm::errs() << kSizeName << ": can't read " << input_opt << "\n";
+    return -1;
+  }
+  Bytes bytes((std::istreambuf_iterator<char>(in)),
+              std::istreambuf_iterator<char>());
+
+  try {
+    PrintReport(ReadModule(bytes));
+  } catch (const Error& e) {
+    llvm::errs() << kSizeName << ": " << input_opt << ": " << e.what() << "\n";
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+// platon-trace: folds the state I/O traces written by contracts built with
+// -DPLATON_TRACE (see platon/trace.hpp) into "method;container;operation
+// count" lines, the input format of flamegraph.pl and speedscope.
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+const std::string kTraceName = "platon-trace";
+
+static llvm::cl::OptionCategory TraceToolCategory("platon-trace options");
+
+static llvm::cl::list<std::string> inputs_opt(llvm::cl::Positional,
+                                              llvm::cl::desc("<input trace>"),
+                                              llvm::cl::OneOrMore,
+                                              llvm::cl::cat(TraceToolCategory));
+
+enum Weight { kCalls, kBytes };
+
+static llvm::cl::opt<Weight> weight_opt(
+    "weight", llvm::cl::desc("What a stack is weighted by"),
+    llvm::cl::values(clEnumValN(kCalls, "calls", "Host calls (default)"),
+                     clEnumValN(kBytes, "bytes", "Key and value bytes")),
+    llvm::cl::init(kCalls), llvm::cl::cat(TraceToolCategory));
+
+// Record kinds of platon/trace.hpp.
+enum Op : uint8_t {
+  kName = 0,
+  kSetState = 1,
+  kGetState = 2,
+  kDelState = 3,
+  kEvent = 4,
+  kCall = 5,
+};
+
+static const char* OpName(uint8_t op) {
+  switch (op) {
+    case kSetState:
+      return "setState";
+    case kGetState:
+      return "getState";
+    case kDelState:
+      return "delState";
+    case kEvent:
+      return "emitEvent";
+    case kCall:
+      return "call";
+  }
+  return nullptr;
+}
+
+static uint32_t Get(const std::vector<uint8_t>& bytes, size_t& pos,
+                    size_t size) {
+  uint32_t v = 0;
+  for (size_t i = 0; i < size; i++) {
+    v |= uint32_t(bytes[pos++]) << (8 * i);
+  }
+  return v;
+}
+
+// Adds the operations of one trace to the folded stacks; false when the
+// trace is truncated or holds an unknown record.
+static bool Fold(const std::vector<uint8_t>& bytes,
+                 std::map<std::string, uint64_t>& stacks) {
+  std::map<uint16_t, std::string> names;
+  size_t pos = 0;
+  while (pos < bytes.size()) {
+    uint8_t op = bytes[pos++];
+    if (op == kName) {
+      if (bytes.size() - pos < 4) {
+        return false;
+      }
+      uint16_t id = uint16_t(Get(bytes, pos, 2));
+      size_t len = Get(bytes, pos, 2);
+      if (bytes.size() - pos < len) {
+        return false;
+      }
+      names[id].assign(bytes.begin() + pos, bytes.begin() + pos + len);
+      pos += len;
+      continue;
+    }
+    if (OpName(op) == nullptr || bytes.size() - pos < 8) {
+      return false;
+    }
+    uint16_t method = uint16_t(Get(bytes, pos, 2));
+    uint16_t container = uint16_t(Get(bytes, pos, 2));
+    uint32_t size = Get(bytes, pos, 4);
+    std::string stack = method == 0 ? "(no method)" : names[method];
+    stack += ";";
+    stack += container == 0 ? "(no container)" : names[container];
+    stack += ";";
+    stack += OpName(op);
+    stacks[stack] += weight_opt == kBytes ? size : 1;
+  }
+  return true;
+}
+
+int main(int argc, const char** argv) {
+  llvm::cl::SetVersionPrinter([](llvm::raw_ostream& os) {
+    os << kTraceName << " version "
+       << "${VERSION_FULL}"
+       << "\n";
+  });
+  llvm::cl::HideUnrelatedOptions(TraceToolCategory);
+  llvm::cl::ParseCommandLineOptions(
+      argc, argv, kTraceName + " (fold state I/O traces into stacks)");
+
+  std::map<std::string, uint64_t> stacks;
+  for (const auto& input : inputs_opt) {
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+      llvm::errs() << kTraceName << ": can't read " << input << "\n";
+      return -1;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    if (!Fold(bytes, stacks)) {
+      llvm::errs() << kTraceName << ": " << input << ": malformed trace\n";
+      return -1;
+    }
+  }
+  for (const auto& stack : stacks) {
+    llvm::outs() << stack.first << " " << stack.second << "\n";
+  }
+  return 0;
+}